@@ -308,6 +308,7 @@ bool fbx_context::get_mesh_data(FbxMesh* fbx_mesh, mesh& m) {
 
 EDITOR_INTERFACE void
 ImportFbx(const char* file, scene_data* data) {
+	MEMORY_TAG(geometry);
 	assert(file && data);
 	scene scene{};
 
@@ -1,5 +1,12 @@
 #include "Geometry.h"
 #include "..\Utilities\IOStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace WAVEENGINE::TOOLS {
 
@@ -8,11 +15,11 @@ namespace {
 using namespace MATH;
 using namespace DirectX;
 
-void recalculate_normals(mesh& m) {
-	const u32 num_indices{ static_cast<u32>(m.raw_indices.size()) };
-	m.normals.resize(num_indices);
+// recalculates the normals of the triangles [first_triangle, end_triangle), m.normals has one element per index already.
+void recalculate_normals(mesh& m, u32 first_triangle, u32 end_triangle) {
+	assert(m.normals.size() == m.raw_indices.size() && end_triangle * 3 <= m.raw_indices.size());
 
-	for (u32 i{ 0 }; i < num_indices; ++i) {
+	for (u32 i{ first_triangle * 3 }; i < end_triangle * 3; ++i) {
 		// for each triangle, fetch three vertices
 		const u32 i0{ m.raw_indices[i] };
 		const u32 i1{ m.raw_indices[++i] };
@@ -33,102 +40,230 @@ void recalculate_normals(mesh& m) {
 	}
 }
 
+// The corners (positions in raw_indices) that use each vertex, in ascending order. The corners of vertex i are
+// corners[offsets[i]] to corners[offsets[i + 1] - 1]. Built with a counting sort, rather than a list per vertex.
+struct vertex_corners {
+	UTL::vector<u32>	offsets;
+	UTL::vector<u32>	corners;
+};
+
+void get_vertex_corners(const UTL::vector<u32>& raw_indices, u32 num_vertices, vertex_corners& vc) {
+	const u32 num_indices{ static_cast<u32>(raw_indices.size()) };
+	vc.offsets.resize(num_vertices + 1, 0);
+	for (u32 i{ 0 }; i < num_indices; ++i) {
+		++vc.offsets[raw_indices[i] + 1];
+	}
+	for (u32 i{ 0 }; i < num_vertices; ++i) {
+		vc.offsets[i + 1] += vc.offsets[i];
+	}
+
+	// NOTE: placing a corner moves the offset of its vertex to the next one, so they are moved back afterwards.
+	vc.corners.resize(num_indices);
+	for (u32 i{ 0 }; i < num_indices; ++i) {
+		vc.corners[vc.offsets[raw_indices[i]]++] = i;
+	}
+	for (u32 i{ num_vertices }; i > 0; --i) {
+		vc.offsets[i] = vc.offsets[i - 1];
+	}
+	vc.offsets[0] = 0;
+}
+
+// Finds the vertex that was created for a smoothing group with (nearly) the same uv, i.e. XMScalarNearEqual()
+// in both coordinates. The uvs are hashed by cells twice as wide as epsilon, so the uvs that are near each
+// other are always in the same or in neighbouring cells. Only used for one vertex fan at a time.
+struct uv_cell_table {
+	struct slot {
+		s64		u;
+		s64		v;
+		u32		group;
+		u32		vertex;
+		u32		fan;			// slots of earlier fans are empty
+	};
+
+	UTL::vector<slot>	slots;
+	u32					mask{ 0 };
+	u32					fan{ 0 };
+
+	// makes room for a fan of 'max_fan_size' corners. The table only grows, it is reused for the following fans.
+	void reserve(u32 max_fan_size) {
+		u32 capacity{ 16 };
+		while (capacity < 2 * max_fan_size) capacity <<= 1;
+		if (capacity <= slots.size()) return;
+		// NOTE: the new slots are empty, since 'fan' is at least 1 once a fan was started.
+		slots.clear();
+		slots.resize(capacity, slot{ 0, 0, 0, 0, 0 });
+		mask = capacity - 1;
+	}
+
+	static s64 cell(f32 x) {
+		return static_cast<s64>(std::floor(static_cast<f64>(x) * (0.5 / epsilon)));
+	}
+
+	u32 hash(u32 group, s64 u, s64 v) const {
+		u64 h{ static_cast<u64>(u) * 0x9E3779B97F4A7C15ull ^ static_cast<u64>(v) * 0xC2B2AE3D27D4EB4Full ^ group };
+		h ^= h >> 32;
+		return static_cast<u32>(h * 0xBF58476D1CE4E5B9ull >> 32) & mask;
+	}
+
+	void next_fan() { ++fan; }
+
+	// returns the first vertex (the one with the lowest index) that matches, or u32_invalid_id.
+	u32 find(u32 group, const v2& uv, const UTL::vector<vertex>& vertices) const {
+		const s64 cu{ cell(uv.x) };
+		const s64 cv{ cell(uv.y) };
+		u32 found{ u32_invalid_id };
+		for (s64 u{ cu - 1 }; u <= cu + 1; ++u) {
+			for (s64 v{ cv - 1 }; v <= cv + 1; ++v) {
+				for (u32 i{ hash(group, u, v) }; slots[i].fan == fan; i = (i + 1) & mask) {
+					const slot& s{ slots[i] };
+					if (s.group != group || s.u != u || s.v != v || s.vertex > found) continue;
+					const v2& seed{ vertices[s.vertex].uv };
+					if (XMScalarNearEqual(seed.x, uv.x, epsilon) && XMScalarNearEqual(seed.y, uv.y, epsilon)) {
+						found = s.vertex;
+					}
+				}
+			}
+		}
+		return found;
+	}
+
+	void add(u32 group, const v2& uv, u32 vertex) {
+		const s64 u{ cell(uv.x) };
+		const s64 v{ cell(uv.y) };
+		u32 i{ hash(group, u, v) };
+		while (slots[i].fan == fan) i = (i + 1) & mask;
+		slots[i] = slot{ u, v, group, vertex, fan };
+	}
+};
+
+// Scratch space for the fans (the corners of a vertex) that a worker welds, indexed by the corner's position
+// in the fan. It is kept for the worker's next chunk, so it only grows to the largest fan rather than being
+// allocated for every chunk.
+struct weld_scratch {
+	UTL::vector<u32>	groups;
+	UTL::vector<u32>	group_offsets;
+	UTL::vector<u32>	sorted;
+	UTL::vector<v3>		group_normals;
+	uv_cell_table		cells;
+
+	void reserve(u32 max_fan_size) {
+		if (groups.size() < max_fan_size) {
+			groups.resize(max_fan_size);
+			group_offsets.resize(max_fan_size + 1);
+			sorted.resize(max_fan_size);
+			group_normals.reserve(max_fan_size);
+		}
+		cells.reserve(max_fan_size);
+	}
+};
+
 /**
  * @param smoothing_angle angle between adjacent faces
  * smoothing_angle = 0°   -> totally smooth, blend normals for all vertices
  * smoothing_angle = 90°  -> medium, in-between angle > 90° will not blend normals
  * smoothing_angle = 180° -> totally hard, each triangle has its own normal
  */
-void process_normals(mesh& m, f32 smoothing_angle) {
-	const f32 cos_alpha{ XMScalarCos(pi - smoothing_angle * pi / 180.0f) }; 
-	const bool is_hard_edge{ XMScalarNearEqual(smoothing_angle, 180.0f, epsilon) }; // cos_angle = 1 -> complete hard mode
-	const bool is_soft_edge{ XMScalarNearEqual(smoothing_angle, 0.0f, epsilon) }; // cos_angle = -1 -> complete smooth mode
-	const u32 num_indices{ static_cast<u32>(m.raw_indices.size()) };
-	const u32 num_vertices{ static_cast<u32>(m.positions.size()) };
-	assert(num_indices && num_vertices);
-
-	m.indices.resize(num_indices);
-
-	// NOTE: for each vertex, we have an idx_ref list, indicating the appearing index of each vertex in the raw_indices vector
-	UTL::vector<UTL::vector<u32>> idx_ref(num_vertices);
-	for (u32 i{ 0 }; i < num_indices; ++i) {
-		idx_ref[m.raw_indices[i]].emplace_back(i);
-	}
-
-	for (u32 i{ 0 }; i < num_vertices; ++i) { // for each vertex
-		auto& refs{ idx_ref[i] };
-		u32 num_refs{ static_cast<u32>(refs.size()) };
-		for (u32 j{ 0 }; j < num_refs; ++j) { 
-			// for each appearing index of a vertex in the raw_indices vector 
-			// -> for each appearing of a vertex in a single triangle
-			m.indices[refs[j]] = static_cast<u32>(m.vertices.size());  
-			vertex& v{ m.vertices.emplace_back() }; // default constructor
-			v.position = m.positions[m.raw_indices[refs[j]]]; // use the original position information
-
-			// blending
-			XMVECTOR n1{ XMLoadFloat3(&m.normals[refs[j]]) };
-			if (!is_hard_edge) {
-				for (u32 k{ j + 1 }; k < num_refs; ++k) {
+struct smoothing {
+	f32		cos_alpha;
+	bool	is_hard_edge;
+	bool	is_soft_edge;
+
+	explicit smoothing(f32 smoothing_angle) :
+		cos_alpha{ XMScalarCos(pi - smoothing_angle * pi / 180.0f) },
+		is_hard_edge{ XMScalarNearEqual(smoothing_angle, 180.0f, epsilon) }, // cos_angle = 1 -> complete hard mode
+		is_soft_edge{ XMScalarNearEqual(smoothing_angle, 0.0f, epsilon) } {} // cos_angle = -1 -> complete smooth mode
+};
+
+/**
+ * Welds the corners of the vertices [begin, end) into as few vertices as the normals and uvs allow, in one sweep.
+ * First the corners of a vertex are put into smoothing groups, then a group gets one vertex per distinct uv.
+ * The vertices are appended to 'vertices', and m.indices of the corners get their index among the appended ones.
+ */
+void weld_vertices(mesh& m, const vertex_corners& vc, const smoothing& smooth, u32 begin, u32 end,
+				   weld_scratch& scratch, UTL::vector<vertex>& vertices) {
+	// NOTE: without uvs all corners of a smoothing group have the same (default) uv, so they share one vertex.
+	const v2* const uvs{ (m.uv_sets.empty() || m.uv_sets[0].empty()) ? nullptr : m.uv_sets[0].data() };
+	assert(!uvs || m.uv_sets[0].size() == m.raw_indices.size());
+	assert(m.indices.size() == m.raw_indices.size() && end < vc.offsets.size());
+
+	u32 max_fan_size{ 0 };
+	for (u32 i{ begin }; i < end; ++i) {
+		max_fan_size = std::max(max_fan_size, vc.offsets[i + 1] - vc.offsets[i]);
+	}
+	scratch.reserve(max_fan_size);
+	const u32 first_vertex{ static_cast<u32>(vertices.size()) };
+	UTL::vector<u32>& groups{ scratch.groups };
+	UTL::vector<u32>& group_offsets{ scratch.group_offsets };
+	UTL::vector<u32>& sorted{ scratch.sorted };
+	UTL::vector<v3>& group_normals{ scratch.group_normals };
+	uv_cell_table& cells{ scratch.cells };
+
+	for (u32 i{ begin }; i < end; ++i) {
+		const u32* const fan{ vc.corners.data() + vc.offsets[i] };
+		const u32 fan_size{ vc.offsets[i + 1] - vc.offsets[i] };
+		if (!fan_size) continue;
+
+		// smoothing groups: the first corner that isn't in a group yet starts one, and the following corners join it
+		// if their normal is within the smoothing angle of the normals blended so far.
+		u32 num_groups{ 0 };
+		group_normals.clear();
+		std::fill(groups.begin(), groups.begin() + fan_size, u32_invalid_id);
+		for (u32 j{ 0 }; j < fan_size; ++j) {
+			if (groups[j] != u32_invalid_id) continue;
+			groups[j] = num_groups;
+
+			XMVECTOR n1{ XMLoadFloat3(&m.normals[fan[j]]) };
+			if (!smooth.is_hard_edge) {
+				for (u32 k{ j + 1 }; k < fan_size; ++k) {
+					if (groups[k] != u32_invalid_id) continue;
 					f32 cos_theta{ 0.0f };
-					XMVECTOR n2{ XMLoadFloat3(&m.normals[refs[k]]) }; 
-					if (!is_soft_edge) { 
-						// calculate the cos value of in-between angle
-						// NOTE: since n1 is picked outside the loop iteration, and 
-						//		 it can possibly be changed int the loop iteration, 
-						//		 we have to calculate the reciprocal length of it explicitly.
-						//		 n2 is picked in the loop iteration so it can only be normalized.
+					XMVECTOR n2{ XMLoadFloat3(&m.normals[fan[k]]) };
+					if (!smooth.is_soft_edge) {
+						// NOTE: n1 is the sum of the blended normals, so its reciprocal length is calculated explicitly.
+						//		 n2 is a face normal, so it is normalized already.
 						//		 cos(alpha) = dot(n1, n2) / (||n1|| * ||n2||)
 						XMStoreFloat(&cos_theta, XMVector3Dot(n1, n2) * XMVector3ReciprocalLength(n1));
 					}
 
-					if (is_soft_edge || cos_theta >= cos_alpha) {
+					if (smooth.is_soft_edge || cos_theta >= smooth.cos_alpha) {
 						n1 += n2; // blend normals
-						m.indices[refs[k]] = m.indices[refs[j]]; // share vertex
-						refs.erase(refs.begin() + k); // if shared, remove the second ref so we don't have to count it in the following computing
-						--num_refs; // influence the outer j loop
-						--k; // k-idx ref was removed, influence the inner loop
+						groups[k] = num_groups;
 					}
 				}
 			}
-			XMStoreFloat3(&v.normal, XMVector3Normalize(n1));
+			XMStoreFloat3(&group_normals.emplace_back(), XMVector3Normalize(n1));
+			++num_groups;
 		}
-	}
-}
 
-void process_uvs(mesh& m) {
-	UTL::vector<vertex> old_vertices;
-	old_vertices.swap(m.vertices); // m.vertices is empty now
-	UTL::vector<u32> old_indices(m.indices.size());
-	old_indices.swap(m.indices);
-
-	const u32 num_vertices{ static_cast<u32>(old_vertices.size()) };
-	const u32 num_indices{ static_cast<u32>(old_indices.size()) };
-	assert(num_indices && num_vertices);
-
-
-	UTL::vector<UTL::vector<u32>> idx_ref(num_vertices);
-	for (u32 i{ 0 }; i < num_indices; ++i)
-		idx_ref[old_indices[i]].emplace_back(i); // we can try use emplace_back, but sometimes it's slower for integer when doing algorithm
+		// visit the corners group by group, in ascending order within a group, so the vertices are numbered
+		// the same way as when the normals and the uvs were welded one after the other.
+		std::fill(group_offsets.begin(), group_offsets.begin() + num_groups + 1, 0);
+		for (u32 j{ 0 }; j < fan_size; ++j) {
+			++group_offsets[groups[j] + 1];
+		}
+		for (u32 g{ 0 }; g < num_groups; ++g) {
+			group_offsets[g + 1] += group_offsets[g];
+		}
+		for (u32 j{ 0 }; j < fan_size; ++j) {
+			sorted[group_offsets[groups[j]]++] = j;
+		}
 
-	for (u32 i{ 0 }; i < num_vertices; ++i) {
-		auto& refs{ idx_ref[i] };
-		u32 num_refs{ static_cast<u32>(refs.size()) };
-		for (u32 j{ 0 }; j < num_refs; ++j) {
-			m.indices[refs[j]] = static_cast<u32>(m.vertices.size());
-			vertex& v{ old_vertices[old_indices[refs[j]]] };
-			v.uv = m.uv_sets[0][refs[j]];
-			m.vertices.emplace_back(v);
-
-			for (u32 k{ j + 1 }; k < num_refs; ++k) {
-				v2& uv1{ m.uv_sets[0][refs[k]] };
-				if (XMScalarNearEqual(v.uv.x, uv1.x, epsilon) && XMScalarNearEqual(v.uv.y, uv1.y, epsilon)) {
-					m.indices[refs[k]] = m.indices[refs[j]];
-					refs.erase(refs.begin() + k);
-					--num_refs;
-					--k;
-				}
+		cells.next_fan();
+		for (u32 j{ 0 }; j < fan_size; ++j) {
+			const u32 corner{ fan[sorted[j]] };
+			const u32 group{ groups[sorted[j]] };
+			const v2 uv{ uvs ? uvs[corner] : v2{} };
+
+			u32 index{ cells.find(group, uv, vertices) };
+			if (index == u32_invalid_id) {
+				index = static_cast<u32>(vertices.size());
+				vertex& v{ vertices.emplace_back() }; // default constructor
+				v.position = m.positions[i];
+				v.normal = group_normals[group];
+				v.uv = uv;
+				cells.add(group, uv, index);
 			}
-			// we have already added the new vertex into vertices, look back
+			m.indices[corner] = index - first_vertex;
 		}
 	}
 }
@@ -342,22 +477,6 @@ void determine_elements_type(mesh& m) {
 	// TODO: we lack data for skeletal meshes. Expand for skeletal meshes.
 }
 
-void process_vertices(mesh& m, const geometry_import_settings& settings) {
-	assert((m.raw_indices.size() % 3) == 0);
-	if (settings.calculate_normals || m.normals.empty()) {
-		recalculate_normals(m);
-	}
-
-	process_normals(m, settings.smoothing_angle); // -> soft edge
-
-	if (!m.uv_sets.empty()) {
-		process_uvs(m);
-	}
-
-	determine_elements_type(m);
-	pack_vertices(m);
-}
-
 u64 get_mesh_size(const mesh& m) {
 	const u64 num_vertices{ m.vertices.size() };
 	const u64 position_buffer_size{ m.position_buffer.size() };
@@ -526,16 +645,212 @@ void split_meshes_by_material(scene& scene) {
 	}
 }
 
-}
+// What a worker keeps from one stage of process_scene() to the next, so it is allocated once per scene
+// rather than once per chunk.
+struct worker_arena {
+	weld_scratch		scratch;
+	UTL::vector<vertex>	vertices;		// welded by this worker, chunk after chunk
+};
+
+// Threads that run the stages of process_scene(). They are started once and wait for the next stage in between.
+// Each of them, and the calling thread, has an arena that lives as long as the pool.
+class workerPool {
+public:
+	explicit workerPool(u32 max_tasks) {
+		const u32 num_threads{ std::min(std::max(max_tasks, 1u), std::max(std::thread::hardware_concurrency(), 1u)) };
+		_arenas.resize(num_threads);
+		for (u32 i{ 1 }; i < num_threads; ++i) {
+			_threads.emplace_back([this, i]() { worker(i); });
+		}
+	}
+
+	~workerPool() {
+		{
+			std::lock_guard lock{ _mutex };
+			_is_stopping = true;
+		}
+		_start.notify_all();
+		for (auto& thread : _threads) {
+			thread.join();
+		}
+	}
+
+	DISABLE_COPY_AND_MOVE(workerPool);
+
+	// Runs func(i, arena) for every i in [0, count) and returns when all of them are done. Tasks are started
+	// in order, but may finish in any order. 'arena' belongs to the thread that runs the task.
+	template<typename function>
+	void run(u32 count, function&& func) {
+		if (!count) return;
+		{
+			std::lock_guard lock{ _mutex };
+			_task = [](void* const context, u32 i, worker_arena& arena) { (*static_cast<std::remove_reference_t<function>*>(context))(i, arena); };
+			_context = &func;
+			_count = count;
+			_next = 0;
+			_busy = static_cast<u32>(_threads.size());
+			++_stage;
+		}
+		_start.notify_all();
+
+		MEMORY_TAG(geometry);
+		execute(_arenas[0]);
+		std::unique_lock lock{ _mutex };
+		_done.wait(lock, [this]() { return !_busy; });
+	}
 
+private:
+	void worker(u32 index) {
+		MEMORY_TAG(geometry);
+		u32 stage{ 0 };
+		for (;;) {
+			{
+				std::unique_lock lock{ _mutex };
+				_start.wait(lock, [this, stage]() { return _is_stopping || _stage != stage; });
+				if (_is_stopping) return;
+				stage = _stage;
+			}
+			execute(_arenas[index]);
+			std::lock_guard lock{ _mutex };
+			if (!--_busy) _done.notify_one();
+		}
+	}
+
+	void execute(worker_arena& arena) {
+		for (u32 i{ _next++ }; i < _count; i = _next++) {
+			_task(_context, i, arena);
+		}
+	}
+
+	std::vector<std::thread>			_threads;
+	std::vector<worker_arena>			_arenas;		// [0] is the calling thread's
+	std::mutex							_mutex;
+	std::condition_variable				_start;
+	std::condition_variable				_done;
+	void								(*_task)(void*, u32, worker_arena&) { nullptr };
+	void*								_context{ nullptr };
+	u32									_count{ 0 };
+	std::atomic<u32>					_next{ 0 };
+	u32									_busy{ 0 };		// threads that haven't finished the stage yet
+	u32									_stage{ 0 };
+	bool								_is_stopping{ false };
+};
+
+// Meshes are split into chunks of this many triangles or vertices, so a large mesh keeps all threads busy.
+constexpr u32 triangles_per_chunk{ 64 * 1024 };
+constexpr u32 vertices_per_chunk{ 32 * 1024 };
+
+struct mesh_work {
+	mesh*				m;
+	vertex_corners		corners;
+	bool				has_new_normals;
+};
+
+struct triangle_chunk {
+	mesh*		m;
+	u32			begin;
+	u32			end;
+};
+
+// The vertices that a chunk welded are in the arena of the worker that welded them, until they are moved
+// to their place in the mesh.
+struct vertex_chunk {
+	mesh_work*			work;
+	u32					begin;
+	u32					end;
+	u32					first_vertex;
+	const worker_arena*	arena;
+	u32					arena_offset;
+	u32					vertex_count;
+};
+
+} // anonymous namespace
+
+/*
+ * The meshes are independent of each other, so each stage runs as one set of tasks for all meshes of the scene,
+ * on one pool of threads for all stages.
+ * Every task writes to its own part of a mesh, and vertices are numbered per chunk and then offset by the
+ * vertex count of the chunks before it, so the result is the same no matter how many threads run the tasks.
+ */
 void process_scene(scene& scene, const geometry_import_settings& settings) {
 	split_meshes_by_material(scene);
 
+	std::vector<mesh_work> work;
 	for (auto& lod : scene.lod_groups) {
 		for (auto& m : lod.meshes) {
-			process_vertices(m, settings);
+			assert((m.raw_indices.size() % 3) == 0 && m.raw_indices.size() && m.positions.size());
+			work.emplace_back(mesh_work{ &m, {}, settings.calculate_normals || m.normals.empty() });
 		}
 	}
+
+	std::vector<triangle_chunk> triangle_chunks;
+	std::vector<vertex_chunk> vertex_chunks;
+	for (auto& w : work) {
+		const u32 num_triangles{ static_cast<u32>(w.m->raw_indices.size() / 3) };
+		for (u32 i{ 0 }; w.has_new_normals && i < num_triangles; i += triangles_per_chunk) {
+			triangle_chunks.emplace_back(triangle_chunk{ w.m, i, std::min(i + triangles_per_chunk, num_triangles) });
+		}
+		const u32 num_vertices{ static_cast<u32>(w.m->positions.size()) };
+		for (u32 i{ 0 }; i < num_vertices; i += vertices_per_chunk) {
+			vertex_chunks.emplace_back(vertex_chunk{ &w, i, std::min(i + vertices_per_chunk, num_vertices), 0, nullptr, 0, 0 });
+		}
+	}
+
+	// NOTE: one pool for all stages, there is no point in having more threads than the largest stage has tasks.
+	workerPool pool{ static_cast<u32>(std::max({ work.size(), triangle_chunks.size(), vertex_chunks.size() })) };
+
+	pool.run(static_cast<u32>(work.size()), [&work](u32 i, worker_arena&) {
+		mesh& m{ *work[i].m };
+		if (work[i].has_new_normals) {
+			m.normals.resize(m.raw_indices.size());
+		}
+		get_vertex_corners(m.raw_indices, static_cast<u32>(m.positions.size()), work[i].corners);
+		m.indices.resize(m.raw_indices.size());
+		m.vertices.clear();
+	});
+
+	pool.run(static_cast<u32>(triangle_chunks.size()), [&triangle_chunks](u32 i, worker_arena&) {
+		const triangle_chunk& chunk{ triangle_chunks[i] };
+		recalculate_normals(*chunk.m, chunk.begin, chunk.end);
+	});
+
+	const smoothing smooth{ settings.smoothing_angle };
+	pool.run(static_cast<u32>(vertex_chunks.size()), [&vertex_chunks, &smooth](u32 i, worker_arena& arena) {
+		vertex_chunk& chunk{ vertex_chunks[i] };
+		chunk.arena = &arena;
+		chunk.arena_offset = static_cast<u32>(arena.vertices.size());
+		weld_vertices(*chunk.work->m, chunk.work->corners, smooth, chunk.begin, chunk.end, arena.scratch, arena.vertices); // -> soft edge, uv seams
+		chunk.vertex_count = static_cast<u32>(arena.vertices.size()) - chunk.arena_offset;
+	});
+
+	// the chunks of a mesh are in order, so each one starts where the one before it ended.
+	for (u32 i{ 0 }; i < vertex_chunks.size(); ++i) {
+		vertex_chunk& chunk{ vertex_chunks[i] };
+		const bool is_first{ !i || vertex_chunks[i - 1].work != chunk.work };
+		chunk.first_vertex = is_first ? 0 : vertex_chunks[i - 1].first_vertex + vertex_chunks[i - 1].vertex_count;
+		const bool is_last{ i + 1 == vertex_chunks.size() || vertex_chunks[i + 1].work != chunk.work };
+		if (is_last) {
+			chunk.work->m->vertices.resize(chunk.first_vertex + chunk.vertex_count);
+		}
+	}
+
+	pool.run(static_cast<u32>(vertex_chunks.size()), [&vertex_chunks](u32 i, worker_arena&) {
+		const vertex_chunk& chunk{ vertex_chunks[i] };
+		mesh& m{ *chunk.work->m };
+		const vertex_corners& vc{ chunk.work->corners };
+		if (chunk.vertex_count) {
+			memcpy(&m.vertices[chunk.first_vertex], &chunk.arena->vertices[chunk.arena_offset], chunk.vertex_count * sizeof(vertex));
+		}
+		for (u32 c{ vc.offsets[chunk.begin] }; c < vc.offsets[chunk.end]; ++c) {
+			m.indices[vc.corners[c]] += chunk.first_vertex;
+		}
+	});
+
+	pool.run(static_cast<u32>(work.size()), [&work](u32 i, worker_arena&) {
+		mesh& m{ *work[i].m };
+		determine_elements_type(m);
+		pack_vertices(m);
+	});
 }
 
 void pack_data(const scene& scene, scene_data& data) {
@@ -0,0 +1,163 @@
+#include "PackageWriter.h"
+#include "..\Content\PackFormat.h"
+#include "..\Utilities\Compression.h"
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+
+namespace WAVEENGINE::TOOLS {
+
+namespace {
+
+using namespace CONTENT;
+
+struct blob_data {
+	UTL::vector<u8>		data;			// the file's content, to compare with files added later
+	UTL::vector<u8>		compressed;		// empty if the blob is stored uncompressed
+	pack_blob			blob;
+
+	const u8* stored() const { return compressed.empty() ? data.data() : compressed.data(); }
+};
+
+// Compresses the data if that makes it at least 1/8 smaller.
+// NOTE: the frame has no checksum of its own, pack_blob::crc already covers the stored frame.
+void compress_blob(blob_data& b) {
+	const u64 size{ b.data.size() };
+	if (!size) return;
+	b.compressed.resize(UTL::lz_frame_bound(size));
+	const u64 compressed_size{ UTL::lz_compress_frame(b.data.data(), size, b.compressed.data(), b.compressed.size(), false) };
+	if (compressed_size && compressed_size <= size - size / 8) {
+		b.compressed.resize(compressed_size);
+		b.blob.size = compressed_size;
+		b.blob.compression = pack_compression::lz;
+	}
+	else {
+		b.compressed = UTL::vector<u8>{};
+	}
+}
+
+bool read_file(const char* path, UTL::vector<u8>& data) {
+	std::ifstream file{ path, std::ios::in | std::ios::binary | std::ios::ate };
+	if (!file) return false;
+
+	const u64 size{ (u64)file.tellg() };
+	data.resize(size);
+	file.seekg(0);
+	return size == 0 || (bool)file.read(reinterpret_cast<char*>(data.data()), size);
+}
+
+u64 align_blob_offset(u64 offset, const pack_blob& blob) {
+	const u64 alignment{ blob.compression == pack_compression::none && blob.size >= pack_page_aligned_size ?
+		pack_page_alignment : pack_blob_alignment };
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Adds the file's data as a new blob, or returns the blob that already has the same content.
+u32 add_blob(UTL::vector<u8>&& data, UTL::vector<blob_data>& blobs, std::unordered_multimap<u64, u32>& blobs_by_hash) {
+	const u64 content_hash{ UTL::fnv1a_64(data.data(), data.size()) };
+	const auto range{ blobs_by_hash.equal_range(content_hash) };
+	for (auto it{ range.first }; it != range.second; ++it) {
+		const UTL::vector<u8>& other{ blobs[it->second].data };
+		// NOTE: compare the data as well, a hash collision must not merge two different files.
+		if (other.size() == data.size() && (data.empty() || !memcmp(other.data(), data.data(), data.size()))) {
+			return it->second;
+		}
+	}
+
+	pack_blob blob{};
+	blob.size = data.size();
+	blob.original_size = data.size();
+	blob.content_hash = content_hash;
+	blob.compression = pack_compression::none;
+
+	const u32 index{ (u32)blobs.size() };
+	blob_data& b{ blobs.emplace_back(blob_data{ std::move(data), {}, blob }) };
+	compress_blob(b);
+	b.blob.crc = UTL::crc32(b.stored(), b.blob.size);
+	blobs_by_hash.emplace(content_hash, index);
+	return index;
+}
+
+bool write_package(const char* output, const package_file* files, u32 count) {
+	UTL::vector<pack_entry> entries;
+	UTL::vector<blob_data> blobs;
+	std::unordered_multimap<u64, u32> blobs_by_hash;
+	entries.reserve(count);
+
+	for (u32 i{ 0 }; i < count; ++i) {
+		assert(files[i].name && files[i].path);
+		UTL::vector<u8> data;
+		if (!read_file(files[i].path, data)) return false;
+		entries.emplace_back(pack_entry{ pack_name_hash(files[i].name), add_blob(std::move(data), blobs, blobs_by_hash), 0 });
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const pack_entry& a, const pack_entry& b) { return a.name_hash < b.name_hash; });
+	for (u32 i{ 1 }; i < entries.size(); ++i) {
+		// the same name twice, or two names with the same hash, which the engine couldn't tell apart.
+		if (entries[i - 1].name_hash == entries[i].name_hash) return false;
+	}
+
+	pack_file_header header{};
+	header.magic = pack_file_magic;
+	header.version = pack_file_version;
+	header.entry_count = (u32)entries.size();
+	header.blob_count = (u32)blobs.size();
+	header.entries_offset = sizeof(pack_file_header);
+	header.blobs_offset = header.entries_offset + entries.size() * sizeof(pack_entry);
+
+	u64 offset{ header.blobs_offset + blobs.size() * sizeof(pack_blob) };
+	UTL::vector<pack_blob> blob_table;
+	blob_table.reserve(blobs.size());
+	for (auto& b : blobs) {
+		offset = align_blob_offset(offset, b.blob);
+		b.blob.offset = offset;
+		offset += b.blob.size;
+		blob_table.emplace_back(b.blob);
+	}
+	header.file_size = offset;
+	header.hash = UTL::fnv1a_64(entries.data(), entries.size() * sizeof(pack_entry));
+	header.hash = UTL::fnv1a_64(blob_table.data(), blob_table.size() * sizeof(pack_blob), header.hash);
+
+	// write to a temporary file first, so a failed write doesn't leave a broken package behind.
+	const std::filesystem::path path{ output };
+	std::filesystem::path temp_path{ path };
+	temp_path += ".tmp";
+	bool is_written{ false };
+	{
+		std::ofstream file{ temp_path, std::ios::out | std::ios::binary | std::ios::trunc };
+		if (file) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(pack_entry));
+			file.write(reinterpret_cast<const char*>(blob_table.data()), blob_table.size() * sizeof(pack_blob));
+			for (const auto& b : blobs) {
+				constexpr char padding[pack_page_alignment]{};
+				file.write(&padding[0], b.blob.offset - (u64)file.tellp());
+				file.write(reinterpret_cast<const char*>(b.stored()), b.blob.size);
+			}
+			file.close();
+			is_written = !file.fail();
+		}
+	}
+
+	std::error_code error{};
+	if (is_written) std::filesystem::rename(temp_path, path, error);
+	if (!is_written || error) {
+		// don't leave the partial package behind, the previous one (if any) is still in place.
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+// Writes the files into a .wpak package. Files with the same content are stored once, and compressed if that makes them smaller.
+// Returns false if a file can't be read, two files have the same name, or the package can't be written.
+EDITOR_INTERFACE bool
+WritePackage(const char* output, const package_file* files, u32 count) {
+	MEMORY_TAG(content);
+	assert(output && (files || !count));
+	return write_package(output, files, count);
+}
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "ToolsCommon.h"
+
+namespace WAVEENGINE::TOOLS {
+
+// A file to put into a package and the name the engine looks it up with, e.g. { "game.bin", "x64\Release\game.bin" }.
+struct package_file {
+	const char* name;
+	const char* path;
+};
+
+}
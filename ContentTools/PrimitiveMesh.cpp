@@ -332,6 +332,7 @@ void create_capsule(scene& scene, const primitive_init_info& info) {
 
 EDITOR_INTERFACE
 void CreatePrimitiveMesh(scene_data* data, primitive_init_info* info) {
+	MEMORY_TAG(geometry);
 	assert(data && info);
 	assert(info->type < primitive_mesh_type::count);
 	scene scene{};
@@ -26,6 +26,9 @@ inline void* alloc_interop_memory(sizeT size) {
 		}
 	}
 
+	// NOTE: the editor frees this memory, so it is only counted as an allocation of the current memory tag.
+	WAVEENGINE::MEMORY::record_external(WAVEENGINE::MEMORY::current_tag(), size);
+
 	// CoTaskMemAlloc is a windows com api
 	// it is safe to use between modules, dlls and coms, and it is also thread-safe
 	// However it is 15% slower than malloc because its bookkeeping and thread synchronization overhead
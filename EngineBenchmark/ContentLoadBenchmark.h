@@ -0,0 +1,243 @@
+#pragma once
+
+#include "..\WaveEngine\Content\ContentLoader.h"
+#include "..\WaveEngine\Content\GameFormat.h"
+#include "..\WaveEngine\Content\Streaming.h"
+#include "..\WaveEngine\Core\JobSystem.h"
+#include "..\WaveEngine\Utilities\Hash.h"
+#include "..\WaveEngine\EngineAPI\GameEntity.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+using namespace WAVEENGINE;
+
+// Scripts of the synthetic levels, every game.bin names the scripts of its entities.
+class benchmarkScriptA : public SCRIPT::entity_script {
+public:
+	constexpr explicit benchmarkScriptA(GAME_ENTITY::entity entity) : SCRIPT::entity_script{ entity } {}
+};
+
+class benchmarkScriptB : public SCRIPT::entity_script {
+public:
+	constexpr explicit benchmarkScriptB(GAME_ENTITY::entity entity) : SCRIPT::entity_script{ entity } {}
+};
+
+REGISTER_SCRIPT(benchmarkScriptA);
+REGISTER_SCRIPT(benchmarkScriptB);
+
+// Headless load time benchmark. Writes synthetic game.bin files, loads each of them a few times and reports
+// the fastest time of every load phase. The results are written to content_load_benchmark.csv. If
+// content_load_baseline.csv exists (a copy of an earlier result), phases that got slower are reported as regressions.
+class contentLoadBenchmark {
+public:
+	bool initialize() {
+		return JOBS::initialize() && STREAMING::initialize();
+	}
+
+	// Returns false if a level couldn't be written or loaded, or a phase regressed.
+	bool run() {
+		std::ofstream csv{ "content_load_benchmark.csv" };
+		csv << "entities,phase,ms\n";
+		const std::vector<result> baseline{ read_baseline("content_load_baseline.csv") };
+
+		std::cout << std::setw(10) << "entities" << std::setw(10) << "MB";
+		for (const char* name : phase_names) std::cout << std::setw(12) << name;
+		std::cout << std::setw(12) << "total" << std::setw(14) << "entities/s" << "\n";
+
+		for (const u32 count : entity_counts) {
+			const std::filesystem::path path{ "benchmark_" + std::to_string(count) + ".bin" };
+			if (!write_game_file(path, count)) {
+				std::cout << "Failed to write " << path.string() << "\n";
+				_is_passed = false;
+				continue;
+			}
+
+			CONTENT::load_stats best{};
+			for (u32 i{ 0 }; i < runs_per_count; ++i) {
+				CONTENT::reset_load_stats();
+				STREAMING::wait(CONTENT::stream_world_section(path, STREAMING::request_priority::critical));
+				const bool is_loaded{ CONTENT::update_streamed_sections() };
+				const CONTENT::load_stats stats{ CONTENT::get_load_stats() };
+				CONTENT::unload_game();
+				if (!is_loaded || stats.entities != count) {
+					std::cout << "Failed to load " << path.string() << "\n";
+					_is_passed = false;
+					break;
+				}
+				keep_fastest(best, stats, i == 0);
+			}
+			std::filesystem::remove(path);
+
+			const f64 phases[]{ best.read_ms, best.validate_ms, best.scripts_ms, best.transforms_ms, best.create_ms };
+			f64 total_ms{ 0.0 };
+			std::cout << std::setw(10) << count << std::setw(10) << std::fixed << std::setprecision(1) << best.bytes / (1024.0 * 1024.0);
+			for (u32 i{ 0 }; i < _countof(phases); ++i) {
+				total_ms += phases[i];
+				std::cout << std::setw(12) << std::setprecision(2) << phases[i];
+				csv << count << "," << phase_names[i] << "," << phases[i] << "\n";
+				check_regression(baseline, count, phase_names[i], phases[i]);
+			}
+			csv << count << ",total," << total_ms << "\n";
+			check_regression(baseline, count, "total", total_ms);
+			std::cout << std::setw(12) << total_ms << std::setw(14) << std::setprecision(0) << count / (total_ms / 1000.0) << "\n";
+			for (const auto& regression : _regressions) std::cout << regression << "\n";
+			_regressions.clear();
+		}
+
+		std::cout << (_is_passed ? "PASSED" : "FAILED") << "\n";
+		return _is_passed;
+	}
+
+	void shutdown() {
+		STREAMING::shutdown();
+		JOBS::shutdown();
+	}
+
+private:
+	struct result {
+		u32			entities;
+		std::string	phase;
+		f64			ms;
+	};
+
+	static constexpr u32 entity_counts[]{ 10'000, 100'000, 1'000'000 };
+	static constexpr u32 runs_per_count{ 3 };
+	static constexpr const char* phase_names[]{ "read", "validate", "scripts", "transforms", "create" };
+	// phases that are this much slower than the baseline are regressions, unless they are only slower by less than
+	// 'regression_min_ms', which is noise for short phases.
+	static constexpr f64 regression_tolerance{ 0.2 };
+	static constexpr f64 regression_min_ms{ 1.0 };
+
+	static void keep_fastest(CONTENT::load_stats& best, const CONTENT::load_stats& stats, bool is_first) {
+		if (is_first) {
+			best = stats;
+			return;
+		}
+		best.read_ms = (std::min)(best.read_ms, stats.read_ms);
+		best.validate_ms = (std::min)(best.validate_ms, stats.validate_ms);
+		best.scripts_ms = (std::min)(best.scripts_ms, stats.scripts_ms);
+		best.transforms_ms = (std::min)(best.transforms_ms, stats.transforms_ms);
+		best.create_ms = (std::min)(best.create_ms, stats.create_ms);
+	}
+
+	static std::vector<result> read_baseline(const char* path) {
+		std::vector<result> results;
+		std::ifstream file{ path };
+		std::string line;
+		std::getline(file, line); // header
+		while (std::getline(file, line)) {
+			std::istringstream fields{ line };
+			result r{};
+			std::string entities, ms;
+			if (std::getline(fields, entities, ',') && std::getline(fields, r.phase, ',') && std::getline(fields, ms)) {
+				r.entities = (u32)std::stoul(entities);
+				r.ms = std::stod(ms);
+				results.emplace_back(r);
+			}
+		}
+		return results;
+	}
+
+	void check_regression(const std::vector<result>& baseline, u32 entities, const char* phase, f64 ms) {
+		for (const auto& r : baseline) {
+			if (r.entities != entities || r.phase != phase) continue;
+			if (ms > r.ms * (1.0 + regression_tolerance) && ms - r.ms > regression_min_ms) {
+				std::ostringstream message;
+				message << std::fixed << std::setprecision(2) << "REGRESSION " << entities << " entities, " << phase << ": " << ms << " ms, baseline " << r.ms << " ms";
+				_regressions.emplace_back(message.str());
+				_is_passed = false;
+			}
+			return;
+		}
+	}
+
+	// Writes a game.bin in the v2 format with 'count' entities at random places, a quarter of them with a script.
+	static bool write_game_file(const std::filesystem::path& path, u32 count) {
+		using namespace CONTENT;
+		std::mt19937 random{ count };
+		std::uniform_real_distribution<f32> position{ -1000.f, 1000.f };
+		std::uniform_real_distribution<f32> angle{ -3.14159f, 3.14159f };
+		std::uniform_real_distribution<f32> scale{ 0.5f, 2.f };
+
+		constexpr u32 section_count{ (u32)game_section::count };
+		std::vector<u8> sections[section_count];
+		u32 counts[section_count]{};
+		u32 strides[section_count]{};
+		auto append = [&sections](game_section id, const void* const data, u64 size) {
+			std::vector<u8>& s{ sections[(u32)id] };
+			s.insert(s.end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+		};
+
+		for (u32 i{ 0 }; i < count; ++i) {
+			const bool has_script{ (i & 3) == 0 };
+			const u32 components{ (1u << (u32)game_component::transform) | (has_script ? 1u << (u32)game_component::script : 0u) };
+			const f32 p[3]{ position(random), position(random), position(random) };
+			const f32 r[3]{ angle(random), angle(random), angle(random) };
+			const f32 s[3]{ scale(random), scale(random), scale(random) };
+			const u64 id{ UTL::fnv1a_64(&i, sizeof(i)) };
+			append(game_section::entities, &components, sizeof(components));
+			append(game_section::transform_positions, &p[0], sizeof(p));
+			append(game_section::transform_rotations, &r[0], sizeof(r));
+			append(game_section::transform_scales, &s[0], sizeof(s));
+			append(game_section::entity_ids, &id, sizeof(id));
+			if (has_script) {
+				const u32 name{ (i >> 2) & 1 };
+				append(game_section::script_names, &name, sizeof(name));
+				++counts[(u32)game_section::script_names];
+			}
+		}
+
+		constexpr const char* script_names[]{ "benchmarkScriptA", "benchmarkScriptB" };
+		u32 offset{ (u32)(_countof(script_names) * sizeof(u32)) };
+		for (const char* name : script_names) {
+			append(game_section::strings, &offset, sizeof(offset));
+			offset += (u32)strlen(name) + 1;
+		}
+		for (const char* name : script_names) {
+			append(game_section::strings, name, strlen(name) + 1);
+		}
+
+		counts[(u32)game_section::entities] = count;
+		counts[(u32)game_section::transform_positions] = counts[(u32)game_section::transform_rotations] = counts[(u32)game_section::transform_scales] = count;
+		counts[(u32)game_section::entity_ids] = count;
+		counts[(u32)game_section::strings] = _countof(script_names);
+		strides[(u32)game_section::entities] = strides[(u32)game_section::script_names] = sizeof(u32);
+		strides[(u32)game_section::transform_positions] = strides[(u32)game_section::transform_rotations] = strides[(u32)game_section::transform_scales] = 3 * sizeof(f32);
+		strides[(u32)game_section::entity_ids] = sizeof(u64);
+
+		auto align = [](u64 offset) { return (offset + game_section_alignment - 1) & ~(game_section_alignment - 1); };
+		game_section_entry table[section_count]{};
+		u64 file_size{ sizeof(game_file_header) + sizeof(table) };
+		for (u32 i{ 0 }; i < section_count; ++i) {
+			file_size = align(file_size);
+			table[i] = { (game_section)i, UTL::crc32(sections[i].data(), sections[i].size()), file_size, sections[i].size(), counts[i], strides[i] };
+			file_size += sections[i].size();
+		}
+
+		game_file_header header{};
+		header.magic = game_file_magic;
+		header.version = game_file_version;
+		header.section_count = (u16)section_count;
+		header.hash = UTL::fnv1a_64(&table[0], sizeof(table));
+		header.file_size = file_size;
+
+		std::ofstream file{ path, std::ios::out | std::ios::binary | std::ios::trunc };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&table[0]), sizeof(table));
+		for (u32 i{ 0 }; i < section_count; ++i) {
+			constexpr char padding[game_section_alignment]{};
+			file.write(&padding[0], table[i].offset - (u64)file.tellp());
+			file.write(reinterpret_cast<const char*>(sections[i].data()), sections[i].size());
+		}
+		return (bool)file;
+	}
+
+	std::vector<std::string>	_regressions;		// of the entity count that is being measured
+	bool						_is_passed{ true };
+};
@@ -0,0 +1,20 @@
+#pragma comment(lib, "waveengine.lib")
+#include "ContentLoadBenchmark.h"
+
+#if _DEBUG
+#include <crtdbg.h>
+#endif
+
+// A console application that runs the benchmark once, so CI sees its output and fails on the exit code:
+// 0 if every level loaded without a regression, 1 otherwise.
+// NOTE: like the rest of the engine this only builds for Windows, the engine's math types are DirectXMath types.
+int main() {
+#if _DEBUG
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF); // detect memory leaks
+#endif
+
+	contentLoadBenchmark benchmark{};
+	const bool is_passed{ benchmark.initialize() && benchmark.run() };
+	benchmark.shutdown();
+	return is_passed ? 0 : 1;
+}
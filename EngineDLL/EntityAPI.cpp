@@ -7,6 +7,9 @@
 
 using namespace WAVEENGINE;
 
+// the editor marshals entity ids as int (see EngineAPI.cs)
+static_assert(sizeof(ID::id_type) == sizeof(s32), "The editor only supports 32 bit ids, set USE_64BIT_ID to 0.");
+
 namespace {
 
 struct transform_component {
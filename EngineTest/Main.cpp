@@ -13,6 +13,22 @@
 
 #include "TestRenderer.h"
 
+#elif TEST_RESOURCE_CACHE
+
+#include "TestResourceCache.h"
+
+#elif TEST_COMPRESSION
+
+#include "TestCompression.h"
+
+#elif TEST_OCCLUSION_CULLING
+
+#include "TestOcclusionCulling.h"
+
+#elif TEST_SPATIAL
+
+#include "TestSpatial.h"
+
 #else
 #error One of the tests need to be enabled
 #endif
@@ -42,6 +58,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	set_current_directory_to_executable_path();
 
 	engineTest test{};
+	int exit_code{ 0 };
 
 	if (test.initialize()) {
 		MSG msg{};
@@ -55,14 +72,18 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				TranslateMessage(&msg);
 				DispatchMessageW(&msg);
 
-				is_running &= (msg.message != WM_QUIT);
+				if (msg.message == WM_QUIT) {
+					is_running = false;
+					exit_code = (int)msg.wParam;	// headless tests quit with 1 when they fail
+				}
 			}
 
-			test.run();
+			// NOTE: don't run again after the test quit, headless tests quit at the end of their first run.
+			if (is_running) test.run();
 		}
 	}
 	test.shutdown();
-	return 0;
+	return exit_code;
 
 }
 
@@ -6,6 +6,10 @@
 #define TEST_ENTITY_COMPONENTS 0
 #define TEST_WINDOW 0
 #define TEST_RENDERER 1
+#define TEST_RESOURCE_CACHE 0
+#define TEST_COMPRESSION 0
+#define TEST_OCCLUSION_CULLING 0
+#define TEST_SPATIAL 0
 
 class test {
 	virtual bool initialize() = 0;
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Test.h"
+#include "..\WaveEngine\Utilities\Compression.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace WAVEENGINE;
+
+// Compresses and decompresses generated data with the LZ block and frame formats, and decodes corrupted frames,
+// and reports PASSED or FAILED.
+class engineTest : public test {
+public:
+	bool initialize() override { return true; }
+
+	void run() override {
+		const u64 sizes[]{ 0, 1, 5, 12, 13, 16, 17, 31, 100, 1000, 4097, 65536 + 37, 600 * 1024 + 3 };
+		for (const u64 size : sizes) {
+			test_round_trip(zeros(size), "zeros");
+			test_round_trip(random(size), "random");
+			test_round_trip(text(size), "text");
+			test_round_trip(mixed(size), "mixed");
+			for (const u32 period : { 2u, 3u, 5u, 7u, 8u, 12u, 15u, 16u, 17u, 31u, 33u }) {
+				test_round_trip(repeating(size, period), "repeating");
+			}
+		}
+		test_corrupt_frames(text(100 * 1024));
+		test_corrupt_frames(mixed(100 * 1024));
+
+		std::cout << (_is_passed ? "PASSED" : "FAILED") << "\n";
+#ifdef _WIN64
+		PostQuitMessage(_is_passed ? 0 : 1);
+#endif
+	}
+
+	void shutdown() override {}
+
+private:
+	using buffer = std::vector<u8>;
+
+	// Every buffer is exactly the size the codec asks for, so a copy past its end is caught by the debug heap.
+	void test_round_trip(const buffer& data, const char* name) {
+		const u64 size{ data.size() };
+		if (size <= UTL::lz_max_block_size) {
+			buffer block(UTL::lz_compress_bound(size));
+			block.resize(UTL::lz_compress(data.data(), size, block.data(), block.size()));
+			buffer result(size);
+			check(!block.empty() && UTL::lz_decompress(block.data(), block.size(), result.data(), size) && result == data, name, "block");
+			// a block that doesn't fit into less than the bound is reported as 0, not cut short.
+			if (!block.empty()) check(!UTL::lz_compress(data.data(), size, buffer(block.size() - 1).data(), block.size() - 1), name, "block capacity");
+		}
+
+		for (const u32 block_size : { UTL::lz_default_block_size, 1000u }) {
+			for (const bool has_checksum : { true, false }) {
+				const buffer frame{ compress_frame(data, has_checksum, block_size) };
+				buffer result(UTL::lz_frame_original_size(frame.data(), frame.size()));
+				check(result.size() == size && UTL::lz_decompress_frame(frame.data(), frame.size(), result.data(), size) && result == data,
+					name, has_checksum ? "frame with checksum" : "frame");
+			}
+		}
+	}
+
+	// Corrupt frames with a checksum never decode to the wrong data, and without one they at least never touch memory
+	// outside of the two buffers.
+	void test_corrupt_frames(const buffer& data) {
+		std::mt19937 rng{ 43 };
+		for (const bool has_checksum : { true, false }) {
+			const buffer frame{ compress_frame(data, has_checksum, 16 * 1024) };
+			for (u32 i{ 0 }; i < 2000; ++i) {
+				buffer corrupt{ frame };
+				const u32 flips{ 1 + rng() % 4 };
+				for (u32 j{ 0 }; j < flips; ++j) {
+					corrupt[rng() % corrupt.size()] ^= (u8)(1 + rng() % 255);
+				}
+				if (corrupt == frame) continue;
+				buffer result(data.size());
+				const bool is_decoded{ UTL::lz_decompress_frame(corrupt.data(), corrupt.size(), result.data(), result.size()) };
+				// NOTE: a flip that only clears the checksum flag still decodes the right data.
+				if (has_checksum) check(!is_decoded || result == data, "corrupt", "frame with checksum");
+			}
+			check(UTL::lz_decompress_frame(frame.data(), frame.size() - 1, buffer(data.size()).data(), data.size()) == false,
+				"truncated", has_checksum ? "frame with checksum" : "frame");
+		}
+	}
+
+	static buffer compress_frame(const buffer& data, bool has_checksum, u32 block_size) {
+		buffer frame(UTL::lz_frame_bound(data.size(), block_size));
+		frame.resize(UTL::lz_compress_frame(data.data(), data.size(), frame.data(), frame.size(), has_checksum, block_size));
+		return frame;
+	}
+
+	static buffer zeros(u64 size) { return buffer(size, 0); }
+
+	static buffer random(u64 size) {
+		std::mt19937 rng{ (u32)size };
+		buffer data(size);
+		for (auto& b : data) b = (u8)rng();
+		return data;
+	}
+
+	static buffer repeating(u64 size, u32 period) {
+		buffer data(size);
+		for (u64 i{ 0 }; i < size; ++i) data[i] = (u8)((i % period) * 37 + 1);
+		return data;
+	}
+
+	// words from a small dictionary: short literals and short matches at all kinds of offsets.
+	static buffer text(u64 size) {
+		static const char* const words[]{ "entity", "transform", "script", "position", "rotation", "scale", "mesh",
+			"material", " ", " ", ", ", "\n", "0.5", "1.0", "-2.25", "{", "}" };
+		std::mt19937 rng{ 7 };
+		buffer data;
+		data.reserve(size);
+		while (data.size() < size) {
+			for (const char* c{ words[rng() % _countof(words)] }; *c && data.size() < size; ++c) data.emplace_back((u8)*c);
+		}
+		return data;
+	}
+
+	// random runs of up to 300 bytes and copies of earlier data of up to 300 bytes: long literals and long matches.
+	static buffer mixed(u64 size) {
+		std::mt19937 rng{ 11 };
+		buffer data;
+		data.reserve(size);
+		while (data.size() < size) {
+			const u64 length{ (std::min)((u64)(1 + rng() % 300), size - data.size()) };
+			if (data.size() > 16 && rng() % 2) {
+				const u64 offset{ 1 + rng() % (std::min)(data.size(), (u64)UTL::lz_max_offset) };
+				for (u64 i{ 0 }; i < length; ++i) data.emplace_back(data[data.size() - offset]);
+			}
+			else {
+				for (u64 i{ 0 }; i < length; ++i) data.emplace_back((u8)rng());
+			}
+		}
+		return data;
+	}
+
+	void check(bool condition, const char* data, const char* format) {
+		if (!condition) {
+			std::cout << "FAILED: " << data << " " << format << "\n";
+			_is_passed = false;
+		}
+	}
+
+	bool _is_passed{ true };
+};
@@ -3,9 +3,13 @@
 #include "Test.h"
 #include "..\WaveEngine\Components\Entity.h"
 #include "..\WaveEngine\Components\Transform.h"
+#include "..\WaveEngine\Components\EntityQuery.h"
+#include "..\WaveEngine\Core\JobSystem.h"
+#include "..\WaveEngine\Content\WorldSnapshot.h"
 
 #include <iostream>
 #include <ctime>
+#include <vector>
 
 using namespace WAVEENGINE;
 
@@ -13,7 +17,7 @@ class engineTest : public test {
 public:
 	bool initialize() override { 
 		srand((u32)time(nullptr));
-		return true; 
+		return JOBS::initialize(); 
 	}
 
 	void run() override {
@@ -28,7 +32,7 @@ public:
 	}
 
 	void shutdown() override {
-		// empty
+		JOBS::shutdown();
 	}
 
 private:
@@ -71,6 +75,123 @@ private:
 	void print_results() {
 		std::cout << "Entities created " << _added << "\n";
 		std::cout << "Entities removed " << _removed << "\n";
+
+		// every live entity has a transform, so the query has to visit exactly the entities we keep track of
+		const u32 queried{ GAME_ENTITY::count<TRANSFORM::component>() };
+		assert(queried == _entities.size());
+		std::cout << "Entities queried " << queried << "\n";
+
+		// a query may name the same component type twice, it visits the same entities.
+		[[maybe_unused]] const u32 queried_twice{ GAME_ENTITY::count<TRANSFORM::component, TRANSFORM::component>() };
+		assert(queried_twice == queried);
+
+		test_parallel_query();
+		test_parallel_changes();
+		test_world_snapshot();
+	}
+
+	// The parallel query has to visit every live entity exactly once, with small chunks so that it runs on several workers.
+	void test_parallel_query() {
+		std::vector<u32> visits;
+		for (const auto& entity : _entities) {
+			const u32 index{ (u32)ID::index(entity.get_id()) };
+			if (index >= visits.size()) visits.resize(index + 1, 0);
+		}
+
+		// NOTE: every entity has its own counter, so the chunks never write to the same element.
+		GAME_ENTITY::for_each_parallel<TRANSFORM::component>([&visits](GAME_ENTITY::entity entity, TRANSFORM::component transform) {
+			assert(transform.is_valid() && ID::index(entity.get_id()) < visits.size());
+			++visits[ID::index(entity.get_id())];
+			}, 64);
+
+		u32 visited{ 0 };
+		for (const auto& entity : _entities) {
+			assert(visits[ID::index(entity.get_id())] == 1);
+			visited += visits[ID::index(entity.get_id())];
+		}
+		assert(visited == _entities.size());
+		std::cout << "Entities queried in parallel " << visited << "\n";
+	}
+
+	// Transforms that are moved in a parallel query have to show up in the next published version, and nothing else.
+	void test_parallel_changes() {
+		const u32 cursor{ TRANSFORM::publish_changes() };
+		std::vector<u8> is_moved;
+		for (const auto& entity : _entities) {
+			const u32 index{ (u32)ID::index(entity.get_id()) };
+			if (index >= is_moved.size()) is_moved.resize(index + 1, 0);
+			is_moved[index] = rand() % 3 == 0;
+		}
+
+		GAME_ENTITY::for_each_parallel<TRANSFORM::component>([&is_moved](GAME_ENTITY::entity entity, TRANSFORM::component transform) {
+			if (is_moved[ID::index(entity.get_id())]) transform.set_position(MATH::v3{ 1.0f, 2.0f, 3.0f });
+			}, 64);
+		[[maybe_unused]] const u32 version{ TRANSFORM::publish_changes() };
+		assert(version == cursor + 1);
+
+		UTL::vector<TRANSFORM::changed_range> ranges;
+		[[maybe_unused]] const u32 latest{ TRANSFORM::get_changes(cursor, ranges) };
+		assert(latest == version);
+		std::vector<u8> is_changed(is_moved.size(), 0);
+		u32 changed{ 0 };
+		for (const auto& range : ranges) {
+			for (u32 i{ range.first }; i < range.first + range.count; ++i) {
+				assert(i < is_changed.size() && !is_changed[i]);
+				is_changed[i] = 1;
+				++changed;
+			}
+		}
+		assert(is_changed == is_moved);
+		std::cout << "Transforms changed in parallel " << changed << "\n";
+	}
+
+	// Saves the world, changes it and restores the snapshot, which has to bring back exactly the saved entities.
+	// Broken snapshots have to be rejected without touching the world.
+	void test_world_snapshot() {
+		std::vector<GAME_ENTITY::entity> saved{ _entities.begin(), _entities.end() };
+		std::vector<MATH::v3> positions;
+		for (u32 i{ 0 }; i < saved.size(); ++i) {
+			positions.emplace_back((f32)i, (f32)rand(), 1.0f);
+			saved[i].transform().set_position(positions.back());
+		}
+		const u64 size{ CONTENT::world_snapshot_size() };
+		std::vector<u8> snapshot(size);
+		[[maybe_unused]] bool result{ CONTENT::save_world_snapshot(snapshot.data(), size) };
+		assert(result);
+
+		// mutate: move everything, then remove and create entities.
+		for (const auto& entity : saved) {
+			entity.transform().set_position(MATH::v3{ -1.0f, -1.0f, -1.0f });
+		}
+		for (u32 i{ 0 }; i < 10; ++i) {
+			create_random();
+			remove_random();
+		}
+
+		// a truncated snapshot, and one that claims more entity slots than it holds.
+		std::vector<u8> broken{ snapshot.begin(), snapshot.end() - 1 };
+		const u64 broken_size{ broken.size() };
+		memcpy(&broken[sizeof(u32) * 3], &broken_size, sizeof(u64));
+		result = CONTENT::restore_world_snapshot(broken.data(), broken.size());
+		assert(!result);
+		broken = snapshot;
+		const u32 slot_count{ u32_invalid_id };
+		memcpy(&broken[sizeof(u32) * 3 + sizeof(u64)], &slot_count, sizeof(u32));
+		result = CONTENT::restore_world_snapshot(broken.data(), broken.size());
+		assert(!result);
+		assert(GAME_ENTITY::count<TRANSFORM::component>() == _entities.size());
+
+		result = CONTENT::restore_world_snapshot(snapshot.data(), size);
+		assert(result);
+		_entities.clear();
+		for (u32 i{ 0 }; i < saved.size(); ++i) {
+			assert(GAME_ENTITY::is_alive(saved[i].get_id()));
+			[[maybe_unused]] const MATH::v3 position{ saved[i].transform().position() };
+			assert(position.x == positions[i].x && position.y == positions[i].y && position.z == positions[i].z);
+			_entities.push_back(saved[i]);
+		}
+		assert(GAME_ENTITY::count<TRANSFORM::component>() == _entities.size());
+		std::cout << "Entities restored from snapshot " << _entities.size() << "\n";
 	}
 
 	UTL::vector<GAME_ENTITY::entity> _entities;
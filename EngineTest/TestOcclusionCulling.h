@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Test.h"
+#include "..\WaveEngine\Graphics\OcclusionCulling.h"
+#include "..\WaveEngine\Core\JobSystem.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace WAVEENGINE;
+
+// Rasterizes two occluder quads that don't line up with the tiles, checks the depth of every pixel, and tests
+// small boxes at every position around them: boxes fully behind an occluder have to be culled, boxes beside
+// or in front of it have to stay visible, also where they straddle tile edges. Reports PASSED or FAILED.
+class engineTest : public test {
+public:
+	bool initialize() override { return JOBS::initialize(); }
+
+	void run() override {
+		// the camera is at the origin and looks down +z, so the view matrix is the identity.
+		using namespace DirectX;
+		XMStoreFloat4x4(&_view_projection, XMMatrixPerspectiveFovLH(XM_PIDIV2, (f32)_buffer.width() / (f32)_buffer.height(), near_z, far_z));
+
+		const screen_rect rects[]{ { 100.3f, 50.3f, 219.7f, 141.7f }, { 250.6f, 12.2f, 300.1f, 60.9f } };
+		const f32 depths[]{ 10.0f, 15.0f };
+		std::vector<MATH::v3> positions;
+		for (u32 i{ 0 }; i < _countof(rects); ++i) {
+			for (const MATH::v3& corner : quad(rects[i], depths[i])) positions.emplace_back(corner);
+		}
+		const u32 indices[]{ 0, 1, 2, 0, 2, 3 };
+		occluder occluders[_countof(rects)]{};
+		for (u32 i{ 0 }; i < _countof(rects); ++i) {
+			occluders[i] = { &positions[i * 4], &indices[0], 4, 6, {} };
+			XMStoreFloat4x4(&occluders[i].world, XMMatrixIdentity());
+		}
+		_buffer.render(occluders, _countof(occluders), _view_projection);
+
+		test_depth(rects, _countof(rects));
+		for (u32 i{ 0 }; i < _countof(rects); ++i) test_boxes(rects[i], depths[i]);
+
+		std::cout << (_is_passed ? "PASSED" : "FAILED") << "\n";
+#ifdef _WIN64
+		PostQuitMessage(_is_passed ? 0 : 1);
+#endif
+	}
+
+	void shutdown() override {
+		JOBS::shutdown();
+	}
+
+private:
+	using occluder = GRAPHICS::occluder;
+
+	struct screen_rect {
+		f32 min_x, min_y, max_x, max_y;		// pixels, y goes down
+	};
+
+	static constexpr f32 near_z{ 1.0f };
+	static constexpr f32 far_z{ 100.0f };
+	static constexpr f32 box_size{ 10.0f };	// pixels, more than a tile so boxes straddle tile edges
+
+	// the world position at depth z that is seen at pixel (x, y).
+	MATH::v3 unproject(f32 x, f32 y, f32 z) const {
+		const f32 ndc_x{ x / (f32)_buffer.width() * 2.0f - 1.0f };
+		const f32 ndc_y{ 1.0f - y / (f32)_buffer.height() * 2.0f };
+		return { ndc_x * z / _view_projection.m[0][0], ndc_y * z / _view_projection.m[1][1], z };
+	}
+
+	std::vector<MATH::v3> quad(const screen_rect& rect, f32 z) const {
+		return { unproject(rect.min_x, rect.min_y, z), unproject(rect.max_x, rect.min_y, z),
+			unproject(rect.max_x, rect.max_y, z), unproject(rect.min_x, rect.max_y, z) };
+	}
+
+	// a thin box whose near face covers 'rect' at depth z, the far face is a little smaller on screen.
+	SPATIAL::aabb box(const screen_rect& rect, f32 z) const {
+		const MATH::v3 a{ unproject(rect.min_x, rect.max_y, z) };
+		const MATH::v3 b{ unproject(rect.max_x, rect.min_y, z) };
+		return { a, { b.x, b.y, z + 0.1f } };
+	}
+
+	static bool contains(const screen_rect& outer, const screen_rect& inner, f32 margin) {
+		return inner.min_x >= outer.min_x + margin && inner.max_x <= outer.max_x - margin &&
+			inner.min_y >= outer.min_y + margin && inner.max_y <= outer.max_y - margin;
+	}
+
+	// pixels whose center is inside an occluder have its depth, all others are cleared to the far plane.
+	void test_depth(const screen_rect* const rects, u32 count) {
+		const f32* const depth{ _buffer.depth() };
+		for (u32 y{ 0 }; y < _buffer.height(); ++y) {
+			for (u32 x{ 0 }; x < _buffer.width(); ++x) {
+				const f32 px{ (f32)x + 0.5f }, py{ (f32)y + 0.5f };
+				bool is_covered{ false };
+				for (u32 i{ 0 }; i < count; ++i) {
+					is_covered |= px > rects[i].min_x && px < rects[i].max_x && py > rects[i].min_y && py < rects[i].max_y;
+				}
+				check(is_covered == (depth[(u64)y * _buffer.width() + x] < 1.0f), "pixel depth");
+			}
+		}
+	}
+
+	// Slides a box over the occluder and past its edges, one pixel at a time so that it starts at every offset
+	// in a tile. Pixels are only covered if their center is inside, so boxes within a pixel of an edge may go either way.
+	void test_boxes(const screen_rect& occluder_rect, f32 occluder_z) {
+		std::vector<SPATIAL::aabb> boxes;
+		std::vector<bool> expected;
+		for (f32 y{ occluder_rect.min_y - box_size - 4.0f }; y < occluder_rect.max_y + 4.0f; y += 1.0f) {
+			for (f32 x{ occluder_rect.min_x - box_size - 4.0f }; x < occluder_rect.max_x + 4.0f; x += 1.0f) {
+				const screen_rect rect{ x, y, x + box_size, y + box_size };
+				if (rect.min_x < 0.0f || rect.min_y < 0.0f || rect.max_x > (f32)_buffer.width() || rect.max_y > (f32)_buffer.height()) continue;
+
+				const SPATIAL::aabb in_front{ box(rect, occluder_z - 2.0f) };
+				check(_buffer.is_visible(in_front), "box in front");
+
+				const SPATIAL::aabb behind{ box(rect, occluder_z + 5.0f) };
+				if (contains(occluder_rect, rect, 1.0f)) {
+					check(!_buffer.is_visible(behind), "box behind");
+				}
+				else if (!contains(occluder_rect, rect, -1.0f)) {
+					check(_buffer.is_visible(behind), "box beside");
+				}
+				else {
+					continue;
+				}
+				boxes.emplace_back(behind);
+				expected.emplace_back(!contains(occluder_rect, rect, 1.0f));
+			}
+		}
+
+		// the batched test has to give the same answers, with the indices written over themselves.
+		std::vector<u32> indices(boxes.size());
+		for (u32 i{ 0 }; i < indices.size(); ++i) indices[i] = i;
+		const u32 visible_count{ _buffer.test(boxes.data(), indices.data(), (u32)indices.size(), indices.data()) };
+		u32 next{ 0 };
+		for (u32 i{ 0 }; i < expected.size(); ++i) {
+			if (!expected[i]) continue;
+			check(next < visible_count && indices[next] == i, "batched test");
+			++next;
+		}
+		check(next == visible_count, "batched test count");
+	}
+
+	void check(bool condition, const char* name) {
+		if (!condition) {
+			if (++_failures <= 10) std::cout << "FAILED: " << name << "\n";
+			_is_passed = false;
+		}
+	}
+
+	GRAPHICS::occlusionBuffer	_buffer{};
+	MATH::m4x4					_view_projection{};
+	u32							_failures{ 0 };
+	bool						_is_passed{ true };
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "Test.h"
+#include "..\WaveEngine\Content\ResourceCache.h"
+#include "..\WaveEngine\Content\Streaming.h"
+#include "..\WaveEngine\Core\JobSystem.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace WAVEENGINE;
+
+// Runs the resource cache through acquire, release, eviction, cancellation and reload with small blob files,
+// and reports PASSED or FAILED.
+class engineTest : public test {
+public:
+	bool initialize() override {
+		return JOBS::initialize() && STREAMING::initialize();
+	}
+
+	void run() override {
+		RESOURCES::set_evict_callback(RESOURCES::resource_type::blob, on_evict);
+
+		test_reacquire_evicted();
+		test_eviction_order();
+		test_cancel_while_loading();
+		test_reload_referenced();
+
+		for (const auto& path : _files) std::filesystem::remove(path);
+		std::cout << (_is_passed ? "PASSED" : "FAILED") << "\n";
+#ifdef _WIN64
+		PostQuitMessage(_is_passed ? 0 : 1);
+#endif
+	}
+
+	void shutdown() override {
+		STREAMING::shutdown();
+		RESOURCES::shutdown();
+		JOBS::shutdown();
+	}
+
+private:
+	using blob_handle = RESOURCES::blob_handle;
+	using resource_state = RESOURCES::resource_state;
+
+	static constexpr RESOURCES::resource_type blob{ RESOURCES::resource_type::blob };
+	// NOTE: every test ends with a budget of 0, which evicts all unreferenced blobs, so the next one starts empty.
+
+	// An evicted resource keeps its handle, acquiring it again loads the file again.
+	void test_reacquire_evicted() {
+		RESOURCES::set_budget(blob, 250, 0);
+		const std::filesystem::path a{ write_file("resource_cache_a.bin", 100, 'a') };
+		const std::filesystem::path b{ write_file("resource_cache_b.bin", 200, 'b') };
+
+		const blob_handle handle{ RESOURCES::acquire<blob>(a) };
+		const blob_handle same{ RESOURCES::acquire<blob>("./resource_cache_a.bin") };
+		check(same == handle, "a path is loaded once");
+		RESOURCES::release(same);
+		RESOURCES::wait(handle);
+		check(RESOURCES::get_state(handle) == resource_state::resident, "blob is resident");
+		RESOURCES::release(handle);
+		check(RESOURCES::get_state(handle) == resource_state::resident, "released blob stays cached");
+
+		const blob_handle other{ RESOURCES::acquire<blob>(b) };
+		RESOURCES::wait(other);
+		check(RESOURCES::get_state(handle) == resource_state::unloaded, "released blob is evicted over budget");
+
+		const blob_handle again{ RESOURCES::acquire<blob>(a) };
+		check(again == handle, "evicted blob keeps its handle");
+		RESOURCES::wait(again);
+		check(RESOURCES::get_state(again) == resource_state::resident && is_filled(RESOURCES::get_blob(again), 100, 'a'),
+			"evicted blob is loaded again");
+
+		RESOURCES::release(again);
+		RESOURCES::release(other);
+		RESOURCES::set_budget(blob, 0, 0);
+	}
+
+	// Unreferenced resources are evicted in the order they were released, referenced ones never.
+	void test_eviction_order() {
+		RESOURCES::set_budget(blob, 1024, 0);
+		blob_handle handles[4];
+		for (u32 i{ 0 }; i < _countof(handles); ++i) {
+			const std::string name{ "resource_cache_order_" + std::to_string(i) + ".bin" };
+			handles[i] = RESOURCES::acquire<blob>(write_file(name, 100, (char)('0' + i)));
+		}
+		for (const auto& handle : handles) RESOURCES::wait(handle);
+
+		RESOURCES::release(handles[2]);
+		RESOURCES::release(handles[0]);
+		RESOURCES::release(handles[1]);
+		_evicted.clear();
+		// 'handles[3]' is referenced, so it has to stay even though the cache is still over budget.
+		RESOURCES::set_budget(blob, 50, 0);
+		check(_evicted.size() == 3 && _evicted[0] == handles[2].get_id() && _evicted[1] == handles[0].get_id() &&
+			_evicted[2] == handles[1].get_id(), "least recently released is evicted first");
+		check(RESOURCES::get_state(handles[3]) == resource_state::resident, "referenced blob is never evicted");
+		check(RESOURCES::get_usage(blob).resident_count == 1 && RESOURCES::get_usage(blob).cpu_bytes == 100, "usage after eviction");
+
+		RESOURCES::release(handles[3]);
+		check(RESOURCES::get_state(handles[3]) == resource_state::unloaded, "released blob over budget is evicted");
+		RESOURCES::set_budget(blob, 0, 0);
+	}
+
+	// Releasing a resource that is still loading cancels the read, or caches the data if the read had started.
+	void test_cancel_while_loading() {
+		RESOURCES::set_budget(blob, 64 * 1024 * 1024, 0);
+		// NOTE: the streaming thread is kept busy with a large file, so the next read is still queued when it's released.
+		const blob_handle busy{ RESOURCES::acquire<blob>(write_file("resource_cache_large.bin", 16 * 1024 * 1024, 'l'),
+			STREAMING::request_priority::critical) };
+		const blob_handle handle{ RESOURCES::acquire<blob>(write_file("resource_cache_cancel.bin", 100, 'c'),
+			STREAMING::request_priority::low) };
+		check(RESOURCES::get_state(handle) == resource_state::loading, "acquired blob is loading");
+		RESOURCES::release(handle);
+		const resource_state released{ RESOURCES::get_state(handle) };
+		check(released == resource_state::unloaded || released == resource_state::loading, "released blob is cancelled");
+
+		RESOURCES::wait(busy);
+		for (u32 i{ 0 }; i < 1000 && RESOURCES::get_state(handle) == resource_state::loading; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			RESOURCES::update();
+		}
+		const resource_state settled{ RESOURCES::get_state(handle) };
+		check(settled == resource_state::unloaded || settled == resource_state::resident, "cancelled blob doesn't stay loading");
+
+		const blob_handle again{ RESOURCES::acquire<blob>("resource_cache_cancel.bin") };
+		RESOURCES::wait(again);
+		check(again == handle && RESOURCES::get_state(again) == resource_state::resident && is_filled(RESOURCES::get_blob(again), 100, 'c'),
+			"cancelled blob can be acquired again");
+
+		RESOURCES::release(again);
+		RESOURCES::release(busy);
+		RESOURCES::set_budget(blob, 0, 0);
+	}
+
+	// A referenced resource whose file changed is loaded again and has the new content.
+	void test_reload_referenced() {
+		RESOURCES::set_budget(blob, 1024, 0);
+		const std::filesystem::path path{ write_file("resource_cache_reload.bin", 100, 'o') };
+		const blob_handle handle{ RESOURCES::acquire<blob>(path) };
+		RESOURCES::wait(handle);
+		check(is_filled(RESOURCES::get_blob(handle), 100, 'o'), "blob has the old content");
+
+		write_file("resource_cache_reload.bin", 200, 'n');
+		RESOURCES::reload(path);
+		check(RESOURCES::get_state(handle) == resource_state::loading, "referenced blob is loading after reload");
+		RESOURCES::wait(handle);
+		check(RESOURCES::get_state(handle) == resource_state::resident && is_filled(RESOURCES::get_blob(handle), 200, 'n'),
+			"reloaded blob has the new content");
+
+		RESOURCES::release(handle);
+		RESOURCES::set_budget(blob, 0, 0);
+	}
+
+	std::filesystem::path write_file(const std::string& name, u64 size, char value) {
+		const std::filesystem::path path{ name };
+		std::ofstream file{ path, std::ios::out | std::ios::binary | std::ios::trunc };
+		const std::string data(size, value);
+		file.write(data.data(), data.size());
+		_files.emplace_back(path);
+		return path;
+	}
+
+	static bool is_filled(const RESOURCES::blob_view& view, u64 size, char value) {
+		if (view.size != size) return false;
+		for (u64 i{ 0 }; i < size; ++i) {
+			if (view.data[i] != (u8)value) return false;
+		}
+		return true;
+	}
+
+	void check(bool condition, const char* name) {
+		if (!condition) {
+			std::cout << "FAILED: " << name << "\n";
+			_is_passed = false;
+		}
+	}
+
+	static void on_evict(RESOURCES::resource_type, ID::id_type id) {
+		_evicted.emplace_back(id);
+	}
+
+	static inline std::vector<ID::id_type>	_evicted;
+	std::vector<std::filesystem::path>		_files;
+	bool									_is_passed{ true };
+};
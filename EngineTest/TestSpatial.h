@@ -0,0 +1,321 @@
+#pragma once
+
+#include "Test.h"
+#include "..\WaveEngine\Spatial\DynamicBVH.h"
+#include "..\WaveEngine\Spatial\HashGrid.h"
+#include "..\WaveEngine\Components\Entity.h"
+#include "..\WaveEngine\Components\Transform.h"
+#include "..\WaveEngine\Core\JobSystem.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+using namespace WAVEENGINE;
+
+// Runs the spatial structures through batches of random changes and compares every query with a brute force
+// search over the same objects, and reports PASSED or FAILED.
+class engineTest : public test {
+public:
+	bool initialize() override { return JOBS::initialize(); }
+
+	void run() override {
+		test_dynamic_bvh();
+		test_hash_grid(5000, 20.0f);
+		// fewer points than neighbours asked for.
+		test_hash_grid(20, 3.0f);
+
+		std::cout << (_is_passed ? "PASSED" : "FAILED") << "\n";
+#ifdef _WIN64
+		PostQuitMessage(_is_passed ? 0 : 1);
+#endif
+	}
+
+	void shutdown() override {
+		JOBS::shutdown();
+	}
+
+private:
+	using aabb = SPATIAL::aabb;
+
+	static constexpr u32 object_count{ 3000 };
+	static constexpr u32 batch_size{ 500 };
+	static constexpr f32 world_size{ 200.0f };
+	// results that are this close to the boundary of a query may be found or not, the tree uses vector math.
+	static constexpr f32 tolerance{ 1e-3f };
+
+	enum class found : u32 { no, yes, either };
+
+	f32 random(f32 min, f32 max) { return std::uniform_real_distribution<f32>{ min, max }(_rng); }
+
+	MATH::v3 random_point(f32 extent) { return { random(-extent, extent), random(-extent, extent), random(-extent, extent) }; }
+
+	aabb random_box(const MATH::v3& center, f32 max_size) {
+		const MATH::v3 half{ random(0.05f, max_size), random(0.05f, max_size), random(0.05f, max_size) };
+		return { { center.x - half.x, center.y - half.y, center.z - half.z }, { center.x + half.x, center.y + half.y, center.z + half.z } };
+	}
+
+	// Inserts, moves and removes boxes in batches, checks the structure of the tree after every batch and
+	// compares the queries with the fat bounds of all live proxies.
+	void test_dynamic_bvh() {
+		SPATIAL::dynamicBVH bvh{ 0.5f };
+		std::vector<u32> proxies(object_count, u32_invalid_id);
+		std::vector<aabb> boxes(object_count);
+
+		const auto add = [&](u32 i) {
+			boxes[i] = random_box(random_point(world_size * 0.5f), 4.0f);
+			proxies[i] = bvh.add(boxes[i], i);
+		};
+
+		for (u32 first{ 0 }; first < object_count; first += batch_size) {
+			for (u32 i{ first }; i < first + batch_size; ++i) add(i);
+			check_bvh(bvh, proxies, boxes, "insert");
+		}
+
+		for (u32 round{ 0 }; round < 4; ++round) {
+			// small moves mostly stay inside the fat bounds, large ones reinsert the proxy.
+			const f32 distance{ round % 2 ? 0.2f : 20.0f };
+			for (u32 first{ 0 }; first < object_count; first += batch_size) {
+				for (u32 i{ first }; i < first + batch_size; ++i) {
+					if (proxies[i] == u32_invalid_id) continue;
+					const MATH::v3 offset{ random_point(distance) };
+					aabb& box{ boxes[i] };
+					box = { { box.min.x + offset.x, box.min.y + offset.y, box.min.z + offset.z }, { box.max.x + offset.x, box.max.y + offset.y, box.max.z + offset.z } };
+					bvh.move(proxies[i], box);
+					check(SPATIAL::contains(bvh.fat_bounds(proxies[i]), box), "bvh move bounds");
+				}
+				check_bvh(bvh, proxies, boxes, "move");
+			}
+
+			// remove a random half, then add most of them back.
+			for (u32 first{ 0 }; first < object_count; first += batch_size) {
+				for (u32 i{ first }; i < first + batch_size; ++i) {
+					if (proxies[i] != u32_invalid_id && _rng() % 2) {
+						bvh.remove(proxies[i]);
+						proxies[i] = u32_invalid_id;
+					}
+				}
+				check_bvh(bvh, proxies, boxes, "remove");
+			}
+			for (u32 i{ 0 }; i < object_count; ++i) {
+				if (proxies[i] == u32_invalid_id && _rng() % 4) add(i);
+			}
+			check_bvh(bvh, proxies, boxes, "reinsert");
+		}
+
+		for (u32 i{ 0 }; i < object_count; ++i) {
+			if (proxies[i] != u32_invalid_id) bvh.remove(proxies[i]);
+		}
+		check(bvh.proxy_count() == 0 && bvh.height() == 0 && bvh.validate(), "bvh remove all");
+	}
+
+	void check_bvh(const SPATIAL::dynamicBVH& bvh, const std::vector<u32>& proxies, const std::vector<aabb>& boxes, const char* batch) {
+		std::vector<aabb> fat(proxies.size());
+		u32 live{ 0 };
+		for (u32 i{ 0 }; i < proxies.size(); ++i) {
+			if (proxies[i] == u32_invalid_id) continue;
+			fat[i] = bvh.fat_bounds(proxies[i]);
+			check(bvh.user_data(proxies[i]) == i && SPATIAL::contains(fat[i], boxes[i]), batch);
+			++live;
+		}
+		check(bvh.proxy_count() == live && bvh.validate(), batch);
+		// rotations keep the tree close to balanced, a height far above log2 of the proxy count means they don't work.
+		check(bvh.max_balance() <= 2 && bvh.height() <= 4 * (u32)std::ceil(std::log2((f32)live + 1)), batch);
+
+		for (u32 q{ 0 }; q < 50; ++q) {
+			const aabb box{ random_box(random_point(world_size * 0.5f), 15.0f) };
+			std::vector<found> expected(proxies.size(), found::no);
+			for (u32 i{ 0 }; i < proxies.size(); ++i) {
+				if (proxies[i] == u32_invalid_id) continue;
+				const f32 gap{ (std::max)({ fat[i].min.x - box.max.x, fat[i].min.y - box.max.y, fat[i].min.z - box.max.z,
+					box.min.x - fat[i].max.x, box.min.y - fat[i].max.y, box.min.z - fat[i].max.z }) };
+				expected[i] = classify(-gap);
+			}
+			std::vector<u32> result;
+			bvh.query_overlap(box, [&result](ID::id_type i) { result.emplace_back((u32)i); });
+			compare(result, expected, "bvh overlap");
+		}
+
+		for (u32 q{ 0 }; q < 50; ++q) {
+			const SPATIAL::ray r{ random_point(world_size * 0.5f), random_point(1.0f), random(10.0f, 200.0f) };
+			std::vector<found> expected(proxies.size(), found::no);
+			for (u32 i{ 0 }; i < proxies.size(); ++i) {
+				if (proxies[i] != u32_invalid_id) expected[i] = classify(ray_overlap(r, fat[i]));
+			}
+			std::vector<u32> result;
+			bvh.query_ray(r, [&result](ID::id_type i) { result.emplace_back((u32)i); });
+			compare(result, expected, "bvh ray");
+		}
+
+		for (u32 q{ 0 }; q < 20; ++q) {
+			// six planes that face a random point, they don't have to form a real view frustum for the query.
+			const MATH::v3 center{ random_point(world_size * 0.5f) };
+			SPATIAL::frustum f{};
+			for (auto& plane : f.planes) {
+				const MATH::v3 n{ normalize(random_point(1.0f)) };
+				plane = { n.x, n.y, n.z, -(n.x * center.x + n.y * center.y + n.z * center.z) + random(5.0f, 60.0f) };
+			}
+			std::vector<found> expected(proxies.size(), found::no);
+			for (u32 i{ 0 }; i < proxies.size(); ++i) {
+				if (proxies[i] != u32_invalid_id) expected[i] = classify(frustum_overlap(f, fat[i]));
+			}
+			std::vector<u32> result;
+			bvh.query_frustum(f, [&result](ID::id_type i) { result.emplace_back((u32)i); });
+			compare(result, expected, "bvh frustum");
+		}
+	}
+
+	// Builds a grid over random points, some of them exactly on cell corners, and compares radius queries as sets
+	// and k-nearest queries by distance. Half of the query centers are within a hair of a cell boundary.
+	void test_hash_grid(u32 count, f32 extent) {
+		constexpr f32 cell_size{ 1.0f };
+		std::vector<MATH::v3> points(count);
+		std::vector<GAME_ENTITY::entity_id> ids(count);
+		for (u32 i{ 0 }; i < count; ++i) {
+			points[i] = random_point(extent);
+			if (i % 10 == 0) points[i] = { std::round(points[i].x), std::round(points[i].y), std::round(points[i].z) };
+			TRANSFORM::init_info transform_info{};
+			memcpy(transform_info.position, &points[i], sizeof(MATH::v3));
+			GAME_ENTITY::entity_info entity_info{ &transform_info };
+			ids[i] = GAME_ENTITY::create(entity_info).get_id();
+		}
+		// the queries return entity ids, this finds the point of an id.
+		std::vector<u32> point_of_index;
+		for (u32 i{ 0 }; i < count; ++i) {
+			const u32 index{ (u32)ID::index(ids[i]) };
+			if (index >= point_of_index.size()) point_of_index.resize(index + 1, u32_invalid_id);
+			point_of_index[index] = i;
+		}
+
+		SPATIAL::hashGrid grid{ cell_size };
+		grid.build(ids.data(), count);
+		check(grid.size() == count, "grid size");
+
+		constexpr u32 query_count{ 400 };
+		std::vector<MATH::v3> centers(query_count);
+		for (u32 q{ 0 }; q < query_count; ++q) {
+			centers[q] = random_point(extent + 2.0f);
+			if (q % 2) {
+				const f32 offset{ q % 4 == 1 ? 1e-4f : -1e-4f };
+				centers[q] = { std::round(centers[q].x) + offset, std::round(centers[q].y) + offset, centers[q].z };
+			}
+		}
+
+		for (const f32 radius : { 0.5f, 1.0f, 2.7f }) {
+			std::vector<GAME_ENTITY::entity_id> results((u64)query_count * count);
+			std::vector<u32> result_counts(query_count);
+			grid.query_radius(centers.data(), query_count, radius, count, results.data(), result_counts.data());
+			for (u32 q{ 0 }; q < query_count; ++q) {
+				std::vector<found> expected(count, found::no);
+				for (u32 i{ 0 }; i < count; ++i) {
+					expected[i] = classify(radius * radius - distance_sq(points[i], centers[q]));
+				}
+				std::vector<u32> result;
+				for (u32 r{ 0 }; r < result_counts[q]; ++r) result.emplace_back(point_of_index[ID::index(results[(u64)q * count + r])]);
+				compare(result, expected, "grid radius");
+			}
+		}
+
+		for (const u32 k : { 1u, 8u, 50u }) {
+			const f32 max_radius{ 6.0f };
+			std::vector<GAME_ENTITY::entity_id> results((u64)query_count * k);
+			std::vector<u32> result_counts(query_count);
+			grid.query_nearest(centers.data(), query_count, k, max_radius, results.data(), result_counts.data());
+			for (u32 q{ 0 }; q < query_count; ++q) {
+				std::vector<f32> distances;
+				for (u32 i{ 0 }; i < count; ++i) {
+					const f32 d{ distance_sq(points[i], centers[q]) };
+					if (d <= max_radius * max_radius) distances.emplace_back(d);
+				}
+				std::sort(distances.begin(), distances.end());
+
+				// ties and points on the max radius can make the grid pick other points, but never other distances.
+				const u32 n{ result_counts[q] };
+				const u32 expected_count{ (std::min)(k, (u32)distances.size()) };
+				check(n == expected_count || (n + 1 == expected_count && distances[n] > max_radius * max_radius - tolerance), "grid nearest count");
+				std::vector<u32> result;
+				for (u32 r{ 0 }; r < (std::min)(n, expected_count); ++r) {
+					const u32 point{ point_of_index[ID::index(results[(u64)q * k + r])] };
+					result.emplace_back(point);
+					check(std::abs(distance_sq(points[point], centers[q]) - distances[r]) <= tolerance, "grid nearest distance");
+				}
+				std::sort(result.begin(), result.end());
+				check(std::adjacent_find(result.begin(), result.end()) == result.end(), "grid nearest duplicate");
+			}
+		}
+
+		for (const auto id : ids) GAME_ENTITY::remove(id);
+	}
+
+	static f32 distance_sq(const MATH::v3& a, const MATH::v3& b) {
+		const f32 dx{ a.x - b.x }, dy{ a.y - b.y }, dz{ a.z - b.z };
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	static found classify(f32 overlap) {
+		return overlap > tolerance ? found::yes : overlap < -tolerance ? found::no : found::either;
+	}
+
+	// how far the ray runs inside the box, negative if it misses it.
+	static f32 ray_overlap(const SPATIAL::ray& r, const aabb& box) {
+		const f32 origin[3]{ r.origin.x, r.origin.y, r.origin.z };
+		const f32 direction[3]{ r.direction.x, r.direction.y, r.direction.z };
+		const f32 min[3]{ box.min.x, box.min.y, box.min.z };
+		const f32 max[3]{ box.max.x, box.max.y, box.max.z };
+		f32 enter{ 0.0f }, exit{ r.max_distance };
+		for (u32 axis{ 0 }; axis < 3; ++axis) {
+			if (direction[axis] == 0.0f) {
+				if (origin[axis] < min[axis] || origin[axis] > max[axis]) return -1.0f;
+				continue;
+			}
+			const f32 t0{ (min[axis] - origin[axis]) / direction[axis] };
+			const f32 t1{ (max[axis] - origin[axis]) / direction[axis] };
+			enter = (std::max)(enter, (std::min)(t0, t1));
+			exit = (std::min)(exit, (std::max)(t0, t1));
+		}
+		return exit - enter;
+	}
+
+	// the smallest distance of the corner that is furthest along each plane's normal, negative if the box is outside.
+	static f32 frustum_overlap(const SPATIAL::frustum& f, const aabb& box) {
+		f32 result{ std::numeric_limits<f32>::max() };
+		for (const auto& plane : f.planes) {
+			const f32 x{ plane.x >= 0.0f ? box.max.x : box.min.x };
+			const f32 y{ plane.y >= 0.0f ? box.max.y : box.min.y };
+			const f32 z{ plane.z >= 0.0f ? box.max.z : box.min.z };
+			result = (std::min)(result, plane.x * x + plane.y * y + plane.z * z + plane.w);
+		}
+		return result;
+	}
+
+	static MATH::v3 normalize(const MATH::v3& v) {
+		const f32 length{ std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z) };
+		return length > 0.0f ? MATH::v3{ v.x / length, v.y / length, v.z / length } : MATH::v3{ 0.0f, 0.0f, 1.0f };
+	}
+
+	// every object is found at most once, and exactly the objects that have to be found are.
+	void compare(std::vector<u32>& result, const std::vector<found>& expected, const char* query) {
+		std::sort(result.begin(), result.end());
+		check(std::adjacent_find(result.begin(), result.end()) == result.end(), query);
+		u32 next{ 0 };
+		for (u32 i{ 0 }; i < expected.size(); ++i) {
+			const bool is_found{ next < result.size() && result[next] == i };
+			if (is_found) ++next;
+			if (expected[i] != found::either) check(is_found == (expected[i] == found::yes), query);
+		}
+		check(next == result.size(), query);
+	}
+
+	void check(bool condition, const char* name) {
+		if (!condition) {
+			if (++_failures <= 10) std::cout << "FAILED: " << name << "\n";
+			_is_passed = false;
+		}
+	}
+
+	std::mt19937	_rng{ 17 };
+	u32				_failures{ 0 };
+	bool			_is_passed{ true };
+};
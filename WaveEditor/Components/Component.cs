@@ -20,7 +20,6 @@ namespace WaveEditor.Components {
         public GameEntity Owner { get; private set; }
 
         public abstract IMSComponent GetMultiselectionComponent(MSEntity msEntity);
-        public abstract void WriteToBinary(BinaryWriter bw);
 
         public Component(GameEntity owner) {
             Debug.Assert(owner != null);
@@ -50,6 +50,10 @@ namespace WaveEditor.Components {
             }
         }
 
+        // identifies the entity in game.bin, so the engine can hot reload only the entities that changed.
+        [DataMember]
+        public Guid Guid { get; private set; } = Guid.NewGuid();
+
         private bool _isEnabled = true;
         [DataMember]
         public bool IsEnabled {
@@ -113,6 +117,9 @@ namespace WaveEditor.Components {
 
         [OnDeserialized]
         void OnDeserialized(StreamingContext context) {
+            // entities saved before they had an id get one now.
+            if (Guid == Guid.Empty) Guid = Guid.NewGuid();
+
             if(_components != null) {
                 Components = new ReadOnlyObservableCollection<Component>(_components);
                 OnPropertyChanged(nameof(Components));
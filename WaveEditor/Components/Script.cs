@@ -25,12 +25,6 @@ namespace WaveEditor.Components {
 
         public override IMSComponent GetMultiselectionComponent(MSEntity msEntity) => new MSScript(msEntity);
 
-        public override void WriteToBinary(BinaryWriter bw) {
-            var nameBytes = Encoding.UTF8.GetBytes(Name);
-            bw.Write(nameBytes.Length);
-            bw.Write(nameBytes);
-        }
-
         public Script(GameEntity owner) : base(owner) { 
 
         }
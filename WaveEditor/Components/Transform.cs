@@ -52,12 +52,6 @@ namespace WaveEditor.Components {
         }
 
         public override IMSComponent GetMultiselectionComponent(MSEntity msEntity) => new MSTransform(msEntity);
-
-        public override void WriteToBinary(BinaryWriter bw) {
-            bw.Write(_position.X); bw.Write(_position.Y); bw.Write(_position.Z);
-            bw.Write(_rotation.X); bw.Write(_rotation.Y); bw.Write(_rotation.Z);
-            bw.Write(_scale.X); bw.Write(_scale.Y); bw.Write(_scale.Z);
-        }
     }
 
     sealed class MSTransform : MSComponent<Transform> {
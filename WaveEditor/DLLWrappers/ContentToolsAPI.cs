@@ -59,6 +59,12 @@ namespace WaveEditor.ContentToolsAPIStructs {
         public Vector3 Size = new Vector3(1f);
         public int LOD = 0;
     };
+
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    struct PackageFile {
+        public string Name;
+        public string Path;
+    }
 }
 
 namespace WaveEditor.DLLWrappers {
@@ -96,5 +102,15 @@ namespace WaveEditor.DLLWrappers {
             GeometryFromSceneData(geometry, (sceneData) => ImportFbx(file, sceneData), $"Failed to import from FBX file: {file}");
         }
 
+        [DllImport(_toolsDLL)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool WritePackage(string output, PackageFile[] files, int count);
+
+        // files: the name the engine looks each file up with, and its path on disk.
+        public static bool WritePackage(string output, IEnumerable<(string name, string path)> files) {
+            var packageFiles = files.Select(x => new PackageFile() { Name = x.name, Path = x.path }).ToArray();
+            return WritePackage(output, packageFiles, packageFiles.Length);
+        }
+
     }
 }
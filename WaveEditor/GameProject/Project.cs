@@ -190,31 +190,146 @@ namespace WaveEditor.GameProject {
         }
 
         /*
-         * [game.bin format]
-         * Game Entities Count
-         * Game Entity Type
-         * Game Entity Components Count
-         * Component Type
-         * Component Information
-         * Component Type
-         * Component Information
-         * ...
-         * ...
+         * [game.bin v2 format], see Content\GameFormat.h in the engine
+         * header: magic, version, section count, flags, reserved, section table hash, file size
+         * section table: id, crc, offset, size, element count, element stride
+         * sections, each starting at a 16 byte aligned offset:
+         *   entities: component mask per entity
+         *   transform positions, rotations, scales: 3 floats per entity
+         *   script names: string index per script
+         *   strings: offset per string, then zero terminated UTF-8 strings
+         *   entity ids: 64 bit id per entity, which stays the same when the level is exported again
          */
 
+        private const uint GameFileMagic = 'W' | ('G' << 8) | ('A' << 16) | ('M' << 24);
+        private const ushort GameFileVersion = 2;
+        private const int GameFileHeaderSize = 32;
+        private const int GameSectionEntrySize = 32;
+        private const int GameSectionAlignment = 16;
+
+        private enum GameSection : uint {
+            Entities,
+            TransformPositions,
+            TransformRotations,
+            TransformScales,
+            ScriptNames,
+            Strings,
+            EntityIds,
+        }
+
+        private class GameSectionData {
+            public GameSection Id { get; set; }
+            public byte[] Data { get; set; }
+            public int Count { get; set; }
+            public int Stride { get; set; }
+        }
+
+        private static byte[] WriteSection(Action<BinaryWriter> write) {
+            using (var ms = new MemoryStream())
+            using (var bw = new BinaryWriter(ms)) {
+                write(bw);
+                bw.Flush();
+                return ms.ToArray();
+            }
+        }
+
+        private static void WriteVector(BinaryWriter bw, System.Numerics.Vector3 v) {
+            bw.Write(v.X);
+            bw.Write(v.Y);
+            bw.Write(v.Z);
+        }
+
         private void SaveToBinary() {
             var configName = VisualStudio.GetConfigurationName(StandAloneBuildConfig);
             var bin = $@"{Path}x64\{configName}\game.bin";
 
-            using (var bw = new BinaryWriter(File.Open(bin, FileMode.Create, FileAccess.Write))) {
-                bw.Write(ActiveScene.GameEntities.Count); 
-                foreach(var entity in ActiveScene.GameEntities) {
-                    bw.Write(0); // entity type
-                    bw.Write(entity.Components.Count);
-                    foreach(var component in entity.Components) {
-                        bw.Write((int)component.ToEnumType());
-                        component.WriteToBinary(bw);
-                    }
+            var entities = ActiveScene.GameEntities;
+            var transforms = entities.Select(x => x.GetComponent<Transform>()).ToList();
+            Debug.Assert(transforms.All(x => x != null)); // every entity has a transform
+            var scripts = entities.Select(x => x.GetComponent<Script>()).Where(x => x != null).ToList();
+
+            // each script name is written once, so the engine only looks it up once.
+            var strings = scripts.Select(x => x.Name).Distinct().ToList();
+            var stringIndex = strings.Select((name, i) => (name, i)).ToDictionary(x => x.name, x => x.i);
+
+            var sections = new List<GameSectionData>() {
+                new GameSectionData() { Id = GameSection.Entities, Count = entities.Count, Stride = sizeof(uint),
+                    Data = WriteSection(bw => entities.ToList().ForEach(x => bw.Write(x.Components.Aggregate(0u, (mask, c) => mask | (1u << (int)c.ToEnumType()))))) },
+                new GameSectionData() { Id = GameSection.TransformPositions, Count = transforms.Count, Stride = 3 * sizeof(float),
+                    Data = WriteSection(bw => transforms.ForEach(x => WriteVector(bw, x.Position))) },
+                new GameSectionData() { Id = GameSection.TransformRotations, Count = transforms.Count, Stride = 3 * sizeof(float),
+                    Data = WriteSection(bw => transforms.ForEach(x => WriteVector(bw, x.Rotation))) },
+                new GameSectionData() { Id = GameSection.TransformScales, Count = transforms.Count, Stride = 3 * sizeof(float),
+                    Data = WriteSection(bw => transforms.ForEach(x => WriteVector(bw, x.Scale))) },
+                new GameSectionData() { Id = GameSection.ScriptNames, Count = scripts.Count, Stride = sizeof(uint),
+                    Data = WriteSection(bw => scripts.ForEach(x => bw.Write(stringIndex[x.Name]))) },
+                new GameSectionData() { Id = GameSection.Strings, Count = strings.Count, Stride = 0,
+                    Data = WriteSection(bw => {
+                        var names = strings.Select(x => Encoding.UTF8.GetBytes(x)).ToList();
+                        var offset = names.Count * sizeof(uint);
+                        foreach (var name in names) {
+                            bw.Write(offset);
+                            offset += name.Length + 1;
+                        }
+                        foreach (var name in names) {
+                            bw.Write(name);
+                            bw.Write((byte)0);
+                        }
+                    }) },
+                new GameSectionData() { Id = GameSection.EntityIds, Count = entities.Count, Stride = sizeof(ulong),
+                    Data = WriteSection(bw => entities.ToList().ForEach(x => bw.Write(Hash.Fnv1a64(x.Guid.ToByteArray())))) },
+            };
+
+            long Align(long offset) => (offset + GameSectionAlignment - 1) & ~(long)(GameSectionAlignment - 1);
+
+            var offsets = new List<long>();
+            var fileSize = (long)GameFileHeaderSize + sections.Count * GameSectionEntrySize;
+            foreach (var section in sections) {
+                fileSize = Align(fileSize);
+                offsets.Add(fileSize);
+                fileSize += section.Data.Length;
+            }
+
+            var table = WriteSection(bw => {
+                for (int i = 0; i < sections.Count; ++i) {
+                    bw.Write((uint)sections[i].Id);
+                    bw.Write(Hash.Crc32(sections[i].Data));
+                    bw.Write((ulong)offsets[i]);
+                    bw.Write((ulong)sections[i].Data.Length);
+                    bw.Write(sections[i].Count);
+                    bw.Write(sections[i].Stride);
+                }
+            });
+
+            // the running game reloads game.bin when it changes, so it must never see a half written file.
+            var tempBin = bin + ".tmp";
+            using (var bw = new BinaryWriter(File.Open(tempBin, FileMode.Create, FileAccess.Write))) {
+                bw.Write(GameFileMagic);
+                bw.Write(GameFileVersion);
+                bw.Write((ushort)sections.Count);
+                bw.Write(0u); // flags
+                bw.Write(0u); // reserved
+                bw.Write(Hash.Fnv1a64(table));
+                bw.Write((ulong)fileSize);
+                bw.Write(table);
+                for (int i = 0; i < sections.Count; ++i) {
+                    while (bw.BaseStream.Position < offsets[i]) bw.Write((byte)0);
+                    bw.Write(sections[i].Data);
+                }
+                Debug.Assert(bw.BaseStream.Position == fileSize);
+            }
+            File.Move(tempBin, bin, true);
+
+            // the engine reads game.bin from game.wpak when it exists, so both are written together.
+            // NOTE: a package that couldn't be updated is deleted, otherwise the game would load the old game.bin from it.
+            var package = $@"{Path}x64\{configName}\game.wpak";
+            if (!ContentToolsAPI.WritePackage(package, new[] { ("game.bin", bin) })) {
+                Logger.Log(MessageType.Error, $"Failed to write {package}, the game loads {bin} instead");
+                try {
+                    File.Delete(package);
+                } catch (Exception ex) {
+                    Debug.WriteLine(ex.Message);
+                    Logger.Log(MessageType.Error, $"Failed to delete stale {package}");
                 }
             }
         }
@@ -25,6 +25,38 @@ namespace WaveEditor.Utilities {
         }
     }
 
+    // the same hashes as Utilities\Hash.h in the engine, used to write checksums into game.bin.
+    public static class Hash {
+        private static readonly uint[] _crc32Table = CreateCrc32Table();
+
+        private static uint[] CreateCrc32Table() {
+            var table = new uint[256];
+            for (uint i = 0; i < 256; ++i) {
+                var crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        public static uint Crc32(byte[] data, uint crc = 0) {
+            crc = ~crc;
+            foreach (var b in data) {
+                crc = (crc >> 8) ^ _crc32Table[(crc ^ b) & 0xff];
+            }
+            return ~crc;
+        }
+
+        public static ulong Fnv1a64(byte[] data, ulong hash = 0xcbf29ce484222325ul) {
+            foreach (var b in data) {
+                hash = (hash ^ b) * 0x00000100000001b3ul;
+            }
+            return hash;
+        }
+    }
+
     class DelayEventTimerArgs : EventArgs {
         public bool RepeatEvent { get; set; }
         public IEnumerable<object> Data { get; set; }
@@ -6,12 +6,28 @@ namespace WAVEENGINE::ID {
 
 // refs: https://bitsquid.blogspot.com/2014/08/building-data-oriented-entity-system.html
 
+// NOTE: set USE_64BIT_ID to 1 for 64 bit ids (32 bit index + 32 bit generation).
+//		 32 bit ids (24 bit index + 8 bit generation) limit the number of objects to 16M and
+//		 retire a slot after it has been reused 254 times, which long running sessions may hit.
+//		 The editor marshals ids as 32 bit integers, so it only works with 32 bit ids.
+#ifndef USE_64BIT_ID
+#define USE_64BIT_ID 0
+#endif
+
+#if USE_64BIT_ID
+using id_type = u64;
+#else
 using id_type = u32; 
+#endif
 
 namespace DETAIL {
 	
+#if USE_64BIT_ID
+constexpr u32 generation_bits{ 32 };
+#else
 constexpr u32 generation_bits{ 8 };
-constexpr u32 index_bits{ sizeof(id_type) * 8 - generation_bits }; // 24
+#endif
+constexpr u32 index_bits{ sizeof(id_type) * 8 - generation_bits }; // 24 (32 with 64 bit ids)
 constexpr id_type generation_mask{ (id_type{1} << generation_bits) - 1 }; //0x000000FF
 constexpr id_type index_mask{ (id_type{1} << index_bits) - 1 }; // 0x00FFFFFF
 
@@ -40,9 +56,17 @@ constexpr id_type generation(id_type id) {
 	return (id >> DETAIL::index_bits) & DETAIL::generation_mask;
 }
 
+// the highest generation a slot can reach. Going beyond it would make the id equal to invalid_id
+// (or wrap around to 0 and alias stale ids), so slots with this generation are retired instead of being reused.
+constexpr id_type max_generation{ DETAIL::generation_mask - 1 };
+
+constexpr bool is_generation_exhausted(id_type id) {
+	return generation(id) >= max_generation;
+}
+
 constexpr id_type new_generation(id_type id) {
 	const id_type generation{ ID::generation(id) + 1 };
-	assert(generation < (((u64)1 << DETAIL::generation_bits) - 1)); // make sure generation < 255
+	assert(generation <= max_generation); // make sure generation < 255, retire the slot otherwise
 	return index(id) | (generation << DETAIL::index_bits);
 }
 
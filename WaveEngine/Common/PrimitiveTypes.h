@@ -19,4 +19,5 @@ constexpr u16 u16_invalid_id{ 0xffffui64 };
 constexpr u32 u32_invalid_id{ 0xffff'ffffui64 };
 constexpr u64 u64_invalid_id{ 0xffff'ffff'ffff'ffffui64 };
 
-using f32 = float;
\ No newline at end of file
+using f32 = float;
+using f64 = double;
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "Entity.h"
 #include "Transform.h"
 #include "Script.h"
+#include "EntityQuery.h"
+#include "..\Utilities\IOStream.h"
 #include <iostream>
 
 namespace WAVEENGINE::GAME_ENTITY {
@@ -13,13 +15,74 @@ UTL::vector<SCRIPT::component> scripts;
 UTL::vector<ID::generation_type> generations; // record generations for each entity
 UTL::deque<entity_id> free_ids; // index free to be used
 
-}
+// Packed list of the entities that own a given component type, used by queries.
+// 'slots' maps an entity index to the entity's position in 'owners' (u32_invalid_id if not owned).
+struct component_owners {
+	UTL::vector<entity_id>	owners;
+	UTL::vector<u32>		slots;
 
-entity create(const entity_info& info) {
-	assert(info.transform);
-	if (!info.transform)
-		return entity{}; // default with invalid_id
+	void add(entity_id id) {
+		const ID::id_type index{ ID::index(id) };
+		assert(index < slots.size() && slots[index] == u32_invalid_id);
+		slots[index] = (u32)owners.size();
+		owners.emplace_back(id);
+	}
+
+	void remove(entity_id id) {
+		const ID::id_type index{ ID::index(id) };
+		assert(index < slots.size() && slots[index] < owners.size());
+		const u32 slot{ slots[index] };
+		const entity_id last{ owners.back() };
+		UTL::erase_unordered(owners, slot);
+		// NOTE: order matters here, if 'id' was the last owner its slot must end up invalid.
+		slots[ID::index(last)] = slot;
+		slots[index] = u32_invalid_id;
+	}
+
+	DETAIL::owner_set get() const {
+		return DETAIL::owner_set{ owners.data(), slots.data(), (u32)owners.size() };
+	}
+
+	u64 snapshot_size() const {
+		return sizeof(u32) + owners.size() * sizeof(entity_id) + slots.size() * sizeof(u32);
+	}
 
+	void save_snapshot(UTL::blobStreamWriter& writer) const {
+		writer.write<u32>((u32)owners.size());
+		writer.write((const u8*)owners.data(), owners.size() * sizeof(entity_id));
+		writer.write((const u8*)slots.data(), slots.size() * sizeof(u32));
+	}
+
+	// NOTE: 'slots' always has one element per entity slot, so its size is not stored.
+	void restore_snapshot(UTL::blobStreamReader& reader, u32 slot_count) {
+		owners.resize(reader.read<u32>());
+		slots.resize(slot_count);
+		reader.read((u8*)owners.data(), owners.size() * sizeof(entity_id));
+		reader.read((u8*)slots.data(), slots.size() * sizeof(u32));
+	}
+
+	static bool validate_snapshot(UTL::blobStreamReader& reader, u64 size, u32 slot_count) {
+		if (!reader.can_read(sizeof(u32), size)) return false;
+		const u32 owner_count{ reader.read<u32>() };
+		const u64 length{ (u64)owner_count * sizeof(entity_id) + (u64)slot_count * sizeof(u32) };
+		if (owner_count > slot_count || !reader.can_read(length, size)) return false;
+		reader.skip(length);
+		return true;
+	}
+};
+
+component_owners transform_owners;
+component_owners script_owners;
+
+struct prefab {
+	TRANSFORM::init_info	transform;
+	SCRIPT::init_info		script; // script_creator is nullptr if the prefab has no script
+};
+
+UTL::freeList<prefab> prefabs;
+
+// returns a recycled id or the next unused index, invalid_id when we're out of indices.
+entity_id acquire_id() {
 	entity_id id;
 
 	if (free_ids.size() > ID::min_deleted_elements) { // reuse id when the number of free ids reach to 1024
@@ -29,6 +92,10 @@ entity create(const entity_info& info) {
 		id = entity_id{ ID::new_generation(id) }; 
 		++generations[ID::index(id)];
 	} else {
+		assert(generations.size() < ID::DETAIL::index_mask);
+		if (generations.size() >= ID::DETAIL::index_mask)
+			return entity_id{ ID::invalid_id };
+
 		id = entity_id{ (ID::id_type)generations.size() }; // next available index
 		generations.push_back(0);
 
@@ -36,8 +103,40 @@ entity create(const entity_info& info) {
 		//// NOTE: we don't call resize(), so the number of memory allocation stays low
 		transforms.emplace_back();
 		scripts.emplace_back();
+		transform_owners.slots.emplace_back(u32_invalid_id);
+		script_owners.slots.emplace_back(u32_invalid_id);
 	}
 
+	return id;
+}
+
+// makes room for 'count' more entities, so that bulk creation doesn't reallocate for every entity.
+void reserve(u64 count) {
+	MEMORY_TAG(entity);
+	const u64 recycled{ free_ids.size() > ID::min_deleted_elements ? free_ids.size() - ID::min_deleted_elements : 0 };
+	if (count <= recycled) return;
+
+	const u64 capacity{ generations.size() + count - recycled };
+	generations.reserve(capacity);
+	transforms.reserve(capacity);
+	scripts.reserve(capacity);
+	transform_owners.slots.reserve(capacity);
+	script_owners.slots.reserve(capacity);
+	transform_owners.owners.reserve(transform_owners.owners.size() + count);
+}
+
+}
+
+entity create(const entity_info& info) {
+	MEMORY_TAG(entity);
+	assert(info.transform);
+	if (!info.transform)
+		return entity{}; // default with invalid_id
+
+	const entity_id id{ acquire_id() };
+	if (!ID::is_valid(id))
+		return entity{}; // out of indices
+
 	const entity new_entity{ id };
 	const ID::id_type index{ ID::index(id) };
 
@@ -46,12 +145,14 @@ entity create(const entity_info& info) {
 	transforms[index] = TRANSFORM::create(*info.transform, new_entity);
 	if (!transforms[index].is_valid())
 		return {}; // default with invalid_id
+	transform_owners.add(id);
 
 	// Create script component
 	if (info.script && info.script-> script_creator) {
 		assert(!scripts[index].is_valid());
 		scripts[index] = SCRIPT::create(*info.script, new_entity);
 		assert(scripts[index].is_valid());
+		script_owners.add(id);
 	}
 
 	return new_entity;
@@ -64,12 +165,177 @@ void remove(entity_id id) {
 	if (scripts[index].is_valid()) {
 		SCRIPT::remove(scripts[index]);
 		scripts[index] = {};
+		script_owners.remove(id);
 	}
 
 	TRANSFORM::remove(transforms[index]);
 	transforms[index] = {};
+	transform_owners.remove(id);
 
-	free_ids.push_back(id);
+	// NOTE: a slot that used up all its generations is retired and never handed out again.
+	if (!ID::is_generation_exhausted(id)) {
+		free_ids.push_back(id);
+	}
+}
+
+prefab_id create_prefab(const entity_info& info) {
+	MEMORY_TAG(entity);
+	assert(info.transform);
+	if (!info.transform)
+		return prefab_id{ ID::invalid_id };
+
+	prefab data{};
+	data.transform = *info.transform;
+	if (info.script) {
+		data.script = *info.script;
+	}
+	return prefab_id{ prefabs.add(data) };
+}
+
+void remove_prefab(prefab_id id) {
+	assert(ID::is_valid(id));
+	prefabs.remove((u32)id);
+}
+
+u32 instantiate(prefab_id id, u32 count, entity* const entities, const MATH::v3* const positions) {
+	MEMORY_TAG(entity);
+	assert(ID::is_valid(id) && entities);
+	// NOTE: copy the prefab, scripts that are constructed below could add more prefabs and move the storage.
+	const prefab data{ prefabs[(u32)id] };
+
+	reserve(count);
+
+	u32 created{ 0 };
+	for (; created < count; ++created) {
+		const entity_id new_id{ acquire_id() };
+		if (!ID::is_valid(new_id)) break; // out of indices
+		entities[created] = entity{ new_id };
+	}
+
+	TRANSFORM::create(data.transform, entities, created, positions);
+	for (u32 i{ 0 }; i < created; ++i) {
+		const entity_id new_id{ entities[i].get_id() };
+		transforms[ID::index(new_id)] = TRANSFORM::component{ TRANSFORM::transform_id{ new_id } };
+		transform_owners.add(new_id);
+	}
+
+	if (data.script.script_creator) {
+		script_owners.owners.reserve(script_owners.owners.size() + created);
+		SCRIPT::create(data.script, entities, created, scripts.data());
+		for (u32 i{ 0 }; i < created; ++i) {
+			const entity_id new_id{ entities[i].get_id() };
+			assert(scripts[ID::index(new_id)].is_valid());
+			script_owners.add(new_id);
+		}
+	}
+
+	return created;
+}
+
+u32 create(const batch_info& info, entity* const entities) {
+	MEMORY_TAG(entity);
+	assert(entities && ((info.positions && info.rotations && info.scales) || !info.count));
+
+	reserve(info.count);
+
+	u32 created{ 0 };
+	for (; created < info.count; ++created) {
+		const entity_id new_id{ acquire_id() };
+		if (!ID::is_valid(new_id)) break; // out of indices
+		entities[created] = entity{ new_id };
+	}
+
+	TRANSFORM::create(entities, created, info.positions, info.rotations, info.scales);
+	for (u32 i{ 0 }; i < created; ++i) {
+		const entity_id new_id{ entities[i].get_id() };
+		transforms[ID::index(new_id)] = TRANSFORM::component{ TRANSFORM::transform_id{ new_id } };
+		transform_owners.add(new_id);
+	}
+
+	if (info.scripts) {
+		for (u32 i{ 0 }; i < created; ++i) {
+			if (!info.scripts[i]) continue;
+			const entity_id new_id{ entities[i].get_id() };
+			const ID::id_type index{ ID::index(new_id) };
+			assert(!scripts[index].is_valid());
+			scripts[index] = SCRIPT::create(SCRIPT::init_info{ info.scripts[i] }, entities[i]);
+			assert(scripts[index].is_valid());
+			script_owners.add(new_id);
+		}
+	}
+
+	return created;
+}
+
+/*
+ * [Snapshot format]
+ * slot count
+ * generations[slot count]
+ * transform components[slot count]
+ * script components[slot count]
+ * free id count
+ * free ids[free id count]
+ * transform owners (count, owners[count], slots[slot count])
+ * script owners (count, owners[count], slots[slot count])
+ */
+
+u64 snapshot_size() {
+	const u64 slot_count{ generations.size() };
+	return sizeof(u32) +
+		slot_count * (sizeof(ID::generation_type) + sizeof(TRANSFORM::component) + sizeof(SCRIPT::component)) +
+		sizeof(u32) + free_ids.size() * sizeof(entity_id) +
+		transform_owners.snapshot_size() + script_owners.snapshot_size();
+}
+
+void save_snapshot(UTL::blobStreamWriter& writer) {
+	const u32 slot_count{ (u32)generations.size() };
+	writer.write<u32>(slot_count);
+	writer.write((const u8*)generations.data(), slot_count * sizeof(ID::generation_type));
+	writer.write((const u8*)transforms.data(), slot_count * sizeof(TRANSFORM::component));
+	writer.write((const u8*)scripts.data(), slot_count * sizeof(SCRIPT::component));
+
+	writer.write<u32>((u32)free_ids.size());
+	for (const entity_id id : free_ids) {
+		writer.write<ID::id_type>(id);
+	}
+
+	transform_owners.save_snapshot(writer);
+	script_owners.save_snapshot(writer);
+}
+
+void restore_snapshot(UTL::blobStreamReader& reader) {
+	const u32 slot_count{ reader.read<u32>() };
+	generations.resize(slot_count);
+	transforms.resize(slot_count);
+	scripts.resize(slot_count);
+	reader.read((u8*)generations.data(), slot_count * sizeof(ID::generation_type));
+	reader.read((u8*)transforms.data(), slot_count * sizeof(TRANSFORM::component));
+	reader.read((u8*)scripts.data(), slot_count * sizeof(SCRIPT::component));
+
+	free_ids.clear();
+	const u32 free_count{ reader.read<u32>() };
+	for (u32 i{ 0 }; i < free_count; ++i) {
+		free_ids.push_back(entity_id{ reader.read<ID::id_type>() });
+	}
+
+	transform_owners.restore_snapshot(reader, slot_count);
+	script_owners.restore_snapshot(reader, slot_count);
+}
+
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size) {
+	if (!reader.can_read(sizeof(u32), size)) return false;
+	const u32 slot_count{ reader.read<u32>() };
+	const u64 slots_length{ (u64)slot_count * (sizeof(ID::generation_type) + sizeof(TRANSFORM::component) + sizeof(SCRIPT::component)) };
+	if (!reader.can_read(slots_length + sizeof(u32), size)) return false;
+	reader.skip(slots_length);
+
+	const u32 free_count{ reader.read<u32>() };
+	const u64 free_length{ (u64)free_count * sizeof(ID::id_type) };
+	if (free_count > slot_count || !reader.can_read(free_length, size)) return false;
+	reader.skip(free_length);
+
+	return component_owners::validate_snapshot(reader, size, slot_count) &&
+		component_owners::validate_snapshot(reader, size, slot_count);
 }
 
 bool is_alive(const entity_id id) {
@@ -94,4 +360,24 @@ SCRIPT::component entity::script() const {
 	return scripts[index];
 }
 
+namespace DETAIL {
+
+owner_set storage<TRANSFORM::component>::owners() {
+	return transform_owners.get();
+}
+
+const TRANSFORM::component* storage<TRANSFORM::component>::components() {
+	return transforms.data();
+}
+
+owner_set storage<SCRIPT::component>::owners() {
+	return script_owners.get();
+}
+
+const SCRIPT::component* storage<SCRIPT::component>::components() {
+	return scripts.data();
+}
+
+} // namespace DETAIL
+
 }
\ No newline at end of file
@@ -11,6 +11,11 @@ INIT_INFO(SCRIPT);
 
 #undef INIT_INFO
 
+namespace UTL {
+class blobStreamReader;
+class blobStreamWriter;
+}
+
 namespace GAME_ENTITY {
 
 struct entity_info {
@@ -18,11 +23,44 @@ struct entity_info {
 	SCRIPT::init_info *script{ nullptr };
 };
 	
+DEFINE_TYPED_ID(prefab_id);
+
 entity create(const entity_info& info);
 
 void remove(entity_id e);
 
+// Prefabs store a pre-resolved entity_info, so the same composite entity can be created many times
+// with a single call. Prefabs must be removed before shutdown.
+prefab_id create_prefab(const entity_info& info);
+void remove_prefab(prefab_id id);
+
+// Creates 'count' entities from the prefab and writes them into 'entities'.
+// 'positions' is optional and overrides the prefab's position per entity.
+// Returns the number of entities that were created, which is less than 'count' only if we run out of ids.
+u32 instantiate(prefab_id id, u32 count, entity* const entities, const MATH::v3* const positions = nullptr);
+
+// The components of entities that are created together, one element per entity in every array.
+// 'scripts' is optional, entities without a script have a nullptr creator.
+struct batch_info {
+	const MATH::v3*								positions{ nullptr };
+	const MATH::v4*								rotations{ nullptr }; // Quaternions
+	const MATH::v3*								scales{ nullptr };
+	const SCRIPT::DETAIL::script_creator*		scripts{ nullptr };
+	u32											count{ 0 };
+};
+
+// Creates the entities of a batch, writing the components straight into their storage, and writes them into 'entities'.
+// Returns the number of entities that were created, which is less than 'count' only if we run out of ids.
+u32 create(const batch_info& info, entity* const entities);
+
 bool is_alive(entity_id e);
 
+// entity slots, generations and free ids of the world, see CONTENT::save_world_snapshot().
+u64 snapshot_size();
+void save_snapshot(UTL::blobStreamWriter& writer);
+void restore_snapshot(UTL::blobStreamReader& reader);
+// walks the snapshot section without touching the world, false if it doesn't fit in 'size' bytes.
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size);
+
 } // namespace GAME_ENTITY
 } // namespace WAVEENGINE
\ No newline at end of file
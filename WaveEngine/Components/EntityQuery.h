@@ -0,0 +1,101 @@
+#pragma once
+#include "ComponentsCommon.h"
+#include "..\Core\JobSystem.h"
+#include <tuple>
+#include <utility>
+
+namespace WAVEENGINE::GAME_ENTITY {
+
+namespace DETAIL {
+
+// packed list of the entities that own one component type
+struct owner_set {
+	const entity_id*	owners;
+	const u32*			slots;	// entity index -> position in 'owners', u32_invalid_id if not owned
+	u32					count;
+};
+
+// Resolves the storage of a component type at compile time.
+// components() is indexed by entity index, like the component arrays in Entity.cpp.
+template<typename component> struct storage;
+
+template<> struct storage<TRANSFORM::component> {
+	static owner_set owners();
+	static const TRANSFORM::component* components();
+};
+
+template<> struct storage<SCRIPT::component> {
+	static owner_set owners();
+	static const SCRIPT::component* components();
+};
+
+template<u32 count>
+constexpr u32 smallest_set(const owner_set(&sets)[count]) {
+	u32 smallest{ 0 };
+	for (u32 i{ 1 }; i < count; ++i) {
+		if (sets[i].count < sets[smallest].count) smallest = i;
+	}
+	return smallest;
+}
+
+template<u32 count>
+constexpr bool owned_by_all(const owner_set(&sets)[count], ID::id_type index) {
+	for (u32 i{ 0 }; i < count; ++i) {
+		if (sets[i].slots[index] == u32_invalid_id) return false;
+	}
+	return true;
+}
+
+// Iterates the entities that own all the queried components, driven by the smallest owner set.
+// When only one component is queried the loop doesn't branch at all.
+// NOTE: the component arrays are looked up by position, so a query may name the same component type twice.
+template<typename... components, typename function, size_t... positions>
+void for_each_in_range(const owner_set(&sets)[sizeof...(components)], u32 lead, u32 begin, u32 end, function& func, std::index_sequence<positions...>) {
+	const std::tuple<const components*...> arrays{ storage<components>::components()... };
+	const entity_id* const owners{ sets[lead].owners };
+
+	for (u32 i{ begin }; i < end; ++i) {
+		const entity_id id{ owners[i] };
+		const ID::id_type index{ ID::index(id) };
+		if constexpr (sizeof...(components) > 1) {
+			if (!owned_by_all(sets, index)) continue;
+		}
+		func(entity{ id }, std::get<positions>(arrays)[index]...);
+	}
+}
+
+} // namespace DETAIL
+
+// Calls func(entity, components...) for every entity that owns all of the given component types, e.g.
+//		for_each<TRANSFORM::component, SCRIPT::component>([](entity e, TRANSFORM::component t, SCRIPT::component s) {...});
+// NOTE: entities must not be created or removed while iterating.
+template<typename... components, typename function>
+void for_each(function&& func) {
+	static_assert(sizeof...(components) > 0, "Query at least one component type.");
+	const DETAIL::owner_set sets[]{ DETAIL::storage<components>::owners()... };
+	const u32 lead{ DETAIL::smallest_set(sets) };
+	DETAIL::for_each_in_range<components...>(sets, lead, 0, sets[lead].count, func, std::index_sequence_for<components...>{});
+}
+
+// Same as for_each(), but the owner list is split in chunks of 'chunk_size' entities that run on the job system.
+// func is called concurrently and must only touch data of the entity it was given. The transform setters may be
+// called on that entity, their changes are published with the next TRANSFORM::publish_changes().
+template<typename... components, typename function>
+void for_each_parallel(function&& func, u32 chunk_size = 1024) {
+	static_assert(sizeof...(components) > 0, "Query at least one component type.");
+	const DETAIL::owner_set sets[]{ DETAIL::storage<components>::owners()... };
+	const u32 lead{ DETAIL::smallest_set(sets) };
+	JOBS::parallel_for(sets[lead].count, chunk_size, [&](u32 begin, u32 end) {
+		DETAIL::for_each_in_range<components...>(sets, lead, begin, end, func, std::index_sequence_for<components...>{});
+		});
+}
+
+// returns the number of entities that own all of the given component types.
+template<typename... components>
+u32 count() {
+	u32 result{ 0 };
+	for_each<components...>([&result](entity, components...) { ++result; });
+	return result;
+}
+
+}
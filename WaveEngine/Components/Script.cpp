@@ -1,11 +1,14 @@
 #include "Script.h"
 #include "Entity.h"
+#include "..\Utilities\IOStream.h"
+#include "..\Core\Profiler.h"
 
 namespace WAVEENGINE::SCRIPT {
 
 namespace {
 
 UTL::vector<DETAIL::script_ptr> entity_scripts;
+UTL::vector<DETAIL::script_creator> script_creators; // the creator of each script in entity_scripts, for snapshots
 UTL::vector<ID::id_type> id_mapping;
 
 UTL::vector<ID::generation_type> generations;
@@ -36,9 +39,11 @@ UTL::vector<std::string>& script_names() {
 bool exists(script_id id) {
 	assert(ID::is_valid(id));
 	const ID::id_type index{ ID::index(id) };
-	assert(index < generations.size() && id_mapping[index] < entity_scripts.size());
+	assert(index < generations.size());
 	assert(generations[index] == ID::generation(id));
-	return (generations[index] == ID::generation(id)) && entity_scripts[id_mapping[index]] && entity_scripts[id_mapping[index]]->is_valid();
+	// NOTE: removed scripts have an invalid mapping, that's how recycled ids are checked in create().
+	return (generations[index] == ID::generation(id)) && id_mapping[index] < entity_scripts.size() &&
+		entity_scripts[id_mapping[index]] && entity_scripts[id_mapping[index]]->is_valid();
 }
 
 }
@@ -53,9 +58,9 @@ u8 register_script(size_t tag, script_creator func) {
 
 script_creator get_script_creator(size_t tag)
 {
+	// NOTE: the tag may come from a level or a snapshot, unknown scripts return nullptr.
 	auto script = WAVEENGINE::SCRIPT::registery().find(tag);
-	assert(script != WAVEENGINE::SCRIPT::registery().end() && script->first == tag);
-	return script->second;
+	return script != WAVEENGINE::SCRIPT::registery().end() ? script->second : nullptr;
 }
 
 #ifdef USE_WITH_EDITOR
@@ -69,6 +74,7 @@ u8 add_script_name(const char* name)
 }
 
 component create(const init_info& info, GAME_ENTITY::entity entity) {
+	MEMORY_TAG(script);
 	assert(entity.is_valid());
 	assert(info.script_creator);
 
@@ -90,12 +96,28 @@ component create(const init_info& info, GAME_ENTITY::entity entity) {
 	assert(ID::is_valid(id));
 	const ID::id_type index{ (ID::id_type)entity_scripts.size() }; // just add a script element
 	entity_scripts.emplace_back(info.script_creator(entity));
+	script_creators.emplace_back(info.script_creator);
 	assert(entity_scripts.back()->get_id() == entity.get_id());
 	id_mapping[ID::index(id)] = index;
 
 	return component{id};
 }
 
+void create(const init_info& info, const GAME_ENTITY::entity* const entities, u32 count, component* const components) {
+	MEMORY_TAG(script);
+	assert(info.script_creator && (entities || !count) && components);
+
+	// NOTE: the scripts are still constructed one by one, but the storage grows only once for the whole batch.
+	entity_scripts.reserve(entity_scripts.size() + count);
+	script_creators.reserve(script_creators.size() + count);
+	id_mapping.reserve(id_mapping.size() + count);
+	generations.reserve(generations.size() + count);
+
+	for (u32 i{ 0 }; i < count; ++i) {
+		components[ID::index(entities[i].get_id())] = create(info, entities[i]);
+	}
+}
+
 void remove(component c) {
 	assert(c.is_valid() && exists(c.get_id()));
 	const script_id id{ c.get_id() };
@@ -107,20 +129,147 @@ void remove(component c) {
 	}
 
 	UTL::erase_unordered(entity_scripts, index);
+	UTL::erase_unordered(script_creators, index);
 
 	if (entity_scripts.size() > index) {
 		id_mapping[ID::index(last_id)] = index;
 	}
 	id_mapping[ID::index(id)] = ID::invalid_id;
-	free_ids.push_back(id);
+	if (!ID::is_generation_exhausted(id)) {
+		free_ids.push_back(id);
+	}
 }
 
 void update(float dt) {
+	PROFILE_SCOPE("Script update");
+	MEMORY_TAG(script);
 	for (auto& ptr : entity_scripts) {
 		ptr->update(dt);
 	}
 }
 
+/*
+ * [Snapshot format]
+ * id count
+ * id mapping[id count]
+ * generations[id count]
+ * free id count
+ * free ids[free id count]
+ * script count
+ * for each script:
+ *		script tag (hash of the script name)
+ *		entity id
+ *		state size
+ *		state[state size]
+ */
+
+u64 snapshot_size() {
+	u64 size{ sizeof(u32) + id_mapping.size() * (sizeof(ID::id_type) + sizeof(ID::generation_type)) };
+	size += sizeof(u32) + free_ids.size() * sizeof(ID::id_type);
+	size += sizeof(u32);
+	for (const auto& script : entity_scripts) {
+		size += sizeof(u64) + sizeof(ID::id_type) + sizeof(u32) + script->save_state(nullptr);
+	}
+	return size;
+}
+
+void save_snapshot(UTL::blobStreamWriter& writer) {
+	const u32 id_count{ (u32)id_mapping.size() };
+	writer.write<u32>(id_count);
+	writer.write((const u8*)id_mapping.data(), id_count * sizeof(ID::id_type));
+	writer.write((const u8*)generations.data(), id_count * sizeof(ID::generation_type));
+
+	writer.write<u32>((u32)free_ids.size());
+	for (const script_id id : free_ids) {
+		writer.write<ID::id_type>(id);
+	}
+
+	// the registry maps tags to creators, we need it the other way around.
+	std::unordered_map<DETAIL::script_creator, u64> tags;
+	for (const auto& [tag, creator] : registery()) {
+		tags[creator] = tag;
+	}
+
+	writer.write<u32>((u32)entity_scripts.size());
+	for (u64 i{ 0 }; i < entity_scripts.size(); ++i) {
+		assert(tags.count(script_creators[i]));
+		writer.write<u64>(tags[script_creators[i]]);
+		writer.write<ID::id_type>(entity_scripts[i]->get_id());
+
+		const u32 state_size{ entity_scripts[i]->save_state(nullptr) };
+		writer.write<u32>(state_size);
+		if (state_size) {
+			u8* const state{ const_cast<u8*>(writer.position()) };
+			writer.skip(state_size);
+			[[maybe_unused]] const u32 written{ entity_scripts[i]->save_state(state) };
+			assert(written == state_size);
+		}
+	}
+}
+
+void restore_snapshot(UTL::blobStreamReader& reader) {
+	entity_scripts.clear();
+	script_creators.clear();
+
+	const u32 id_count{ reader.read<u32>() };
+	id_mapping.resize(id_count);
+	generations.resize(id_count);
+	reader.read((u8*)id_mapping.data(), id_count * sizeof(ID::id_type));
+	reader.read((u8*)generations.data(), id_count * sizeof(ID::generation_type));
+
+	free_ids.clear();
+	const u32 free_count{ reader.read<u32>() };
+	for (u32 i{ 0 }; i < free_count; ++i) {
+		free_ids.push_back(script_id{ reader.read<ID::id_type>() });
+	}
+
+	// NOTE: scripts are restored in the same order, so id_mapping stays valid.
+	const u32 script_count{ reader.read<u32>() };
+	entity_scripts.reserve(script_count);
+	script_creators.reserve(script_count);
+	for (u32 i{ 0 }; i < script_count; ++i) {
+		const u64 tag{ reader.read<u64>() };
+		const GAME_ENTITY::entity entity{ GAME_ENTITY::entity_id{ reader.read<ID::id_type>() } };
+		const u32 state_size{ reader.read<u32>() };
+
+		const DETAIL::script_creator creator{ DETAIL::get_script_creator(tag) };
+		entity_scripts.emplace_back(creator(entity));
+		script_creators.emplace_back(creator);
+		if (state_size) {
+			entity_scripts.back()->load_state(reader.position(), state_size);
+			reader.skip(state_size);
+		}
+	}
+}
+
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size) {
+	if (!reader.can_read(sizeof(u32), size)) return false;
+	const u32 id_count{ reader.read<u32>() };
+	const u64 ids_length{ (u64)id_count * (sizeof(ID::id_type) + sizeof(ID::generation_type)) };
+	if (!reader.can_read(ids_length + sizeof(u32), size)) return false;
+	reader.skip(ids_length);
+
+	const u32 free_count{ reader.read<u32>() };
+	const u64 free_length{ (u64)free_count * sizeof(ID::id_type) };
+	if (free_count > id_count || !reader.can_read(free_length + sizeof(u32), size)) return false;
+	reader.skip(free_length);
+
+	const u32 script_count{ reader.read<u32>() };
+	if (script_count > id_count) return false;
+	for (u32 i{ 0 }; i < script_count; ++i) {
+		if (!reader.can_read(sizeof(u64) + sizeof(ID::id_type) + sizeof(u32), size)) return false;
+		const u64 tag{ reader.read<u64>() };
+		reader.skip(sizeof(ID::id_type));
+		const u32 state_size{ reader.read<u32>() };
+
+		// scripts are recreated from their tag, which has to be registered in this build.
+		if (!DETAIL::get_script_creator(tag)) return false;
+		if (!reader.can_read(state_size, size)) return false;
+		reader.skip(state_size);
+	}
+	return true;
+}
+
 }
 
 #ifdef USE_WITH_EDITOR
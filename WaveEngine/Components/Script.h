@@ -1,6 +1,11 @@
 #pragma once
 #include "ComponentsCommon.h"
 
+namespace WAVEENGINE::UTL {
+class blobStreamReader;
+class blobStreamWriter;
+}
+
 namespace WAVEENGINE::SCRIPT {
 
 struct init_info {
@@ -8,6 +13,15 @@ struct init_info {
 };
 
 component create(const init_info& info, GAME_ENTITY::entity entity);
+// creates a script of the same type for 'count' entities. The components are written to components[entity index].
+void create(const init_info& info, const GAME_ENTITY::entity* const entities, u32 count, component* const components);
 void remove(component c);
 void update(float dt);
+
+u64 snapshot_size();
+void save_snapshot(UTL::blobStreamWriter& writer);
+// NOTE: removes all current scripts and creates the ones in the snapshot.
+void restore_snapshot(UTL::blobStreamReader& reader);
+// walks the snapshot section without touching the world, false if it doesn't fit in 'size' bytes.
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size);
 }
\ No newline at end of file
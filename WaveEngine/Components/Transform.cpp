@@ -1,5 +1,9 @@
 #include "Transform.h"
 #include "Entity.h"
+#include "..\Utilities\IOStream.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
 
 namespace WAVEENGINE::TRANSFORM {
 
@@ -9,9 +13,72 @@ UTL::vector<MATH::v3> positions;
 UTL::vector<MATH::v4> rotations;
 UTL::vector<MATH::v3> scales;
 
+/*
+ * Change tracking:
+ * Every transform stores the version in which it last changed. The indices that change during a frame
+ * are collected once per version and turned into sorted ranges when the version is published.
+ * Consumers keep their own cursor (the last version they've seen) and ask for the ranges after it.
+ * Setters may run in parallel queries, so every thread collects its indices in its own list and
+ * publish_changes() merges the lists. versions[index] is only written by the job that owns the entity.
+ */
+constexpr u32 max_tracked_versions{ 64 };
+
+struct published_changes {
+	u32								version{ 0 };
+	UTL::vector<changed_range>		ranges;
+};
+
+struct change_list {
+	UTL::vector<u32>			indices;		// changed by one thread in the current, not yet published, version
+};
+
+UTL::vector<u32> versions;
+UTL::vector<u32> changed_indices;				// merged from all change lists by publish_changes()
+std::mutex change_lists_mutex;
+UTL::vector<std::unique_ptr<change_list>> change_lists;
+thread_local change_list* local_changes{ nullptr };
+published_changes history[max_tracked_versions];
+u32 current_version{ 1 };						// 0 is the cursor of consumers that haven't seen anything
+u32 full_change_version{ 0 };					// all transforms changed in this version (e.g. after restoring a snapshot)
+
+change_list& get_change_list() {
+	if (!local_changes) {
+		std::lock_guard lock{ change_lists_mutex };
+		change_lists.emplace_back(std::make_unique<change_list>());
+		local_changes = change_lists.back().get();
+	}
+	return *local_changes;
+}
+
+void mark_changed(ID::id_type index) {
+	assert(index < versions.size());
+	if (versions[index] != current_version) {
+		versions[index] = current_version;
+		get_change_list().indices.emplace_back((u32)index);
+	}
+}
+
+void clear_change_lists() {
+	std::lock_guard lock{ change_lists_mutex };
+	for (u32 i{ 0 }; i < change_lists.size(); ++i) {
+		change_lists[i]->indices.clear();
+	}
+}
+
+void add_version(ID::id_type index) {
+	if (versions.size() > index) {
+		versions[index] = 0;
+	} else {
+		assert(versions.size() == index);
+		versions.emplace_back(0);
+	}
+	mark_changed(index);
+}
+
 }
 
 component create(const init_info& info, GAME_ENTITY::entity entity) {
+	MEMORY_TAG(transform);
 	assert(entity.is_valid());
 	const ID::id_type entity_index{ ID::index(entity.get_id()) };
 	
@@ -25,15 +92,217 @@ component create(const init_info& info, GAME_ENTITY::entity entity) {
 		positions.emplace_back(info.position);
 		scales.emplace_back(info.scale);
 	}
+	add_version(entity_index);
 
 	//return component(transform_id{ (ID::id_type)positions.size() - 1 });
 	return component{ transform_id{entity.get_id()} };
 }
 
+void create(const init_info& info, const GAME_ENTITY::entity* const entities, u32 count, const MATH::v3* const instance_positions) {
+	MEMORY_TAG(transform);
+	assert(entities || !count);
+	const MATH::v4 rotation{ info.rotation };
+	const MATH::v3 position{ info.position };
+	const MATH::v3 scale{ info.scale };
+
+	// NOTE: new entities get consecutive indices at the end of the arrays, so we allocate only once.
+	const u64 capacity{ positions.size() + count };
+	rotations.reserve(capacity);
+	positions.reserve(capacity);
+	scales.reserve(capacity);
+	versions.reserve(capacity);
+	UTL::vector<u32>& changed_indices{ get_change_list().indices };
+	changed_indices.reserve(changed_indices.size() + count);
+
+	for (u32 i{ 0 }; i < count; ++i) {
+		assert(entities[i].is_valid());
+		const ID::id_type entity_index{ ID::index(entities[i].get_id()) };
+		const MATH::v3& entity_position{ instance_positions ? instance_positions[i] : position };
+
+		if (positions.size() > entity_index) {
+			rotations[entity_index] = rotation;
+			positions[entity_index] = entity_position;
+			scales[entity_index] = scale;
+		} else {
+			assert(positions.size() == entity_index);
+			rotations.emplace_back(rotation);
+			positions.emplace_back(entity_position);
+			scales.emplace_back(scale);
+		}
+		add_version(entity_index);
+	}
+}
+
+void create(const GAME_ENTITY::entity* const entities, u32 count, const MATH::v3* const new_positions, const MATH::v4* const new_rotations, const MATH::v3* const new_scales) {
+	MEMORY_TAG(transform);
+	assert((entities && new_positions && new_rotations && new_scales) || !count);
+
+	const u64 capacity{ positions.size() + count };
+	rotations.reserve(capacity);
+	positions.reserve(capacity);
+	scales.reserve(capacity);
+	versions.reserve(capacity);
+	UTL::vector<u32>& changed_indices{ get_change_list().indices };
+	changed_indices.reserve(changed_indices.size() + count);
+
+	for (u32 i{ 0 }; i < count; ++i) {
+		assert(entities[i].is_valid());
+		const ID::id_type entity_index{ ID::index(entities[i].get_id()) };
+
+		if (positions.size() > entity_index) {
+			rotations[entity_index] = new_rotations[i];
+			positions[entity_index] = new_positions[i];
+			scales[entity_index] = new_scales[i];
+		} else {
+			assert(positions.size() == entity_index);
+			rotations.emplace_back(new_rotations[i]);
+			positions.emplace_back(new_positions[i]);
+			scales.emplace_back(new_scales[i]);
+		}
+		add_version(entity_index);
+	}
+}
+
 void remove([[maybe_unused]]component c) {
 	assert(c.is_valid());
 
-	// TODO 
+	// NOTE: removing a transform counts as a change, so consumers can drop what they keep for it.
+	mark_changed(ID::index(c.get_id()));
+}
+
+u32 publish_changes() {
+	const u32 version{ current_version };
+	published_changes& changes{ history[version % max_tracked_versions] };
+	changes.version = version;
+	changes.ranges.clear();
+
+	// NOTE: called on the main thread between frames, no setters run at the same time.
+	{
+		std::lock_guard lock{ change_lists_mutex };
+		for (u32 i{ 0 }; i < change_lists.size(); ++i) {
+			UTL::vector<u32>& indices{ change_lists[i]->indices };
+			for (const u32 index : indices) changed_indices.emplace_back(index);
+			indices.clear();
+		}
+	}
+
+	std::sort(changed_indices.begin(), changed_indices.end());
+	for (const u32 index : changed_indices) {
+		if (!changes.ranges.empty() && changes.ranges.back().first + changes.ranges.back().count == index) {
+			++changes.ranges.back().count;
+		}
+		else {
+			changes.ranges.emplace_back(changed_range{ index, 1 });
+		}
+	}
+
+	changed_indices.clear();
+	++current_version;
+	return version;
+}
+
+u32 get_changes(u32 version, UTL::vector<changed_range>& ranges) {
+	const u32 latest{ current_version - 1 };
+	if (version >= latest) return latest;
+
+	const u32 oldest{ latest >= max_tracked_versions ? latest - max_tracked_versions + 1 : 1 };
+	if (version + 1 < oldest || version < full_change_version) {
+		if (!positions.empty()) {
+			ranges.emplace_back(changed_range{ 0, (u32)positions.size() });
+		}
+		return latest;
+	}
+
+	const u64 first_new{ ranges.size() };
+	for (u32 v{ version + 1 }; v <= latest; ++v) {
+		const published_changes& changes{ history[v % max_tracked_versions] };
+		assert(changes.version == v);
+		for (const auto& range : changes.ranges) {
+			ranges.emplace_back(range);
+		}
+	}
+
+	// ranges of one version are already sorted and disjoint, only multiple versions need to be merged.
+	if (latest - version > 1 && ranges.size() > first_new) {
+		std::sort(ranges.begin() + first_new, ranges.end(), [](const changed_range& a, const changed_range& b) {
+			return a.first < b.first;
+			});
+
+		u64 last{ first_new };
+		for (u64 i{ first_new + 1 }; i < ranges.size(); ++i) {
+			changed_range& merged{ ranges[last] };
+			const changed_range range{ ranges[i] };
+			if (range.first <= merged.first + merged.count) {
+				merged.count = std::max(merged.first + merged.count, range.first + range.count) - merged.first;
+			}
+			else {
+				ranges[++last] = range;
+			}
+		}
+		ranges.resize(last + 1);
+	}
+
+	return latest;
+}
+
+u32 count() {
+	return (u32)positions.size();
+}
+
+const MATH::v3* position_data() {
+	return positions.data();
+}
+
+const MATH::v4* rotation_data() {
+	return rotations.data();
+}
+
+const MATH::v3* scale_data() {
+	return scales.data();
+}
+
+/*
+ * [Snapshot format]
+ * transform count
+ * positions[count]
+ * rotations[count]
+ * scales[count]
+ */
+
+u64 snapshot_size() {
+	return sizeof(u32) + positions.size() * (sizeof(MATH::v3) + sizeof(MATH::v4) + sizeof(MATH::v3));
+}
+
+void save_snapshot(UTL::blobStreamWriter& writer) {
+	const u32 size{ (u32)positions.size() };
+	writer.write<u32>(size);
+	writer.write((const u8*)positions.data(), size * sizeof(MATH::v3));
+	writer.write((const u8*)rotations.data(), size * sizeof(MATH::v4));
+	writer.write((const u8*)scales.data(), size * sizeof(MATH::v3));
+}
+
+void restore_snapshot(UTL::blobStreamReader& reader) {
+	const u32 size{ reader.read<u32>() };
+	positions.resize(size);
+	rotations.resize(size);
+	scales.resize(size);
+	reader.read((u8*)positions.data(), size * sizeof(MATH::v3));
+	reader.read((u8*)rotations.data(), size * sizeof(MATH::v4));
+	reader.read((u8*)scales.data(), size * sizeof(MATH::v3));
+
+	// everything may have changed, consumers have to pick up all transforms with the next version.
+	versions.clear();
+	versions.resize(size, current_version);
+	clear_change_lists();
+	full_change_version = current_version;
+}
+
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size) {
+	if (!reader.can_read(sizeof(u32), size)) return false;
+	const u64 length{ (u64)reader.read<u32>() * (sizeof(MATH::v3) + sizeof(MATH::v4) + sizeof(MATH::v3)) };
+	if (!reader.can_read(length, size)) return false;
+	reader.skip(length);
+	return true;
 }
 
 MATH::v4 component::rotation() const {
@@ -51,4 +320,30 @@ MATH::v3 component::scale() const{
 	return scales[ID::index(_id)];
 }
 
+void component::set_rotation(const MATH::v4& rotation) const {
+	assert(is_valid());
+	const ID::id_type index{ ID::index(_id) };
+	rotations[index] = rotation;
+	mark_changed(index);
+}
+
+void component::set_position(const MATH::v3& position) const {
+	assert(is_valid());
+	const ID::id_type index{ ID::index(_id) };
+	positions[index] = position;
+	mark_changed(index);
+}
+
+void component::set_scale(const MATH::v3& scale) const {
+	assert(is_valid());
+	const ID::id_type index{ ID::index(_id) };
+	scales[index] = scale;
+	mark_changed(index);
+}
+
+u32 component::version() const {
+	assert(is_valid());
+	return versions[ID::index(_id)];
+}
+
 }
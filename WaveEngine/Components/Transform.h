@@ -1,6 +1,11 @@
 #pragma once
 #include "ComponentsCommon.h"
 
+namespace WAVEENGINE::UTL {
+class blobStreamReader;
+class blobStreamWriter;
+}
+
 namespace WAVEENGINE::TRANSFORM {
 
 struct init_info {
@@ -10,5 +15,37 @@ struct init_info {
 };
 
 component create(const init_info& info, GAME_ENTITY::entity entity);
+// creates the same transform for 'count' entities. 'instance_positions' is optional and overrides info.position per entity.
+void create(const init_info& info, const GAME_ENTITY::entity* const entities, u32 count, const MATH::v3* const instance_positions);
+// creates a transform per entity from arrays with 'count' elements, e.g. the columns of a level file.
+void create(const GAME_ENTITY::entity* const entities, u32 count, const MATH::v3* const positions, const MATH::v4* const rotations, const MATH::v3* const scales);
 void remove(component c);
+
+// a run of consecutive transform indices (same as entity indices) that changed
+struct changed_range {
+	u32 first;
+	u32 count;
+};
+
+// Publishes the transform changes made since the previous call under a new version and returns it.
+// The engine calls this once per frame, after updating the scripts.
+u32 publish_changes();
+
+// Appends the sorted and merged ranges of transforms that changed after 'version' to 'ranges' and
+// returns the latest published version, which the caller keeps as its cursor for the next call.
+// If 'version' is older than the tracked history, one range that covers all transforms is returned.
+u32 get_changes(u32 version, UTL::vector<changed_range>& ranges);
+
+// transform data indexed by entity index, for copying changed ranges in bulk.
+// NOTE: the pointers are only valid until the next transform is created.
+u32 count();
+const MATH::v3* position_data();
+const MATH::v4* rotation_data();
+const MATH::v3* scale_data();
+
+u64 snapshot_size();
+void save_snapshot(UTL::blobStreamWriter& writer);
+void restore_snapshot(UTL::blobStreamReader& reader);
+// walks the snapshot section without touching the world, false if it doesn't fit in 'size' bytes.
+bool validate_snapshot(UTL::blobStreamReader& reader, u64 size);
 }
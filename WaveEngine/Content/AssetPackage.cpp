@@ -0,0 +1,104 @@
+#include "AssetPackage.h"
+#include "..\Utilities\Compression.h"
+
+namespace WAVEENGINE::CONTENT {
+
+bool assetPackage::open(const std::filesystem::path& path) {
+	close();
+	if (!_file.open(path)) return false;
+
+	const u8* const data{ _file.data() };
+	const u64 file_size{ _file.size() };
+	pack_file_header header{};
+	if (file_size < sizeof(header)) {
+		close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	const u64 entries_size{ (u64)header.entry_count * sizeof(pack_entry) };
+	const u64 blobs_size{ (u64)header.blob_count * sizeof(pack_blob) };
+	const bool is_header_valid{
+		header.magic == pack_file_magic && header.version == pack_file_version && header.file_size == file_size &&
+		header.entries_offset % alignof(pack_entry) == 0 && header.blobs_offset % alignof(pack_blob) == 0 &&
+		header.entries_offset <= file_size && entries_size <= file_size - header.entries_offset &&
+		header.blobs_offset <= file_size && blobs_size <= file_size - header.blobs_offset &&
+		// the tables are written next to each other, so they are hashed together.
+		header.blobs_offset == header.entries_offset + entries_size };
+	if (!is_header_valid || UTL::fnv1a_64(data + header.entries_offset, entries_size + blobs_size) != header.hash) {
+		close();
+		return false;
+	}
+
+	_entries = reinterpret_cast<const pack_entry*>(data + header.entries_offset);
+	_blobs = reinterpret_cast<const pack_blob*>(data + header.blobs_offset);
+	_entry_count = header.entry_count;
+	_blob_count = header.blob_count;
+
+	for (u32 i{ 0 }; i < _entry_count; ++i) {
+		// NOTE: the binary search in find() only works if the entries are sorted and their names are unique.
+		if (_entries[i].blob >= _blob_count || (i && _entries[i - 1].name_hash >= _entries[i].name_hash)) {
+			close();
+			return false;
+		}
+	}
+	for (u32 i{ 0 }; i < _blob_count; ++i) {
+		const pack_blob& blob{ _blobs[i] };
+		if (blob.offset > file_size || blob.size > file_size - blob.offset || blob.compression >= pack_compression::count ||
+			(blob.compression == pack_compression::none && blob.size != blob.original_size)) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void assetPackage::close() {
+	_file.close();
+	_entries = nullptr;
+	_blobs = nullptr;
+	_entry_count = 0;
+	_blob_count = 0;
+}
+
+u64 assetPackage::size(u64 name_hash) const {
+	const pack_blob* const blob{ find(name_hash) };
+	return blob ? blob->original_size : 0;
+}
+
+pack_view assetPackage::view(u64 name_hash) const {
+	const pack_blob* const blob{ find(name_hash) };
+	if (!blob || blob->compression != pack_compression::none) return {};
+	return { _file.data() + blob->offset, blob->size };
+}
+
+bool assetPackage::read(u64 name_hash, UTL::vector<u8>& data) const {
+	const pack_blob* const blob{ find(name_hash) };
+	if (!blob) return false;
+
+	const u8* const stored{ _file.data() + blob->offset };
+	if (UTL::crc32(stored, blob->size) != blob->crc) return false;
+
+	switch (blob->compression) {
+	case pack_compression::none:
+		data.resize(blob->size);
+		memcpy(data.data(), stored, blob->size);
+		return true;
+	case pack_compression::lz:
+		if (UTL::lz_frame_original_size(stored, blob->size) != blob->original_size) return false;
+		data.resize(blob->original_size);
+		return UTL::lz_decompress_frame(stored, blob->size, data.data(), blob->original_size);
+	default:
+		return false;
+	}
+}
+
+const pack_blob* assetPackage::find(u64 name_hash) const {
+	const pack_entry* const end{ _entries + _entry_count };
+	const pack_entry* const it{ std::lower_bound(_entries, end, name_hash,
+		[](const pack_entry& entry, u64 hash) { return entry.name_hash < hash; }) };
+	return (it != end && it->name_hash == name_hash) ? &_blobs[it->blob] : nullptr;
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "PackFormat.h"
+#include "..\Platform\MappedFile.h"
+
+namespace WAVEENGINE::CONTENT {
+
+struct pack_view {
+	const u8*	data;
+	u64			size;
+};
+
+// A mapped .wpak archive. Lookups are a binary search of the sorted entry table, and uncompressed entries
+// are used in place, without copying them out of the mapping.
+class assetPackage {
+public:
+	assetPackage() = default;
+	DISABLE_COPY(assetPackage);
+	assetPackage(assetPackage&&) noexcept = default;
+	assetPackage& operator=(assetPackage&&) noexcept = default;
+
+	// Maps the archive and checks its header and tables. The blobs are only checked when they are read.
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	[[nodiscard]] bool contains(u64 name_hash) const { return find(name_hash) != nullptr; }
+	[[nodiscard]] bool contains(const char* name) const { return contains(pack_name_hash(name)); }
+
+	// Returns the size of the entry's data after decompression, 0 if there is no such entry.
+	[[nodiscard]] u64 size(u64 name_hash) const;
+
+	// Returns the data of an uncompressed entry where it is mapped, or an empty view if the entry doesn't exist
+	// or is compressed. NOTE: the CRC isn't checked, use read() for data that must be validated.
+	[[nodiscard]] pack_view view(u64 name_hash) const;
+
+	// Copies, or decompresses, the entry into 'data' after checking its CRC.
+	bool read(u64 name_hash, UTL::vector<u8>& data) const;
+	bool read(const char* name, UTL::vector<u8>& data) const { return read(pack_name_hash(name), data); }
+
+	[[nodiscard]] u32 entry_count() const { return _entry_count; }
+	[[nodiscard]] u32 blob_count() const { return _blob_count; }
+	[[nodiscard]] bool is_valid() const { return _file.is_valid(); }
+
+private:
+	const pack_blob* find(u64 name_hash) const;
+
+	PLATFORM::mappedFile	_file{};
+	const pack_entry*		_entries{ nullptr };
+	const pack_blob*		_blobs{ nullptr };
+	u32						_entry_count{ 0 };
+	u32						_blob_count{ 0 };
+};
+
+}
@@ -1,14 +1,26 @@
 #include "ContentLoader.h"
+#include "GameFormat.h"
 #include "..\Components\Entity.h"
 #include "..\Components\Transform.h"
 #include "..\Components\Script.h"
+#include "..\Components\EntityQuery.h"
+#include "..\Spatial\SpatialIndex.h"
+#include "..\Utilities\IOStream.h"
+#include "..\Utilities\Hash.h"
+#include "Streaming.h"
+#include "AssetPackage.h"
 #include "Graphics\Renderer.h"
+#include "ResourceCache.h"
+#include "..\Platform\FileWatcher.h"
+#include "..\Core\Profiler.h"
 
 #if !defined(SHIPPING)
 
 #include <fstream>
 #include <filesystem>
-#include <Windows.h>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
 
 namespace WAVEENGINE::CONTENT {
 
@@ -21,10 +33,42 @@ enum component_type {
 	count
 };
 
-UTL::vector<GAME_ENTITY::entity> entities;
 TRANSFORM::init_info transform_info{}; // f32: 3, 4, 3
 SCRIPT::init_info script_info{};
 
+// NOTE: entities don't reference meshes yet, so every loaded entity is indexed with the bounds of a unit cube.
+constexpr MATH::v3 loaded_entity_extents{ 0.5f, 0.5f, 0.5f };
+
+// Adds a loaded entity to the spatial index, so spatial queries find it.
+void add_loaded_entity(GAME_ENTITY::entity entity) {
+	if (entity.is_valid()) SPATIAL::add(entity, loaded_entity_extents);
+}
+
+void remove_loaded_entity(GAME_ENTITY::entity_id id) {
+	if (SPATIAL::is_indexed(id)) SPATIAL::remove(id);
+	GAME_ENTITY::remove(id);
+}
+
+load_stats stats{};
+
+// Adds the time until it goes out of scope to a phase of load_stats.
+class phaseTimer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit phaseTimer(f64& ms) : _ms{ ms }, _start{ clock::now() } {}
+	~phaseTimer() { _ms += elapsed_ms(_start); }
+	DISABLE_COPY_AND_MOVE(phaseTimer);
+
+	static f64 elapsed_ms(clock::time_point start) {
+		return std::chrono::duration<f64, std::milli>(clock::now() - start).count();
+	}
+
+private:
+	f64&					_ms;
+	const clock::time_point	_start;
+};
+
 /*
  * [Transform format]
  * position.x
@@ -38,27 +82,72 @@ SCRIPT::init_info script_info{};
  * scale.z
  */
 
-bool read_transform(const u8*& data, GAME_ENTITY::entity_info& info) {
+// Converts euler angles (x, y, z in radians) to a quaternion (x, y, z, w).
+void euler_to_quaternion(const f32* const euler, f32* const quaternion) {
 	using namespace DirectX;
-	f32 rotation[3];
+	XMFLOAT3A rot{ euler };
+	XMVECTOR quat{ XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3A(&rot)) };
+	XMFLOAT4A rot_quat{};
+	XMStoreFloat4A(&rot_quat, quat);
+	memcpy(quaternion, &rot_quat.x, 4 * sizeof(f32));
+}
 
-	assert(!info.transform);
+// Converts 'count' euler angles to quaternions like euler_to_quaternion(), but four at a time: the angles of
+// four entities are gathered into one vector per axis, so one sine/cosine evaluation covers all of them.
+void euler_to_quaternions(const f32* const euler, MATH::v4* const quaternions, u32 count) {
+	using namespace DirectX;
+	const u32 vector_count{ count & ~3u };
+	for (u32 i{ 0 }; i < vector_count; i += 4) {
+		const f32* const e{ &euler[i * 3] };
+		const XMVECTOR half{ XMVectorReplicate(0.5f) };
+		XMVECTOR sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+		XMVectorSinCos(&sin_x, &cos_x, XMVectorMultiply(XMVectorSet(e[0], e[3], e[6], e[9]), half));
+		XMVectorSinCos(&sin_y, &cos_y, XMVectorMultiply(XMVectorSet(e[1], e[4], e[7], e[10]), half));
+		XMVectorSinCos(&sin_z, &cos_z, XMVectorMultiply(XMVectorSet(e[2], e[5], e[8], e[11]), half));
+
+		// same order as XMQuaternionRotationRollPitchYaw(): roll (z), then pitch (x), then yaw (y).
+		const XMVECTOR cos_xy{ XMVectorMultiply(cos_x, cos_y) };
+		const XMVECTOR sin_xy{ XMVectorMultiply(sin_x, sin_y) };
+		const XMVECTOR sin_x_cos_y{ XMVectorMultiply(sin_x, cos_y) };
+		const XMVECTOR cos_x_sin_y{ XMVectorMultiply(cos_x, sin_y) };
+		const XMMATRIX q{
+			XMVectorMultiplyAdd(sin_x_cos_y, cos_z, XMVectorMultiply(cos_x_sin_y, sin_z)),
+			XMVectorSubtract(XMVectorMultiply(cos_x_sin_y, cos_z), XMVectorMultiply(sin_x_cos_y, sin_z)),
+			XMVectorSubtract(XMVectorMultiply(cos_xy, sin_z), XMVectorMultiply(sin_xy, cos_z)),
+			XMVectorMultiplyAdd(cos_xy, cos_z, XMVectorMultiply(sin_xy, sin_z)),
+		};
+
+		// back from one vector per component to one quaternion per entity.
+		const XMMATRIX quats{ XMMatrixTranspose(q) };
+		for (u32 j{ 0 }; j < 4; ++j) {
+			XMStoreFloat4(&quaternions[i + j], quats.r[j]);
+		}
+	}
+
+	for (u32 i{ vector_count }; i < count; ++i) {
+		euler_to_quaternion(&euler[i * 3], &quaternions[i].x);
+	}
+}
+
+void set_transform_info(const f32* const position, const f32* const rotation, const f32* const scale) {
+	memcpy(&transform_info.position[0], position, sizeof(transform_info.position));
+	memcpy(&transform_info.scale[0], scale, sizeof(transform_info.scale));
 
-	memcpy(&transform_info.position[0], data, sizeof(transform_info.position));
-	data += sizeof(transform_info.position); // move pointer forward
-	memcpy(&rotation[0], data, sizeof(rotation));
-	data += sizeof(rotation);
-	memcpy(&transform_info.scale[0], data, sizeof(transform_info.scale));
-	data += sizeof(transform_info.scale);
-	
 	// remember to transfer euler coordinates to quaternion coordinates
+	euler_to_quaternion(rotation, &transform_info.rotation[0]);
+}
 
-	XMFLOAT3A rot{ &rotation[0] };
-	XMVECTOR quat{ XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3A(&rot)) };
-	XMFLOAT4A rot_quat{};
-	XMStoreFloat4A(&rot_quat, quat);
-	memcpy(&transform_info.rotation[0], &rot_quat.x, sizeof(transform_info.rotation));
+bool read_transform(UTL::checkedReader& reader, GAME_ENTITY::entity_info& info) {
+	assert(!info.transform);
+
+	// position, rotation (euler angles) and scale
+	const u8* const data{ reader.take(9 * sizeof(f32)) };
+	if (!data)
+		return false;
 
+	f32 transform[9];
+	memcpy(&transform[0], data, sizeof(transform));
+	set_transform_info(&transform[0], &transform[3], &transform[6]);
 	info.transform = &transform_info;
 
 	return true;
@@ -70,59 +159,30 @@ bool read_transform(const u8*& data, GAME_ENTITY::entity_info& info) {
  * script name
  */
 
-bool read_script(const u8*& data, GAME_ENTITY::entity_info& info) {
+bool read_script(UTL::checkedReader& reader, GAME_ENTITY::entity_info& info) {
 	assert(!info.script);
 
-	const u32 name_length{ *data };
-	data += sizeof(u32);
-
-	if (!name_length)
+	const std::string_view script_name{ reader.read_string() };
+	if (script_name.empty())
 		return false;
 
-	// something is probably wrong when a script name is longer than 256
-	assert(name_length < 256);
-	char script_name[256];
-	memcpy(&script_name[0], data, name_length);
-	data += name_length;
-
-	// make the name a zero_terminated c-string
-	script_name[name_length] = 0;
-
-	script_info.script_creator = SCRIPT::DETAIL::get_script_creator(SCRIPT::DETAIL::string_hash()(script_name));
+	script_info.script_creator = SCRIPT::DETAIL::get_script_creator(SCRIPT::DETAIL::string_hash()(std::string{ script_name }));
 	info.script = &script_info;
 	
 	return script_info.script_creator != nullptr;
 }
 
-using component_reader = bool(*)(const u8*&, GAME_ENTITY::entity_info&);
+using component_reader = bool(*)(UTL::checkedReader&, GAME_ENTITY::entity_info&);
 
 component_reader component_readers[]{
 	read_transform,
 	read_script,
 };
 static_assert(_countof(component_readers) == component_type::count); // runtime check
-
-bool read_file(const std::filesystem::path& path, std::unique_ptr<u8[]>& data, u64& size) {
-	if (!std::filesystem::exists(path)) return false;
-
-	size = std::filesystem::file_size(path);
-	assert(size);
-	if (!size) return false;
-	data = std::make_unique<u8[]>(size);
-	std::ifstream file{ path, std::ios::in | std::ios::binary };
-	if (!file || !file.read((char*)data.get(), size)) {
-		file.close();
-		return false;
-	}
-
-	file.close();
-	return true;
-}
-
-} // namespace anonymous
+static_assert((u32)game_component::transform == component_type::transform && (u32)game_component::script == component_type::script);
 
 /*
- * [game.bin format]
+ * [game.bin v1 format], still loaded for files written by older versions of the editor. See GameFormat.h for v2.
  * Game Entities Count
  * Game Entity Type
  * Game Entity Components Count
@@ -134,69 +194,608 @@ bool read_file(const std::filesystem::path& path, std::unique_ptr<u8[]>& data, u
  * ...
  */
 
-bool load_game() {
-	// set the working directory to the executable path
-	//wchar_t path[MAX_PATH];
-	//const u32 length{ GetModuleFileName(0, &path[0], MAX_PATH) };
-	//if (!length || GetLastError() == ERROR_INSUFFICIENT_BUFFER)
-	//	return false; 
-
-	//std::filesystem::path p{ path };
-	//SetCurrentDirectory(p.parent_path().wstring().c_str());
-
-	// read game.bin and create the entities.
-	std::unique_ptr<u8[]> game_data{};
-	u64 size{ 0 };
-	if (!read_file("game.bin", game_data, size))	return false;
-	assert(game_data.get());
-	//std::ifstream game("game.bin", std::ios::in | std::ios::binary);
-	//UTL::vector<u8> buffer(std::istreambuf_iterator<char>(game), {});
-	//assert(buffer.size());
-
-	const u8* at{ game_data.get() };
-	constexpr u32 su32{ sizeof(u32) }; 
-	const u32 num_entities{ *at }; // Game Entities Count
-	at += su32; 
+bool load_game_v1(const u8* const data, u64 size) {
+	// NOTE: v1 files have no header or checksum, every read is checked against the size.
+	UTL::checkedReader reader{ data, size };
+	const u32 num_entities{ reader.read_u32() }; // Game Entities Count
 	if (!num_entities) 
 		return false;
 
 	for (u32 entity_index{ 0 }; entity_index < num_entities; ++entity_index) {
 		GAME_ENTITY::entity_info info{};
-		const u32 entity_type{ *at }; // Game Entity Type
-		at += su32; 
-		const u32 num_components{ *at }; // Game Entity Components Count
-		at += su32; 
+		[[maybe_unused]] const u32 entity_type{ reader.read_u32() }; // Game Entity Type
+		const u32 num_components{ reader.read_u32() }; // Game Entity Components Count
 		if (!num_components)
 			return false;
 
 		for (u32 component_index{ 0 }; component_index < num_components; ++component_index) {
-			const u32 component_type{ *at }; // Component Type
-			at += su32;
-			if (!component_readers[component_type](at, info)) // Component Information
+			const u32 type{ reader.read_u32() }; // Component Type
+			if (!reader.is_valid() || type >= component_type::count)
+				return false;
+			// NOTE: an entity has at most one component of each type.
+			if ((type == component_type::transform && info.transform) || (type == component_type::script && info.script))
+				return false;
+			if (!component_readers[type](reader, info)) // Component Information
 				return false;
 		}
 
-		assert(info.transform); // at least each entity has transform information
+		// at least each entity has transform information
+		if (!info.transform)
+			return false;
 		GAME_ENTITY::entity entity{ GAME_ENTITY::create(info) };
 		if (!entity.is_valid())
 			return false;
+		add_loaded_entity(entity);
+	}
+
+	return reader.is_at_end();
+}
+
+using section_table = const game_section_entry* [(u32)game_section::count];
+
+// Checks the header, the section table and the CRC of every section, and finds the sections we know.
+bool validate_game_file(const u8* const data, u64 file_size, section_table& sections) {
+	if (file_size < sizeof(game_file_header)) return false;
+
+	game_file_header header;
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != game_file_magic || header.version != game_file_version || header.file_size != file_size)
+		return false;
+
+	const u64 table_size{ (u64)header.section_count * sizeof(game_section_entry) };
+	if (table_size > file_size - sizeof(header)) return false;
+	const game_section_entry* const table{ reinterpret_cast<const game_section_entry*>(data + sizeof(header)) };
+	if (UTL::fnv1a_64(table, table_size) != header.hash) return false;
+
+	for (u32 i{ 0 }; i < header.section_count; ++i) {
+		const game_section_entry& section{ table[i] };
+		if (section.offset % game_section_alignment || section.offset > file_size || section.size > file_size - section.offset)
+			return false;
+		if (section.stride && (u64)section.stride * section.count != section.size)
+			return false;
+		if (UTL::crc32(data + section.offset, section.size) != section.crc)
+			return false;
+		// NOTE: sections added by newer versions of the editor are skipped.
+		if ((u32)section.id < (u32)game_section::count) {
+			sections[(u32)section.id] = &section;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+const T* get_column(const u8* const data, const game_section_entry* const section, u32 count, u32 stride = sizeof(T)) {
+	if (!section || section->count != count || section->stride != stride) return nullptr;
+	return reinterpret_cast<const T*>(data + section->offset);
+}
 
-		entities.emplace_back(entity);
+// Resolves the script creator of every name in the string table, so each name is only hashed once.
+bool resolve_script_names(const u8* const data, const game_section_entry* const strings, UTL::vector<SCRIPT::DETAIL::script_creator>& creators) {
+	if (!strings || (u64)strings->count * sizeof(u32) > strings->size) return false;
+	const u8* const start{ data + strings->offset };
+	const u32* const offsets{ reinterpret_cast<const u32*>(start) };
+
+	creators.resize(strings->count);
+	for (u32 i{ 0 }; i < strings->count; ++i) {
+		if (offsets[i] >= strings->size) return false;
+		const char* const name{ reinterpret_cast<const char*>(start + offsets[i]) };
+		const u64 max_length{ strings->size - offsets[i] };
+		const u64 length{ strnlen(name, max_length) };
+		if (length == max_length) return false; // not zero terminated
+
+		creators[i] = SCRIPT::DETAIL::get_script_creator(SCRIPT::DETAIL::string_hash()(std::string{ name, length }));
 	}
+	return true;
+}
+
+// The columns of a file that passed validate_game_file().
+struct game_columns {
+	u32												num_entities;
+	const u32*										components;
+	const f32*										positions;
+	const f32*										rotations;
+	const f32*										scales;
+	const u64*										entity_ids;		// nullptr in files written before entity ids were added
+	u32												num_scripts;
+	const u32*										script_names;
+	UTL::vector<SCRIPT::DETAIL::script_creator>		creators;		// per string
+};
 
-	assert(at == game_data.get() + size);
+bool read_game_columns(const u8* const data, const section_table& sections, game_columns& columns) {
+	const game_section_entry* const entities{ sections[(u32)game_section::entities] };
+	if (!entities || !entities->count) return false;
+	const u32 num_entities{ entities->count };
+	columns.num_entities = num_entities;
+	columns.components = get_column<u32>(data, entities, num_entities);
+
+	// every entity has a transform, so the transform columns have one element per entity.
+	columns.positions = get_column<f32>(data, sections[(u32)game_section::transform_positions], num_entities, 3 * sizeof(f32));
+	columns.rotations = get_column<f32>(data, sections[(u32)game_section::transform_rotations], num_entities, 3 * sizeof(f32));
+	columns.scales = get_column<f32>(data, sections[(u32)game_section::transform_scales], num_entities, 3 * sizeof(f32));
+	if (!columns.components || !columns.positions || !columns.rotations || !columns.scales) return false;
+
+	const game_section_entry* const ids{ sections[(u32)game_section::entity_ids] };
+	columns.entity_ids = ids ? get_column<u64>(data, ids, num_entities) : nullptr;
+	if (ids && !columns.entity_ids) return false;
+
+	const game_section_entry* const scripts{ sections[(u32)game_section::script_names] };
+	columns.num_scripts = scripts ? scripts->count : 0;
+	columns.script_names = columns.num_scripts ? get_column<u32>(data, scripts, columns.num_scripts) : nullptr;
+	return !columns.num_scripts || columns.script_names;
+}
+
+bool resolve_game_scripts(const u8* const data, const section_table& sections, game_columns& columns) {
+	return !columns.num_scripts || resolve_script_names(data, sections[(u32)game_section::strings], columns.creators);
+}
+
+constexpr u32 transform_bit{ 1u << (u32)game_component::transform };
+constexpr u32 script_bit{ 1u << (u32)game_component::script };
+
+// Finds the script of the next entity. Scripts are stored in entity order, 'script_index' counts the ones already read.
+bool get_entity_script(const game_columns& columns, u32 components, u32& script_index, SCRIPT::DETAIL::script_creator& creator) {
+	creator = nullptr;
+	if (!(components & script_bit)) return true;
+	if (script_index >= columns.num_scripts || columns.script_names[script_index] >= columns.creators.size()) return false;
+	creator = columns.creators[columns.script_names[script_index++]];
+	return creator != nullptr;
+}
+
+/*
+ * [Hot reload]
+ * Every world section remembers what it created for each entity, keyed by the editor's entity id.
+ * When the file changes, the new file is compared with that record rather than with the live world,
+ * so changes made by scripts are kept unless the editor changed the same entity.
+ */
+
+struct level_entity {
+	u64								key;			// the editor's entity id, or the index in files without ids
+	GAME_ENTITY::entity_id			id;
+	u32								components;
+	SCRIPT::DETAIL::script_creator	script;
+	f32								transform[9];	// position, rotation (euler) and scale as stored in the file
+};
+
+struct level_file {
+	UTL::vector<level_entity>	entities;		// sorted by key
+	bool						is_reloadable;	// false if the file has the same entity id twice
+};
+
+// The world sections that were loaded, by level_source_key(). Only used on the main thread.
+std::unordered_map<u64, level_file>	level_files;
+// The paths of the requested world sections, by level_source_key(), so that all of them can be reloaded.
+std::unordered_map<u64, std::filesystem::path> section_paths;
+
+u64 level_source_key(const std::filesystem::path& path) {
+	const std::string name{ path.lexically_normal().generic_string() };
+	return UTL::fnv1a_64(name.data(), name.size());
+}
+
+level_entity make_level_entity(const game_columns& columns, u32 index, SCRIPT::DETAIL::script_creator script) {
+	level_entity e{};
+	e.key = columns.entity_ids ? columns.entity_ids[index] : index;
+	e.id = GAME_ENTITY::entity_id{ ID::invalid_id };
+	e.components = columns.components[index];
+	e.script = script;
+	memcpy(&e.transform[0], &columns.positions[index * 3], 3 * sizeof(f32));
+	memcpy(&e.transform[3], &columns.rotations[index * 3], 3 * sizeof(f32));
+	memcpy(&e.transform[6], &columns.scales[index * 3], 3 * sizeof(f32));
+	return e;
+}
+
+// Sorts the entities by key and returns false if a key is used twice.
+bool sort_level_entities(UTL::vector<level_entity>& entities) {
+	std::sort(entities.begin(), entities.end(), [](const level_entity& a, const level_entity& b) { return a.key < b.key; });
+	for (u32 i{ 1 }; i < entities.size(); ++i) {
+		if (entities[i - 1].key == entities[i].key) return false;
+	}
 	return true;
 }
 
+GAME_ENTITY::entity create_level_entity(const level_entity& e) {
+	GAME_ENTITY::entity_info info{};
+	set_transform_info(&e.transform[0], &e.transform[3], &e.transform[6]);
+	info.transform = &transform_info;
+	if (e.script) {
+		script_info.script_creator = e.script;
+		info.script = &script_info;
+	}
+	const GAME_ENTITY::entity entity{ GAME_ENTITY::create(info) };
+	add_loaded_entity(entity);
+	return entity;
+}
+
+// Brings the live entity of 'old_entity' up to date with 'new_entity'. Returns false if it had to be created again and that failed.
+bool update_level_entity(const level_entity& old_entity, level_entity& new_entity) {
+	new_entity.id = old_entity.id;
+	// removed by the game in the meantime, it stays removed.
+	if (!GAME_ENTITY::is_alive(old_entity.id)) return true;
+
+	if (old_entity.components != new_entity.components || old_entity.script != new_entity.script) {
+		// NOTE: components can only be added when an entity is created, so it is created again.
+		remove_loaded_entity(old_entity.id);
+		const GAME_ENTITY::entity entity{ create_level_entity(new_entity) };
+		new_entity.id = entity.get_id();
+		return entity.is_valid();
+	}
+
+	if (memcmp(&old_entity.transform[0], &new_entity.transform[0], sizeof(new_entity.transform))) {
+		set_transform_info(&new_entity.transform[0], &new_entity.transform[3], &new_entity.transform[6]);
+		const TRANSFORM::component transform{ GAME_ENTITY::entity{ old_entity.id }.transform() };
+		transform.set_position(MATH::v3{ &transform_info.position[0] });
+		transform.set_rotation(MATH::v4{ &transform_info.rotation[0] });
+		transform.set_scale(MATH::v3{ &transform_info.scale[0] });
+	}
+	return true;
+}
+
+// Applies a changed world section to the live world: entities that are new in the file are created, the ones that
+// are gone are removed, and only the changed ones are updated.
+bool apply_level_changes(const u8* const data, const section_table& sections, level_file& level) {
+	game_columns columns{};
+	if (!read_game_columns(data, sections, columns) || !resolve_game_scripts(data, sections, columns)) return false;
+
+	UTL::vector<level_entity> entities;
+	entities.reserve(columns.num_entities);
+	u32 script_index{ 0 };
+	for (u32 i{ 0 }; i < columns.num_entities; ++i) {
+		SCRIPT::DETAIL::script_creator script{ nullptr };
+		if (!(columns.components[i] & transform_bit) || !get_entity_script(columns, columns.components[i], script_index, script))
+			return false;
+		entities.emplace_back(make_level_entity(columns, i, script));
+	}
+	// nothing has been changed yet, so a broken file leaves the world as it is.
+	if (script_index != columns.num_scripts || !sort_level_entities(entities)) return false;
+
+	bool result{ true };
+	const UTL::vector<level_entity>& old_entities{ level.entities };
+	u32 old_index{ 0 };
+	for (auto& e : entities) {
+		for (; old_index < old_entities.size() && old_entities[old_index].key < e.key; ++old_index) {
+			if (GAME_ENTITY::is_alive(old_entities[old_index].id)) remove_loaded_entity(old_entities[old_index].id);
+		}
+
+		if (old_index < old_entities.size() && old_entities[old_index].key == e.key) {
+			result &= update_level_entity(old_entities[old_index++], e);
+		}
+		else {
+			const GAME_ENTITY::entity entity{ create_level_entity(e) };
+			e.id = entity.get_id();
+			result &= entity.is_valid();
+		}
+	}
+	for (; old_index < old_entities.size(); ++old_index) {
+		if (GAME_ENTITY::is_alive(old_entities[old_index].id)) remove_loaded_entity(old_entities[old_index].id);
+	}
+
+	level.entities.swap(entities);
+	return result;
+}
+
+// Creates the entities of a file that passed validate_game_file(), and records them in 'level' for hot reload.
+bool load_game_v2(const u8* const data, const section_table& sections, level_file* const level) {
+	game_columns columns{};
+	if (!read_game_columns(data, sections, columns)) return false;
+	const u32 num_entities{ columns.num_entities };
+
+	UTL::vector<SCRIPT::DETAIL::script_creator> scripts(num_entities);
+	{
+		PROFILE_SCOPE("Load scripts");
+		const phaseTimer timer{ stats.scripts_ms };
+		if (!resolve_game_scripts(data, sections, columns)) return false;
+
+		u32 script_index{ 0 };
+		for (u32 i{ 0 }; i < num_entities; ++i) {
+			if (!(columns.components[i] & transform_bit) || !get_entity_script(columns, columns.components[i], script_index, scripts[i]))
+				return false;
+		}
+		// nothing has been created yet, so a broken file doesn't leave half a level behind.
+		if (script_index != columns.num_scripts) return false;
+	}
+
+	UTL::vector<MATH::v4> rotations(num_entities);
+	{
+		PROFILE_SCOPE("Load transforms");
+		const phaseTimer timer{ stats.transforms_ms };
+		euler_to_quaternions(columns.rotations, rotations.data(), num_entities);
+	}
+
+	PROFILE_SCOPE("Create entities");
+	const phaseTimer timer{ stats.create_ms };
+	// NOTE: the position and scale columns are stored as they are kept in memory, so they are used in place.
+	GAME_ENTITY::batch_info batch{};
+	batch.positions = reinterpret_cast<const MATH::v3*>(columns.positions);
+	batch.rotations = rotations.data();
+	batch.scales = reinterpret_cast<const MATH::v3*>(columns.scales);
+	batch.scripts = scripts.data();
+	batch.count = num_entities;
+	UTL::vector<GAME_ENTITY::entity> entities(num_entities);
+	const u32 created{ GAME_ENTITY::create(batch, entities.data()) };
+	for (u32 i{ 0 }; i < created; ++i) {
+		add_loaded_entity(entities[i]);
+	}
+
+	if (level) {
+		level->entities.reserve(level->entities.size() + created);
+		for (u32 i{ 0 }; i < created; ++i) {
+			level->entities.emplace_back(make_level_entity(columns, i, scripts[i])).id = entities[i].get_id();
+		}
+	}
+	stats.entities += created;
+
+	if (level) level->is_reloadable = sort_level_entities(level->entities);
+	return created == num_entities;
+}
+
+bool is_game_file_v2(const u8* const data, u64 size) {
+	// NOTE: files written before v2 start with the entity count instead of the magic number.
+	u32 magic{ 0 };
+	if (size >= sizeof(magic)) memcpy(&magic, data, sizeof(magic));
+	return magic == game_file_magic;
+}
+
+// A section is parsed where it is: in the mapped file, in the mapped package or in memory read from the package.
+struct loaded_section {
+	PLATFORM::mappedFile	file;
+	UTL::vector<u8>			buffer;
+	const u8*				data{ nullptr };	// in 'file' or 'buffer', or in a package that stays open until it is loaded
+	u64						size{ 0 };
+	section_table			sections{};			// v2 only, points into data
+	u64						source{ 0 };		// level_source_key() of the file
+	f64						read_ms{ 0.0 };		// added to the load_stats on the main thread
+	f64						validate_ms{ 0.0 };
+	bool					is_valid{ false };
+};
+
+// Read and checked on the streaming thread, waiting for the main thread to create their entities.
+UTL::vector<loaded_section>	loaded_sections;
+std::mutex					loaded_sections_mutex;
+
+// Checks a section and queues it for update_streamed_sections().
+void add_loaded_section(loaded_section&& section) {
+	if (!section.size) {
+		section.is_valid = false;
+	}
+	else if (section.is_valid && is_game_file_v2(section.data, section.size)) {
+		PROFILE_SCOPE("Load validate");
+		const phaseTimer timer{ section.validate_ms };
+		section.is_valid = validate_game_file(section.data, section.size, section.sections);
+	}
+
+	std::lock_guard lock{ loaded_sections_mutex };
+	loaded_sections.emplace_back(std::move(section));
+}
+
+struct section_request {
+	u64								source;
+	bool*							is_delivered;
+	phaseTimer::clock::time_point	submit_time;
+};
+
+// Runs on a job worker, so the main thread only has to create the entities.
+void on_world_section_loaded(STREAMING::request_result& result) {
+	MEMORY_TAG(content);
+	PROFILE_FUNCTION();
+	const std::unique_ptr<section_request> request{ static_cast<section_request*>(result.user_data) };
+	if (result.state == STREAMING::request_state::cancelled) return;
+
+	loaded_section section{};
+	section.file = std::move(result.file);
+	section.data = section.file.data();
+	section.size = section.file.size();
+	section.source = request->source;
+	section.read_ms = phaseTimer::elapsed_ms(request->submit_time);
+	section.is_valid = result.state == STREAMING::request_state::completed;
+	add_loaded_section(std::move(section));
+	if (request->is_delivered) {
+		*request->is_delivered = true;
+	}
+}
+
+STREAMING::request_id submit_world_section(const std::filesystem::path& path, STREAMING::request_priority priority, bool* is_delivered) {
+	STREAMING::request_info info{};
+	info.path = path;
+	info.priority = priority;
+	info.callback = on_world_section_loaded;
+	// the section is validated and its columns are used in place, so it is mapped rather than copied.
+	info.is_mapped = true;
+	// NOTE: the callback is called once for every request, also cancelled ones, and frees it.
+	const u64 source{ level_source_key(path) };
+	section_paths[source] = path;
+	info.user_data = new section_request{ source, is_delivered, phaseTimer::clock::now() };
+	return STREAMING::submit(info);
+}
+
+PLATFORM::fileWatcher						hot_reload_watcher;
+std::vector<std::filesystem::path>			changed_files;
+bool										is_reloading_all{ false };	// the watcher lost changes, every file may have changed
+std::chrono::steady_clock::time_point		last_change_time;
+// editors and tools write a file in several steps, it is only read once it didn't change for this long.
+constexpr std::chrono::milliseconds			hot_reload_delay{ 200 };
+
+bool read_file(const std::filesystem::path& path, UTL::vector<u8>& data) {
+	std::ifstream file{ path, std::ios::in | std::ios::binary | std::ios::ate };
+	if (!file) return false;
+
+	const u64 size{ (u64)file.tellg() };
+	data.resize(size);
+	file.seekg(0);
+	return size == 0 || (bool)file.read(reinterpret_cast<char*>(data.data()), size);
+}
+
+} // namespace anonymous
+
+STREAMING::request_id stream_world_section(const std::filesystem::path& path, STREAMING::request_priority priority) {
+	return submit_world_section(path, priority, nullptr);
+}
+
+bool update_streamed_sections() {
+	UTL::vector<loaded_section> sections;
+	{
+		std::lock_guard lock{ loaded_sections_mutex };
+		if (loaded_sections.empty()) return true;
+		sections.swap(loaded_sections);
+	}
+
+	MEMORY_TAG(content);
+	PROFILE_FUNCTION();
+	bool result{ true };
+	for (const auto& section : sections) {
+		stats.bytes += section.size;
+		stats.read_ms += section.read_ms;
+		stats.validate_ms += section.validate_ms;
+		++stats.sections;
+		if (!section.is_valid) {
+			result = false;
+			continue;
+		}
+		// NOTE: v1 files can't be hot reloaded, the editor doesn't write them anymore.
+		const bool is_loaded{ is_game_file_v2(section.data, section.size) ?
+			load_game_v2(section.data, section.sections, &level_files[section.source]) :
+			load_game_v1(section.data, section.size) };
+		result &= is_loaded;
+	}
+	return result;
+}
+
+bool load_game() {
+	MEMORY_TAG(content);
+	PROFILE_FUNCTION();
+	// set the working directory to the executable path
+	//wchar_t path[MAX_PATH];
+	//const u32 length{ GetModuleFileName(0, &path[0], MAX_PATH) };
+	//if (!length || GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+	//	return false; 
+
+	//std::filesystem::path p{ path };
+	//SetCurrentDirectory(p.parent_path().wstring().c_str());
+
+	// packaged builds read the level from game.wpak, which is already mapped, so it isn't streamed.
+	{
+		assetPackage package{};
+		const u64 name{ pack_name_hash("game.bin") };
+		if (package.open("game.wpak") && package.contains(name)) {
+			loaded_section section{};
+			section.source = level_source_key("game.bin");
+			{
+				const phaseTimer timer{ section.read_ms };
+				// NOTE: an uncompressed level is parsed where it is mapped, the package stays open until it is loaded.
+				//		 view() skips the CRC of the blob, v2 files are checked by validate_game_file() instead.
+				const pack_view view{ package.view(name) };
+				if (view.data) {
+					section.data = view.data;
+					section.size = view.size;
+					section.is_valid = true;
+				}
+				else {
+					section.is_valid = package.read(name, section.buffer);
+					section.data = section.buffer.data();
+					section.size = section.buffer.size();
+				}
+			}
+			add_loaded_section(std::move(section));
+			return update_streamed_sections();
+		}
+	}
+
+	// the level is the first world section, the game can't start without it.
+	// NOTE: the request is cancelled, and not delivered, when the streaming system isn't running.
+	bool is_delivered{ false };
+	const STREAMING::request_id request{ submit_world_section("game.bin", STREAMING::request_priority::critical, &is_delivered) };
+	STREAMING::wait(request);
+	return is_delivered && update_streamed_sections();
+}
+
 void unload_game() {
-	for (auto& entity : entities) {
-		GAME_ENTITY::remove(entity.get_id());
+	{
+		// sections that finished loading after the last update are dropped.
+		std::lock_guard lock{ loaded_sections_mutex };
+		loaded_sections.clear();
+	}
+	level_files.clear();
+	section_paths.clear();
+
+	// NOTE: remove all live entities rather than the ones we loaded,
+	//		 the world may have been replaced by a snapshot in the meantime.
+	UTL::vector<GAME_ENTITY::entity_id> ids;
+	ids.reserve(GAME_ENTITY::count<TRANSFORM::component>());
+	GAME_ENTITY::for_each<TRANSFORM::component>([&ids](GAME_ENTITY::entity entity, TRANSFORM::component) {
+		ids.emplace_back(entity.get_id());
+		});
+
+	for (const auto id : ids) {
+		remove_loaded_entity(id);
+	}
+}
+
+load_stats get_load_stats() {
+	return stats;
+}
+
+void reset_load_stats() {
+	stats = {};
+}
+
+bool reload_world_section(const std::filesystem::path& path) {
+	MEMORY_TAG(content);
+	PROFILE_FUNCTION();
+	const auto level{ level_files.find(level_source_key(path)) };
+	if (level == level_files.end() || !level->second.is_reloadable) return false;
+
+	UTL::vector<u8> data;
+	section_table sections{};
+	if (!read_file(path, data) || !is_game_file_v2(data.data(), data.size()) || !validate_game_file(data.data(), data.size(), sections))
+		return false;
+	return apply_level_changes(data.data(), sections, level->second);
+}
+
+bool start_hot_reload(const std::filesystem::path& directory) {
+	changed_files.clear();
+	is_reloading_all = false;
+	return hot_reload_watcher.open(directory);
+}
+
+void stop_hot_reload() {
+	hot_reload_watcher.close();
+	changed_files.clear();
+	is_reloading_all = false;
+}
+
+bool update_hot_reload() {
+	const auto now{ std::chrono::steady_clock::now() };
+	const PLATFORM::watch_result watched{ hot_reload_watcher.poll(changed_files) };
+	if (watched != PLATFORM::watch_result::unchanged) {
+		last_change_time = now;
+	}
+	is_reloading_all |= watched == PLATFORM::watch_result::overflow;
+	if ((changed_files.empty() && !is_reloading_all) || now - last_change_time < hot_reload_delay) return true;
+
+	bool result{ true };
+	if (is_reloading_all) {
+		// NOTE: we don't know which files changed, so every loaded world section and resource is read again.
+		for (const auto& [source, level] : level_files) {
+			const auto path{ section_paths.find(source) };
+			if (path != section_paths.end()) result &= reload_world_section(path->second);
+		}
+		RESOURCES::reload_all();
+		changed_files.clear();
+		is_reloading_all = false;
+		return result;
+	}
+
+	for (const auto& path : changed_files) {
+		if (level_files.count(level_source_key(path))) {
+			result &= reload_world_section(path);
+		}
+		else {
+			RESOURCES::reload(path);
+		}
 	}
+	changed_files.clear();
+	return result;
 }
 
-bool load_engine_shaders(std::unique_ptr<u8[]>& shaders, u64& size) {
-	auto path = GRAPHICS::get_engine_shaders_path();
-	return read_file(path, shaders, size);
+bool load_engine_shaders(PLATFORM::mappedFile& shaders) {
+	return shaders.open(GRAPHICS::get_engine_shaders_path());
 }
 
 }
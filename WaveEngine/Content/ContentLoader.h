@@ -1,5 +1,7 @@
 #pragma once
 #include "CommonHeaders.h"
+#include "..\Platform\MappedFile.h"
+#include "Streaming.h"
 
 #if !defined(SHIPPING)
 
@@ -7,9 +9,50 @@ namespace WAVEENGINE::CONTENT {
 
 bool load_game();
 
+// Reads a file in the game.bin format on the streaming thread. Its entities are created by the next
+// update_streamed_sections() after it is loaded.
+STREAMING::request_id stream_world_section(const std::filesystem::path& path,
+										   STREAMING::request_priority priority = STREAMING::request_priority::normal);
+
+// Creates the entities of the world sections that finished loading. Called once per frame on the main thread.
+// Returns false if a section couldn't be read or is corrupt.
+bool update_streamed_sections();
+
 void unload_game();
 
-bool load_engine_shaders(std::unique_ptr<u8[]>& shaders, u64& size);
+// Time spent in each phase of loading world sections, summed over all sections since reset_load_stats().
+// Also shown in the profiler as "Load ..." scopes.
+struct load_stats {
+	u64 bytes;
+	u32 sections;
+	u32 entities;
+	f64 read_ms;			// from submitting the read until the data arrived, includes waiting in the queue
+	f64 validate_ms;		// header, section table and CRC checks
+	f64 scripts_ms;			// hashing the script names and looking up their creators
+	f64 transforms_ms;		// converting the euler angles to quaternions
+	f64 create_ms;			// creating the entities and their components
+};
+
+load_stats get_load_stats();
+void reset_load_stats();
+
+// Applies the changes of a world section file that was loaded before to the live world. Only the entities that
+// changed are created, removed or updated, matched by the ids the editor gave them.
+// Returns false if the file wasn't loaded before, or can't be read or applied.
+bool reload_world_section(const std::filesystem::path& path);
+
+// Watches the directory and its subdirectories for changed files. World sections that change are applied with
+// reload_world_section(), other files are reloaded by the resource cache. If the watcher loses changes, all loaded
+// world sections and resources are reloaded.
+bool start_hot_reload(const std::filesystem::path& directory = ".");
+void stop_hot_reload();
+
+// Applies the files that changed since the last update. Called once per frame on the main thread.
+// Returns false if a changed world section couldn't be applied.
+bool update_hot_reload();
+
+// Maps the compiled engine shaders of the current graphics platform.
+bool load_engine_shaders(PLATFORM::mappedFile& shaders);
 
 }
 
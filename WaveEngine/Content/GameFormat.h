@@ -0,0 +1,61 @@
+#pragma once
+#include "CommonHeaders.h"
+
+namespace WAVEENGINE::CONTENT {
+
+/*
+ * [game.bin v2 format]
+ * header
+ * section table (header.section_count entries)
+ * sections, each starting at a 16 byte aligned offset
+ *
+ * Columns hold one element per entity that has the component, in entity order.
+ * All values are little endian.
+ */
+
+constexpr u32 game_file_magic{ 'W' | ('G' << 8) | ('A' << 16) | ('M' << 24) };
+constexpr u16 game_file_version{ 2 };
+constexpr u64 game_section_alignment{ 16 };
+
+enum class game_section : u32 {
+	entities,				// u32 per entity: bit i is set if the entity has component_type i
+	transform_positions,	// f32 x 3 per transform
+	transform_rotations,	// f32 x 3 per transform, euler angles in radians
+	transform_scales,		// f32 x 3 per transform
+	script_names,			// u32 per script: index into the string table
+	strings,				// u32 offset per string (from the start of the section), then zero terminated UTF-8 strings
+	entity_ids,				// u64 per entity: the editor's id of the entity, which doesn't change when the level is exported again
+
+	count
+};
+
+// bits of the entities section, the same values as the component types of the v1 format
+enum class game_component : u32 {
+	transform,
+	script,
+
+	count
+};
+
+struct game_file_header {
+	u32 magic;
+	u16 version;
+	u16 section_count;
+	u32 flags;				// reserved, 0
+	u32 reserved;
+	u64 hash;				// UTL::fnv1a_64 of the section table, which includes the CRC of every section
+	u64 file_size;
+};
+static_assert(sizeof(game_file_header) == 32);
+
+struct game_section_entry {
+	game_section	id;
+	u32				crc;			// UTL::crc32 of the section's data
+	u64				offset;			// from the start of the file
+	u64				size;			// in bytes
+	u32				count;			// number of elements (entities, transforms, scripts or strings)
+	u32				stride;			// size of one element, 0 if the elements have different sizes
+};
+static_assert(sizeof(game_section_entry) == 32);
+
+}
@@ -0,0 +1,140 @@
+#include "MeshLoader.h"
+#include "..\Utilities\IOStream.h"
+#include "..\Utilities\FreeList.h"
+
+namespace WAVEENGINE::CONTENT {
+
+namespace {
+
+struct geometry {
+	geometry_info		info;
+	UTL::vector<u8>		data;		// empty if the caller keeps the blob
+};
+
+UTL::freeList<geometry>		geometries;
+UTL::freeList<mesh_view>	meshes;
+
+/*
+ * [pack_data format]
+ * scene name length, scene name
+ * number of LODs
+ * for each LOD:
+ *   LOD name length, LOD name
+ *   number of meshes
+ *   for each mesh:
+ *     mesh name length, mesh name
+ *     LOD id, element size, elements type, number of vertices, index size, number of indices, LOD threshold
+ *     position buffer, element buffer, index buffer
+ */
+
+bool read_mesh(UTL::checkedReader& reader, mesh_view& mesh) {
+	mesh.name = reader.read_string();
+	mesh.lod_id = reader.read_u32();
+	mesh.element_size = reader.read_u32();
+	mesh.elements_type = reader.read_u32();
+	mesh.vertex_count = reader.read_u32();
+	mesh.index_size = reader.read_u32();
+	mesh.index_count = reader.read_u32();
+	mesh.lod_threshold = reader.read_f32();
+	if (!reader.is_valid() || (mesh.index_size != sizeof(u16) && mesh.index_size != sizeof(u32)))
+		return false;
+
+	mesh.positions = reader.take(mesh.position_buffer_size());
+	mesh.elements = reader.take(mesh.element_buffer_size());
+	mesh.indices = reader.take(mesh.index_buffer_size());
+	return reader.is_valid();
+}
+
+void remove_meshes(const geometry_info& info) {
+	for (const auto& lod : info.lods) {
+		for (const mesh_id id : lod.meshes) {
+			meshes.remove((u32)id);
+		}
+	}
+}
+
+constexpr u64 align_offset(u64 offset) {
+	return (offset + mesh_staging_alignment - 1) & ~(mesh_staging_alignment - 1);
+}
+
+} // anonymous namespace
+
+geometry_id add_geometry(const u8* data, u64 size) {
+	MEMORY_TAG(geometry);
+	if (!data || !size) return geometry_id{ ID::invalid_id };
+
+	UTL::checkedReader reader{ data, size };
+	geometry g{};
+	g.info.name = reader.read_string();
+	const u32 num_lods{ reader.read_u32() };
+	// NOTE: every LOD takes at least 8 bytes, don't let a corrupt count reserve gigabytes.
+	if (!reader.can_read((u64)num_lods * 2 * sizeof(u32))) return geometry_id{ ID::invalid_id };
+	g.info.lods.reserve(num_lods);
+
+	bool is_valid{ true };
+	for (u32 lod_index{ 0 }; lod_index < num_lods && is_valid; ++lod_index) {
+		geometry_lod& lod{ g.info.lods.emplace_back() };
+		lod.name = reader.read_string();
+		const u32 num_meshes{ reader.read_u32() };
+		is_valid = reader.can_read(num_meshes);
+
+		for (u32 mesh_index{ 0 }; mesh_index < num_meshes && is_valid; ++mesh_index) {
+			mesh_view mesh{};
+			is_valid = read_mesh(reader, mesh);
+			if (is_valid) {
+				lod.meshes.emplace_back(mesh_id{ meshes.add(mesh) });
+			}
+		}
+	}
+
+	if (!is_valid || !reader.is_at_end()) {
+		remove_meshes(g.info);
+		return geometry_id{ ID::invalid_id };
+	}
+	return geometry_id{ geometries.add(std::move(g)) };
+}
+
+geometry_id add_geometry(UTL::vector<u8>&& data) {
+	const geometry_id id{ add_geometry(data.data(), data.size()) };
+	if (ID::is_valid(id)) {
+		// NOTE: moving the vector keeps its buffer, so the meshes still point into it.
+		geometries[(u32)id].data = std::move(data);
+	}
+	return id;
+}
+
+void remove_geometry(geometry_id id) {
+	assert(ID::is_valid(id));
+	remove_meshes(geometries[(u32)id].info);
+	geometries.remove((u32)id);
+}
+
+const geometry_info& get_geometry(geometry_id id) {
+	assert(ID::is_valid(id));
+	return geometries[(u32)id].info;
+}
+
+const mesh_view& get_mesh(mesh_id id) {
+	assert(ID::is_valid(id));
+	return meshes[(u32)id];
+}
+
+mesh_staging_layout get_staging_layout(mesh_id id, u64 offset) {
+	const mesh_view& mesh{ get_mesh(id) };
+	mesh_staging_layout layout{};
+	layout.position_offset = align_offset(offset);
+	layout.element_offset = align_offset(layout.position_offset + mesh.position_buffer_size());
+	layout.index_offset = align_offset(layout.element_offset + mesh.element_buffer_size());
+	layout.end = layout.index_offset + mesh.index_buffer_size();
+	return layout;
+}
+
+void copy_to_staging(mesh_id id, const mesh_staging_layout& layout, u8* const staging) {
+	assert(staging);
+	const mesh_view& mesh{ get_mesh(id) };
+	memcpy(staging + layout.position_offset, mesh.positions, mesh.position_buffer_size());
+	memcpy(staging + layout.element_offset, mesh.elements, mesh.element_buffer_size());
+	memcpy(staging + layout.index_offset, mesh.indices, mesh.index_buffer_size());
+}
+
+}
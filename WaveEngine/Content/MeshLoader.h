@@ -0,0 +1,68 @@
+#pragma once
+#include "CommonHeaders.h"
+#include <string_view>
+
+namespace WAVEENGINE::CONTENT {
+
+DEFINE_TYPED_ID(geometry_id);
+DEFINE_TYPED_ID(mesh_id);
+
+// One mesh of a TOOLS::pack_data() blob. The buffers point into the blob, so they are not aligned.
+struct mesh_view {
+	std::string_view	name;
+	u32					lod_id;
+	u32					elements_type;		// TOOLS::ELEMENTS::elements_type
+	u32					element_size;		// bytes per vertex in 'elements', 0 for meshes that only have positions
+	u32					vertex_count;
+	u32					index_size;			// 2 or 4 bytes
+	u32					index_count;
+	f32					lod_threshold;
+	const u8*			positions;			// MATH::v3 per vertex
+	const u8*			elements;
+	const u8*			indices;
+
+	constexpr u64 position_buffer_size() const { return (u64)vertex_count * sizeof(MATH::v3); }
+	constexpr u64 element_buffer_size() const { return (u64)vertex_count * element_size; }
+	constexpr u64 index_buffer_size() const { return (u64)index_count * index_size; }
+};
+
+struct geometry_lod {
+	std::string_view		name;
+	UTL::vector<mesh_id>	meshes;
+};
+
+struct geometry_info {
+	std::string_view			name;
+	UTL::vector<geometry_lod>	lods;
+};
+
+// Where the buffers of a mesh go in a staging buffer. Several meshes can share one staging buffer
+// by passing the previous layout's 'end' as the offset of the next one.
+struct mesh_staging_layout {
+	u64 position_offset;
+	u64 element_offset;
+	u64 index_offset;
+	u64 end;
+};
+
+constexpr u64 mesh_staging_alignment{ 16 };
+
+// Parses a pack_data() blob and registers its meshes. The vertex and index data isn't copied, so 'data' must
+// stay valid until the geometry is removed. Returns an invalid id if the blob is malformed.
+geometry_id add_geometry(const u8* data, u64 size);
+
+// Same as above, but the geometry keeps the blob until it is removed.
+geometry_id add_geometry(UTL::vector<u8>&& data);
+
+// Removes the geometry and all of its meshes.
+void remove_geometry(geometry_id id);
+
+const geometry_info& get_geometry(geometry_id id);
+const mesh_view& get_mesh(mesh_id id);
+
+mesh_staging_layout get_staging_layout(mesh_id id, u64 offset = 0);
+
+// Copies the mesh's buffers to where 'layout' puts them in 'staging', which is at least layout.end bytes.
+void copy_to_staging(mesh_id id, const mesh_staging_layout& layout, u8* const staging);
+
+}
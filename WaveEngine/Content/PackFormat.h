@@ -0,0 +1,68 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "..\Utilities\Hash.h"
+
+namespace WAVEENGINE::CONTENT {
+
+/*
+ * [.wpak format]
+ * header
+ * entry table (header.entry_count entries, sorted by name hash)
+ * blob table (header.blob_count entries)
+ * blobs, each starting at a pack_blob_alignment aligned offset,
+ *        or pack_page_alignment for large uncompressed blobs so they can be paged in and out on their own
+ *
+ * Several entries point to the same blob when their files have the same content.
+ * Blobs that get at least 1/8 smaller are stored as UTL::lz_compress_frame() frames without a checksum.
+ * All values are little endian.
+ */
+
+constexpr u32 pack_file_magic{ 'W' | ('P' << 8) | ('A' << 16) | ('K' << 24) };
+constexpr u16 pack_file_version{ 2 };
+constexpr u64 pack_blob_alignment{ 16 };
+constexpr u64 pack_page_alignment{ 4096 };
+constexpr u64 pack_page_aligned_size{ 64 * 1024 };		// uncompressed blobs from this size on are page aligned
+
+enum class pack_compression : u32 {
+	none,
+	lz,						// UTL::lz_compress_frame()
+
+	count
+};
+
+struct pack_file_header {
+	u32 magic;
+	u16 version;
+	u16 flags;				// reserved, 0
+	u32 entry_count;
+	u32 blob_count;
+	u64 entries_offset;
+	u64 blobs_offset;
+	u64 file_size;
+	u64 hash;				// UTL::fnv1a_64 of the entry and blob tables
+};
+static_assert(sizeof(pack_file_header) == 48);
+
+struct pack_entry {
+	u64 name_hash;			// pack_name_hash() of the name the file was added with
+	u32 blob;				// index into the blob table
+	u32 reserved;
+};
+static_assert(sizeof(pack_entry) == 16);
+
+struct pack_blob {
+	u64					offset;			// from the start of the file
+	u64					size;			// stored size
+	u64					original_size;	// size after decompression, equal to size if not compressed
+	u64					content_hash;	// UTL::fnv1a_64 of the original data
+	u32					crc;			// UTL::crc32 of the stored data
+	pack_compression	compression;
+};
+static_assert(sizeof(pack_blob) == 40);
+
+// Names are case sensitive and use '/' as separator, e.g. "geometry/rock.mesh".
+inline u64 pack_name_hash(const char* const name) {
+	return UTL::fnv1a_64(name, strlen(name));
+}
+
+}
@@ -0,0 +1,357 @@
+#include "ResourceCache.h"
+#include "..\Utilities\Hash.h"
+#include "..\Core\Profiler.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace WAVEENGINE::RESOURCES {
+
+namespace {
+
+constexpr u32 no_resource{ u32_invalid_id };
+
+struct resource {
+	std::filesystem::path		path;
+	resource_type				type;
+	resource_state				state;
+	u32							ref_count;
+	STREAMING::request_id		request;		// the read in flight, reads of earlier loads are ignored
+	UTL::vector<u8>				data;			// blobs only, geometries keep their blob themselves
+	CONTENT::geometry_id		geometry;
+	u64							cpu_size;
+	u64							gpu_size;
+	u32							lru_prev;		// in the type's LRU list while resident and unreferenced
+	u32							lru_next;
+};
+
+struct type_cache {
+	u64				cpu_budget;
+	u64				gpu_budget;
+	u64				cpu_size;
+	u64				gpu_size;
+	u32				resident_count;
+	u32				lru_first;				// released the longest time ago, evicted first
+	u32				lru_last;
+	evict_callback	on_evict;
+};
+
+struct loaded_resource {
+	u32						index;
+	STREAMING::request_id	request;
+	STREAMING::request_state state;
+	UTL::vector<u8>			data;
+};
+
+// NOTE: resources are never removed, an evicted resource only keeps its path. This keeps the handles stable
+//		 and makes loading it again a lookup and a read. UTL::vector moves its items with realloc(),
+//		 which std::filesystem::path doesn't survive, so they are kept in a deque.
+UTL::deque<resource>					resources;
+std::unordered_multimap<u64, u32>		resources_by_key;
+type_cache								caches[(u32)resource_type::count]{
+	{ 256ull * 1024 * 1024, 0, 0, 0, 0, no_resource, no_resource, nullptr },			// blob
+	{ 512ull * 1024 * 1024, 1024ull * 1024 * 1024, 0, 0, 0, no_resource, no_resource, nullptr },	// geometry
+};
+
+// Written by the streaming callbacks, read by update().
+UTL::vector<loaded_resource>			loaded_resources;
+std::mutex								loaded_resources_mutex;
+
+resource& get_resource(resource_type type, ID::id_type id) {
+	assert(ID::is_valid(id) && id < resources.size() && resources[(u32)id].type == type);
+	return resources[(u32)id];
+}
+
+u64 resource_key(resource_type type, const std::filesystem::path& path) {
+	const std::string name{ path.generic_string() };
+	return UTL::fnv1a_64(name.data(), name.size(), UTL::fnv1a_64(&type, sizeof(type)));
+}
+
+void lru_unlink(u32 index) {
+	resource& r{ resources[index] };
+	type_cache& cache{ caches[(u32)r.type] };
+	(r.lru_prev != no_resource ? resources[r.lru_prev].lru_next : cache.lru_first) = r.lru_next;
+	(r.lru_next != no_resource ? resources[r.lru_next].lru_prev : cache.lru_last) = r.lru_prev;
+	r.lru_prev = r.lru_next = no_resource;
+}
+
+void lru_push(u32 index) {
+	resource& r{ resources[index] };
+	type_cache& cache{ caches[(u32)r.type] };
+	r.lru_prev = cache.lru_last;
+	r.lru_next = no_resource;
+	(cache.lru_last != no_resource ? resources[cache.lru_last].lru_next : cache.lru_first) = index;
+	cache.lru_last = index;
+}
+
+// Runs on a job worker. The resource is made resident on the main thread.
+void on_resource_loaded(STREAMING::request_result& result) {
+	MEMORY_TAG(content);
+	std::lock_guard lock{ loaded_resources_mutex };
+	loaded_resources.emplace_back(loaded_resource{
+		(u32)reinterpret_cast<uintptr_t>(result.user_data), result.id, result.state, std::move(result.data) });
+}
+
+void load(u32 index, STREAMING::request_priority priority) {
+	resource& r{ resources[index] };
+	assert(r.state != resource_state::loading && r.state != resource_state::resident);
+	r.state = resource_state::loading;
+
+	STREAMING::request_info info{};
+	info.path = r.path;
+	info.priority = priority;
+	info.callback = on_resource_loaded;
+	info.user_data = reinterpret_cast<void*>((uintptr_t)index);
+	// NOTE: the callback may run before submit() returns, but update() only sees it after r.request is set.
+	r.request = STREAMING::submit(info);
+}
+
+void unload(u32 index) {
+	resource& r{ resources[index] };
+	assert(r.state == resource_state::resident);
+	type_cache& cache{ caches[(u32)r.type] };
+	if (cache.on_evict) {
+		cache.on_evict(r.type, index);
+	}
+	if (r.type == resource_type::geometry) {
+		CONTENT::remove_geometry(r.geometry);
+		r.geometry = CONTENT::geometry_id{ ID::invalid_id };
+	}
+	r.data = UTL::vector<u8>{};
+
+	cache.cpu_size -= r.cpu_size;
+	cache.gpu_size -= r.gpu_size;
+	--cache.resident_count;
+	r.cpu_size = r.gpu_size = 0;
+	r.state = resource_state::unloaded;
+}
+
+void evict_over_budget(resource_type type) {
+	type_cache& cache{ caches[(u32)type] };
+	while ((cache.cpu_size > cache.cpu_budget || cache.gpu_size > cache.gpu_budget) && cache.lru_first != no_resource) {
+		const u32 index{ cache.lru_first };
+		lru_unlink(index);
+		unload(index);
+	}
+}
+
+bool make_resident(resource& r, UTL::vector<u8>&& data) {
+	const u64 size{ data.size() };
+	if (r.type == resource_type::geometry) {
+		r.geometry = CONTENT::add_geometry(std::move(data));
+		if (!ID::is_valid(r.geometry)) return false;
+	}
+	else {
+		r.data = std::move(data);
+	}
+
+	type_cache& cache{ caches[(u32)r.type] };
+	r.cpu_size = size;
+	cache.cpu_size += size;
+	++cache.resident_count;
+	r.state = resource_state::resident;
+	return true;
+}
+
+void process_loaded_resources() {
+	UTL::vector<loaded_resource> loaded;
+	{
+		std::lock_guard lock{ loaded_resources_mutex };
+		if (loaded_resources.empty()) return;
+		loaded.swap(loaded_resources);
+	}
+
+	MEMORY_TAG(content);
+	PROFILE_FUNCTION();
+	bool is_evicting[(u32)resource_type::count]{};
+	for (auto& l : loaded) {
+		resource& r{ resources[l.index] };
+		// the resource was cancelled, and maybe loaded again, since this read was submitted.
+		if (r.state != resource_state::loading || r.request != l.request) continue;
+		r.request = STREAMING::invalid_request;
+
+		if (l.state == STREAMING::request_state::cancelled) {
+			r.state = resource_state::unloaded;
+			continue;
+		}
+		if (l.state != STREAMING::request_state::completed || !make_resident(r, std::move(l.data))) {
+			r.state = resource_state::failed;
+			continue;
+		}
+		// nobody wants it anymore, but it was read already, so it is cached rather than thrown away.
+		if (!r.ref_count) {
+			lru_push(l.index);
+		}
+		is_evicting[(u32)r.type] = true;
+	}
+
+	for (u32 i{ 0 }; i < (u32)resource_type::count; ++i) {
+		if (is_evicting[i]) evict_over_budget((resource_type)i);
+	}
+}
+
+void reload_resource(u32 index) {
+	resource& r{ resources[index] };
+	if (r.state == resource_state::resident) {
+		if (!r.ref_count) lru_unlink(index);
+		unload(index);
+	}
+	else if (r.state == resource_state::loading) {
+		// the read may have started before the file was written, its data is ignored.
+		STREAMING::cancel(r.request);
+		r.state = resource_state::unloaded;
+		r.request = STREAMING::invalid_request;
+	}
+	if (r.ref_count) {
+		load(index, STREAMING::request_priority::high);
+	}
+}
+
+} // anonymous namespace
+
+namespace DETAIL {
+
+ID::id_type acquire(resource_type type, const std::filesystem::path& path, STREAMING::request_priority priority) {
+	MEMORY_TAG(content);
+	assert(type < resource_type::count);
+	const std::filesystem::path normal_path{ path.lexically_normal() };
+	const u64 key{ resource_key(type, normal_path) };
+
+	u32 index{ no_resource };
+	const auto range{ resources_by_key.equal_range(key) };
+	for (auto it{ range.first }; it != range.second; ++it) {
+		const resource& r{ resources[it->second] };
+		if (r.type == type && r.path == normal_path) {
+			index = it->second;
+			break;
+		}
+	}
+
+	if (index == no_resource) {
+		index = (u32)resources.size();
+		resources.emplace_back(resource{ normal_path, type, resource_state::unloaded, 0, STREAMING::invalid_request,
+			{}, CONTENT::geometry_id{ ID::invalid_id }, 0, 0, no_resource, no_resource });
+		resources_by_key.emplace(key, index);
+	}
+
+	resource& r{ resources[index] };
+	const bool was_referenced{ r.ref_count != 0 };
+	++r.ref_count;
+	if (r.state == resource_state::resident && !was_referenced) {
+		lru_unlink(index);
+	}
+	// failed resources are tried again once they were released, the file may have been fixed since.
+	else if (r.state == resource_state::unloaded || (r.state == resource_state::failed && !was_referenced)) {
+		load(index, priority);
+	}
+	return index;
+}
+
+void release(resource_type type, ID::id_type id) {
+	resource& r{ get_resource(type, id) };
+	assert(r.ref_count);
+	if (--r.ref_count) return;
+
+	if (r.state == resource_state::resident) {
+		lru_push((u32)id);
+		evict_over_budget(type);
+	}
+	else if (r.state == resource_state::loading && STREAMING::cancel(r.request)) {
+		r.state = resource_state::unloaded;
+		r.request = STREAMING::invalid_request;
+	}
+}
+
+resource_state get_state(resource_type type, ID::id_type id) {
+	return get_resource(type, id).state;
+}
+
+void wait(resource_type type, ID::id_type id) {
+	const resource& r{ get_resource(type, id) };
+	if (r.state != resource_state::loading) return;
+	STREAMING::wait(r.request);
+	process_loaded_resources();
+}
+
+void set_gpu_size(resource_type type, ID::id_type id, u64 size) {
+	resource& r{ get_resource(type, id) };
+	assert(r.state == resource_state::resident);
+	type_cache& cache{ caches[(u32)type] };
+	cache.gpu_size = cache.gpu_size - r.gpu_size + size;
+	r.gpu_size = size;
+	evict_over_budget(type);
+}
+
+} // namespace DETAIL
+
+blob_view get_blob(blob_handle handle) {
+	const resource& r{ get_resource(resource_type::blob, handle.get_id()) };
+	assert(r.state == resource_state::resident && r.ref_count);
+	return { r.data.data(), r.data.size() };
+}
+
+CONTENT::geometry_id get_geometry(geometry_handle handle) {
+	const resource& r{ get_resource(resource_type::geometry, handle.get_id()) };
+	assert(r.state == resource_state::resident && r.ref_count);
+	return r.geometry;
+}
+
+void set_budget(resource_type type, u64 cpu_bytes, u64 gpu_bytes) {
+	assert(type < resource_type::count);
+	caches[(u32)type].cpu_budget = cpu_bytes;
+	caches[(u32)type].gpu_budget = gpu_bytes;
+	evict_over_budget(type);
+}
+
+void set_evict_callback(resource_type type, evict_callback callback) {
+	assert(type < resource_type::count);
+	caches[(u32)type].on_evict = callback;
+}
+
+resource_usage get_usage(resource_type type) {
+	assert(type < resource_type::count);
+	const type_cache& cache{ caches[(u32)type] };
+	return { cache.cpu_size, cache.gpu_size, cache.cpu_budget, cache.gpu_budget, cache.resident_count };
+}
+
+void reload(const std::filesystem::path& path) {
+	const std::filesystem::path normal_path{ path.lexically_normal() };
+	for (u32 type{ 0 }; type < (u32)resource_type::count; ++type) {
+		const auto range{ resources_by_key.equal_range(resource_key((resource_type)type, normal_path)) };
+		for (auto it{ range.first }; it != range.second; ++it) {
+			const resource& r{ resources[it->second] };
+			if (r.type == (resource_type)type && r.path == normal_path) {
+				reload_resource(it->second);
+			}
+		}
+	}
+}
+
+void reload_all() {
+	for (u32 index{ 0 }; index < (u32)resources.size(); ++index) {
+		reload_resource(index);
+	}
+}
+
+void update() {
+	process_loaded_resources();
+}
+
+void shutdown() {
+	{
+		std::lock_guard lock{ loaded_resources_mutex };
+		loaded_resources.clear();
+	}
+
+	for (u32 i{ 0 }; i < resources.size(); ++i) {
+		if (resources[i].state == resource_state::resident) {
+			unload(i);
+		}
+	}
+	resources.clear();
+	resources_by_key.clear();
+	for (auto& cache : caches) {
+		cache.lru_first = cache.lru_last = no_resource;
+	}
+}
+
+}
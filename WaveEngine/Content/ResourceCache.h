@@ -0,0 +1,122 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "Streaming.h"
+#include "MeshLoader.h"
+#include <filesystem>
+
+namespace WAVEENGINE::RESOURCES {
+
+enum class resource_type : u32 {
+	blob,				// the file's bytes, for content that is used as it is stored
+	geometry,			// a TOOLS::pack_data() blob, see CONTENT::add_geometry()
+
+	count
+};
+
+enum class resource_state : u32 {
+	unloaded,			// never loaded, cancelled or evicted
+	loading,
+	resident,
+	failed,				// the file couldn't be read or is corrupt
+};
+
+// A resource of one type. Handles are acquired and released, and stay the same for a path while the
+// cache is running, also after the resource was evicted and loaded again.
+template<resource_type Type>
+class resource_handle {
+public:
+	constexpr resource_handle() = default;
+	constexpr explicit resource_handle(ID::id_type id) : _id{ id } {}
+	constexpr ID::id_type get_id() const { return _id; }
+	constexpr bool is_valid() const { return ID::is_valid(_id); }
+	constexpr bool operator==(const resource_handle& other) const { return _id == other._id; }
+
+private:
+	ID::id_type _id{ ID::invalid_id };
+};
+
+using blob_handle = resource_handle<resource_type::blob>;
+using geometry_handle = resource_handle<resource_type::geometry>;
+
+struct blob_view {
+	const u8*	data;
+	u64			size;
+};
+
+struct resource_usage {
+	u64 cpu_bytes;
+	u64 gpu_bytes;
+	u64 cpu_budget;
+	u64 gpu_budget;
+	u32 resident_count;
+};
+
+// Called before a resident resource is evicted, so the renderer can free its GPU copy.
+using evict_callback = void(*)(resource_type type, ID::id_type id);
+
+namespace DETAIL {
+ID::id_type acquire(resource_type type, const std::filesystem::path& path, STREAMING::request_priority priority);
+void release(resource_type type, ID::id_type id);
+resource_state get_state(resource_type type, ID::id_type id);
+void wait(resource_type type, ID::id_type id);
+void set_gpu_size(resource_type type, ID::id_type id, u64 size);
+}
+
+// All functions are called on the main thread. The files are read on the streaming thread, and become
+// resident in the next update() or wait() after they are loaded.
+
+// Returns the resource of the file and adds a reference to it. A path is loaded once, no matter how often it is acquired.
+// The resource starts loading if it isn't resident yet.
+template<resource_type Type>
+resource_handle<Type> acquire(const std::filesystem::path& path, STREAMING::request_priority priority = STREAMING::request_priority::normal) {
+	return resource_handle<Type>{ DETAIL::acquire(Type, path, priority) };
+}
+
+// Removes a reference. Resources without references stay resident until their type goes over budget,
+// then the least recently released ones are evicted first.
+template<resource_type Type>
+void release(resource_handle<Type> handle) {
+	DETAIL::release(Type, handle.get_id());
+}
+
+template<resource_type Type>
+resource_state get_state(resource_handle<Type> handle) {
+	return DETAIL::get_state(Type, handle.get_id());
+}
+
+// Blocks until the resource is resident or failed to load.
+template<resource_type Type>
+void wait(resource_handle<Type> handle) {
+	DETAIL::wait(Type, handle.get_id());
+}
+
+// The renderer reports how much GPU memory it used for a resident resource, which counts against the GPU budget.
+template<resource_type Type>
+void set_gpu_size(resource_handle<Type> handle, u64 size) {
+	DETAIL::set_gpu_size(Type, handle.get_id(), size);
+}
+
+// Only valid while the resource is resident and referenced.
+blob_view get_blob(blob_handle handle);
+CONTENT::geometry_id get_geometry(geometry_handle handle);
+
+// Evicts unreferenced resources until the type is within both budgets. Referenced resources are never evicted,
+// so a type goes over budget when its working set doesn't fit.
+void set_budget(resource_type type, u64 cpu_bytes, u64 gpu_bytes);
+void set_evict_callback(resource_type type, evict_callback callback);
+resource_usage get_usage(resource_type type);
+
+// Loads the resources of a file that changed on disk again. Resources without references are evicted, so the
+// next acquire() reads the new file. Referenced ones are loading until the new file is read, and their data has to
+// be fetched again after that, e.g. get_geometry() returns a new id.
+void reload(const std::filesystem::path& path);
+// Same as reload() for every resource, e.g. when the changed files aren't known.
+void reload_all();
+
+// Makes the loaded resources resident and evicts the ones over budget. Called once per frame.
+void update();
+
+// Unloads all resources, referenced or not. Call after STREAMING::shutdown(), so no reads are left.
+void shutdown();
+
+}
@@ -0,0 +1,345 @@
+#include "Streaming.h"
+#include "..\Core\JobSystem.h"
+#include "..\Core\Profiler.h"
+#include <thread>
+#include <condition_variable>
+
+#ifdef _WIN64
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WAVEENGINE::STREAMING {
+
+namespace {
+
+// Requests are read in chunks of this size, so cancelling a large request doesn't wait for the whole read.
+constexpr u64 read_chunk_size{ 1024 * 1024 };
+
+struct request {
+	request_id		id;
+	request_info	info;
+};
+
+struct completion {
+	request_result		result;
+	completion_callback	callback;
+	u64					size;			// bytes accounted to bytes_in_flight
+};
+
+UTL::deque<request>			queues[(u32)request_priority::count];
+UTL::vector<request_id>		pending_requests;		// submitted, and their callback hasn't returned yet
+request_id					reading_request{ invalid_request };
+bool						is_reading_cancelled{ false };
+request_id					next_request_id{ 1 };
+u64							in_flight{ 0 };
+u64							max_in_flight{ 0 };
+std::mutex					streaming_mutex;
+std::condition_variable		io_cv;					// wakes the I/O thread
+std::condition_variable		done_cv;				// a callback returned
+std::thread					io_thread;
+bool						is_running{ false };
+
+#ifdef _WIN64
+
+class file_reader {
+public:
+	explicit file_reader(const std::filesystem::path& path) {
+		_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	}
+	~file_reader() { if (is_valid()) CloseHandle(_file); }
+	DISABLE_COPY_AND_MOVE(file_reader);
+
+	bool is_valid() const { return _file != INVALID_HANDLE_VALUE; }
+
+	u64 size() const {
+		LARGE_INTEGER size{};
+		return GetFileSizeEx(_file, &size) ? (u64)size.QuadPart : 0;
+	}
+
+	bool read(u8* buffer, u64 offset, u64 size) const {
+		OVERLAPPED overlapped{};
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD bytes_read{ 0 };
+		return ReadFile(_file, buffer, (DWORD)size, &bytes_read, &overlapped) && bytes_read == size;
+	}
+
+private:
+	HANDLE _file{ INVALID_HANDLE_VALUE };
+};
+
+#else
+
+class file_reader {
+public:
+	explicit file_reader(const std::filesystem::path& path) : _file{ ::open(path.c_str(), O_RDONLY) } {}
+	~file_reader() { if (is_valid()) ::close(_file); }
+	DISABLE_COPY_AND_MOVE(file_reader);
+
+	bool is_valid() const { return _file >= 0; }
+
+	u64 size() const {
+		struct stat info {};
+		return fstat(_file, &info) ? 0 : (u64)info.st_size;
+	}
+
+	bool read(u8* buffer, u64 offset, u64 size) const {
+		while (size) {
+			const ssize_t bytes_read{ pread(_file, buffer, size, (off_t)offset) };
+			if (bytes_read <= 0) return false;
+			buffer += bytes_read;
+			offset += bytes_read;
+			size -= bytes_read;
+		}
+		return true;
+	}
+
+private:
+	int _file{ -1 };
+};
+
+#endif
+
+void run_completion(void* context, u32, u32) {
+	completion* const c{ static_cast<completion*>(context) };
+	if (c->callback) {
+		PROFILE_SCOPE("Streaming callback");
+		c->callback(c->result);
+	}
+
+	{
+		std::lock_guard lock{ streaming_mutex };
+		in_flight -= c->size;
+		const auto it{ std::find(pending_requests.begin(), pending_requests.end(), c->result.id) };
+		assert(it != pending_requests.end());
+		UTL::erase_unordered(pending_requests, it - pending_requests.begin());
+	}
+	// NOTE: the I/O thread may be waiting for the budget, and other threads for this request.
+	done_cv.notify_all();
+
+	// the data is freed, or the file unmapped, here unless the callback took it.
+	delete c;
+}
+
+completion* make_completion(const request& r, request_state state, UTL::vector<u8>&& data = {}, u64 size = 0) {
+	return new completion{ { r.id, state, std::move(data), r.info.user_data }, r.info.callback, size };
+}
+
+// Hands finished requests to the job system. 'size' must already be added to in_flight.
+// NOTE: must be called without holding streaming_mutex, because the job system
+//		 runs the callbacks on the calling thread when it has no workers.
+void deliver(completion* c) {
+	JOBS::submit(run_completion, c);
+}
+
+bool pop_request(request& r) {
+	for (auto& queue : queues) {
+		if (!queue.empty()) {
+			r = std::move(queue.front());
+			queue.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+// Reads the request into 'data'. Returns the state the request is completed with.
+request_state read_request(const request& r, UTL::vector<u8>& data) {
+	PROFILE_SCOPE("Read request");
+	const file_reader file{ r.info.path };
+	if (!file.is_valid()) return request_state::failed;
+
+	const u64 file_size{ file.size() };
+	if (r.info.offset > file_size) return request_state::failed;
+	const u64 size{ r.info.size ? r.info.size : file_size - r.info.offset };
+	if (size > file_size - r.info.offset) return request_state::failed;
+
+	{
+		// wait until the request fits in the budget, or nothing else is in flight.
+		std::unique_lock lock{ streaming_mutex };
+		done_cv.wait(lock, [size] { return !in_flight || in_flight + size <= max_in_flight || is_reading_cancelled; });
+		if (is_reading_cancelled) return request_state::cancelled;
+		in_flight += size;
+	}
+
+	data.resize(size);
+	for (u64 offset{ 0 }; offset < size; offset += read_chunk_size) {
+		{
+			std::lock_guard lock{ streaming_mutex };
+			if (is_reading_cancelled) return request_state::cancelled;
+		}
+		const u64 chunk_size{ (std::min)(read_chunk_size, size - offset) };
+		if (!file.read(data.data() + offset, r.info.offset + offset, chunk_size)) return request_state::failed;
+	}
+	return request_state::completed;
+}
+
+// Maps the file of the request and starts reading its pages. Returns the state the request is completed with.
+request_state map_request(const request& r, PLATFORM::mappedFile& file) {
+	PROFILE_SCOPE("Map request");
+	assert(!r.info.offset && !r.info.size);
+	if (!file.open(r.info.path)) return request_state::failed;
+
+	const u64 size{ file.size() };
+	{
+		// the prefetched pages count against the budget like read data, until the callback returns.
+		std::unique_lock lock{ streaming_mutex };
+		done_cv.wait(lock, [size] { return !in_flight || in_flight + size <= max_in_flight || is_reading_cancelled; });
+		if (is_reading_cancelled) {
+			file.close();
+			return request_state::cancelled;
+		}
+		in_flight += size;
+	}
+
+	// NOTE: the callback parses the file once, front to back, on a job worker that shouldn't wait for page faults.
+	file.advise(PLATFORM::access_pattern::sequential);
+	file.advise(PLATFORM::access_pattern::will_need);
+	return request_state::completed;
+}
+
+void io_loop() {
+	PROFILE_THREAD("I/O");
+	MEMORY_TAG(content);
+	while (true) {
+		request r{};
+		{
+			std::unique_lock lock{ streaming_mutex };
+			io_cv.wait(lock, [&r] { return pop_request(r) || !is_running; });
+			if (!r.id) return; // shutting down and nothing left to read
+			reading_request = r.id;
+			is_reading_cancelled = false;
+		}
+
+		UTL::vector<u8> data;
+		PLATFORM::mappedFile file;
+		request_state state{ r.info.is_mapped ? map_request(r, file) : read_request(r, data) };
+		const u64 size{ data.size() + file.size() };
+
+		{
+			std::lock_guard lock{ streaming_mutex };
+			if (state == request_state::completed && is_reading_cancelled) {
+				state = request_state::cancelled;
+			}
+			reading_request = invalid_request;
+		}
+		if (state != request_state::completed) {
+			// NOTE: the budget was already taken if the data was allocated, run_completion() gives it back.
+			data.clear();
+			file.close();
+		}
+		completion* const c{ make_completion(r, state, std::move(data), size) };
+		c->result.file = std::move(file);
+		deliver(c);
+	}
+}
+
+} // anonymous namespace
+
+bool initialize(u64 max_bytes_in_flight) {
+	assert(!is_running && max_bytes_in_flight);
+	max_in_flight = max_bytes_in_flight;
+	is_running = true;
+	io_thread = std::thread{ io_loop };
+	return true;
+}
+
+void shutdown() {
+	UTL::vector<completion*> cancelled;
+	{
+		std::lock_guard lock{ streaming_mutex };
+		is_running = false;
+		is_reading_cancelled = reading_request != invalid_request;
+		for (auto& queue : queues) {
+			for (const auto& r : queue) {
+				cancelled.emplace_back(make_completion(r, request_state::cancelled));
+			}
+			queue.clear();
+		}
+	}
+	for (completion* c : cancelled) {
+		deliver(c);
+	}
+	io_cv.notify_one();
+	done_cv.notify_all();
+	if (io_thread.joinable()) {
+		io_thread.join();
+	}
+
+	std::unique_lock lock{ streaming_mutex };
+	done_cv.wait(lock, [] { return pending_requests.empty(); });
+	assert(!in_flight);
+}
+
+request_id submit(const request_info& info) {
+	assert(!info.path.empty() && info.priority < request_priority::count);
+	request r{ invalid_request, info };
+	bool is_queued{ false };
+	{
+		std::lock_guard lock{ streaming_mutex };
+		r.id = next_request_id++;
+		pending_requests.emplace_back(r.id);
+		if (is_running) {
+			queues[(u32)info.priority].emplace_back(r);
+			is_queued = true;
+		}
+	}
+
+	if (is_queued) {
+		io_cv.notify_one();
+	}
+	else {
+		deliver(make_completion(r, request_state::cancelled));
+	}
+	return r.id;
+}
+
+bool cancel(request_id id) {
+	completion* c{ nullptr };
+	{
+		std::lock_guard lock{ streaming_mutex };
+		if (id == reading_request) {
+			is_reading_cancelled = true;
+			// NOTE: the I/O thread may be waiting for the budget.
+			done_cv.notify_all();
+			return true;
+		}
+
+		for (auto& queue : queues) {
+			const auto it{ std::find_if(queue.begin(), queue.end(), [id](const request& r) { return r.id == id; }) };
+			if (it != queue.end()) {
+				c = make_completion(*it, request_state::cancelled);
+				queue.erase(it);
+				break;
+			}
+		}
+	}
+
+	if (!c) return false;
+	deliver(c);
+	return true;
+}
+
+void wait(request_id id) {
+	std::unique_lock lock{ streaming_mutex };
+	done_cv.wait(lock, [id] { return std::find(pending_requests.begin(), pending_requests.end(), id) == pending_requests.end(); });
+}
+
+bool is_pending(request_id id) {
+	std::lock_guard lock{ streaming_mutex };
+	return std::find(pending_requests.begin(), pending_requests.end(), id) != pending_requests.end();
+}
+
+u64 bytes_in_flight() {
+	std::lock_guard lock{ streaming_mutex };
+	return in_flight;
+}
+
+}
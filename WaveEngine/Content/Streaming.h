@@ -0,0 +1,72 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "..\Platform\MappedFile.h"
+#include <filesystem>
+
+namespace WAVEENGINE::STREAMING {
+
+// Requests with a higher priority are read first, requests with the same priority in the order they were submitted.
+enum class request_priority : u32 {
+	critical,			// something is waiting for it, e.g. the level at startup
+	high,				// needed in the next few frames
+	normal,
+	low,				// prefetching
+
+	count
+};
+
+enum class request_state : u32 {
+	queued,
+	reading,
+	completed,
+	failed,				// the file doesn't exist or couldn't be read
+	cancelled,
+};
+
+using request_id = u64;
+constexpr request_id invalid_request{ 0 };
+
+struct request_result {
+	request_id			id;
+	request_state		state;			// completed, failed or cancelled
+	UTL::vector<u8>		data;			// empty unless completed
+	void*				user_data;
+	PLATFORM::mappedFile	file;		// instead of 'data' for mapped requests, closed unless completed
+};
+
+// Called on a job worker when a request is finished. The data is freed, or the file unmapped, when the callback
+// returns, unless it is moved out of the result.
+using completion_callback = void(*)(request_result& result);
+
+struct request_info {
+	std::filesystem::path	path;
+	u64						offset{ 0 };
+	u64						size{ 0 };			// 0 reads to the end of the file
+	request_priority		priority{ request_priority::normal };
+	// maps the whole file and prefetches its pages on the I/O thread instead of reading it into memory,
+	// so the callback can parse it in place. Mapped requests can't have an offset or size.
+	bool					is_mapped{ false };
+	completion_callback		callback{ nullptr };
+	void*					user_data{ nullptr };
+};
+
+// Starts the I/O thread. Reads only start while less than 'max_bytes_in_flight' bytes are read or waiting
+// for their callbacks, except when nothing is in flight, so a single larger request still loads.
+bool initialize(u64 max_bytes_in_flight = 64ull * 1024 * 1024);
+
+// Cancels the queued requests, finishes the one being read and waits for all callbacks.
+void shutdown();
+
+// Queues a read. The callback is always called once, also when the request fails or is cancelled.
+request_id submit(const request_info& info);
+
+// Returns true if the request was cancelled before its data was delivered.
+bool cancel(request_id id);
+
+// Blocks until the callback of the request has returned. Returns right away for unknown or finished requests.
+void wait(request_id id);
+
+bool is_pending(request_id id);
+u64 bytes_in_flight();
+
+}
@@ -0,0 +1,113 @@
+#include "WorldSnapshot.h"
+#include "..\Components\Entity.h"
+#include "..\Components\Transform.h"
+#include "..\Components\Script.h"
+#include "..\Utilities\IOStream.h"
+#include <filesystem>
+
+namespace WAVEENGINE::CONTENT {
+
+namespace {
+
+constexpr u32 snapshot_magic{ 'W' | ('S' << 8) | ('N' << 16) | ('P' << 24) };
+constexpr u32 snapshot_version{ 1 };
+
+/*
+ * [Snapshot header]
+ * magic
+ * version
+ * size of ID::id_type
+ * size of the whole snapshot, including the header
+ */
+constexpr u64 header_size{ sizeof(u32) * 3 + sizeof(u64) };
+
+} // anonymous namespace
+
+u64 world_snapshot_size() {
+	return header_size + GAME_ENTITY::snapshot_size() + TRANSFORM::snapshot_size() + SCRIPT::snapshot_size();
+}
+
+/*
+ * [World snapshot format]
+ * header
+ * entities
+ * transforms
+ * scripts
+ */
+
+bool save_world_snapshot(u8* const buffer, u64 size) {
+	const u64 snapshot_size{ world_snapshot_size() };
+	assert(buffer && size >= snapshot_size);
+	if (!buffer || size < snapshot_size) return false;
+
+	UTL::blobStreamWriter writer{ buffer, size };
+	writer.write<u32>(snapshot_magic);
+	writer.write<u32>(snapshot_version);
+	writer.write<u32>(sizeof(ID::id_type));
+	writer.write<u64>(snapshot_size);
+
+	GAME_ENTITY::save_snapshot(writer);
+	TRANSFORM::save_snapshot(writer);
+	SCRIPT::save_snapshot(writer);
+
+	assert(writer.offset() == snapshot_size);
+	return true;
+}
+
+bool restore_world_snapshot(const u8* const buffer, u64 size) {
+	assert(buffer);
+	if (!buffer || size < header_size) return false;
+
+	UTL::blobStreamReader reader{ buffer };
+	if (reader.read<u32>() != snapshot_magic ||
+		reader.read<u32>() != snapshot_version ||
+		reader.read<u32>() != sizeof(ID::id_type) ||
+		reader.read<u64>() != size) {
+		return false;
+	}
+
+	// NOTE: the counts in the snapshot aren't trusted, the whole snapshot has to check out
+	//		 before the current world is replaced.
+	{
+		UTL::blobStreamReader validator{ reader.position() };
+		const u64 sections_size{ size - header_size };
+		if (!GAME_ENTITY::validate_snapshot(validator, sections_size) ||
+			!TRANSFORM::validate_snapshot(validator, sections_size) ||
+			!SCRIPT::validate_snapshot(validator, sections_size) ||
+			validator.offset() != sections_size) {
+			return false;
+		}
+	}
+
+	// NOTE: entities go first, scripts are created for entities that have to be restored already.
+	GAME_ENTITY::restore_snapshot(reader);
+	TRANSFORM::restore_snapshot(reader);
+	SCRIPT::restore_snapshot(reader);
+
+	assert(reader.offset() == size);
+	return true;
+}
+
+bool save_world_snapshot(const char* path) {
+	const u64 size{ world_snapshot_size() };
+	std::unique_ptr<u8[]> buffer{ std::make_unique<u8[]>(size) };
+	if (!save_world_snapshot(buffer.get(), size)) return false;
+
+	std::ofstream file{ path, std::ios::out | std::ios::binary };
+	if (!file || !file.write((const char*)buffer.get(), size)) return false;
+	return true;
+}
+
+bool restore_world_snapshot(const char* path) {
+	if (!std::filesystem::exists(path)) return false;
+
+	const u64 size{ std::filesystem::file_size(path) };
+	if (!size) return false;
+	std::unique_ptr<u8[]> buffer{ std::make_unique<u8[]>(size) };
+	std::ifstream file{ path, std::ios::in | std::ios::binary };
+	if (!file || !file.read((char*)buffer.get(), size)) return false;
+
+	return restore_world_snapshot(buffer.get(), size);
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "CommonHeaders.h"
+
+namespace WAVEENGINE::CONTENT {
+
+// A world snapshot holds the entity, transform and script storages as contiguous arrays,
+// so that restoring a world is a few bulk copies instead of loading and creating every entity again.
+// Scripts are recreated from their type and may keep extra state (see entity_script::save_state()).
+// NOTE: snapshots are a runtime format, they're only valid for the build that saved them.
+
+u64 world_snapshot_size();
+
+// saves the current world into 'buffer', which has to be at least world_snapshot_size() bytes.
+bool save_world_snapshot(u8* const buffer, u64 size);
+
+// replaces the current world with the one in the snapshot.
+bool restore_world_snapshot(const u8* const buffer, u64 size);
+
+bool save_world_snapshot(const char* path);
+bool restore_world_snapshot(const char* path);
+
+}
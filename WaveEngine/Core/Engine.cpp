@@ -1,11 +1,18 @@
 #if !defined(SHIPPING)
 
 #include "..\Content\ContentLoader.h"
+#include "..\Content\Streaming.h"
+#include "..\Content\ResourceCache.h"
 #include "..\Components\Script.h"
+#include "..\Components\Transform.h"
+#include "..\Spatial\SpatialIndex.h"
+#include "JobSystem.h"
+#include "FrameScheduler.h"
+#include "Profiler.h"
 #include "..\Platform\PlatformTypes.h" 
 #include "..\Platform\Platform.h"
 #include "..\Graphics\Renderer.h"
-#include <thread>
+#include "..\Graphics\RenderThread.h"
 
 using namespace WAVEENGINE;
 
@@ -22,6 +29,15 @@ LRESULT win_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 		}
 		break;
 	}
+#if USE_PROFILER
+	case WM_KEYDOWN: {
+		if (wparam == VK_F11) {
+			PROFILER::export_chrome_trace("profile.json");
+			return 0;
+		}
+		break;
+	}
+#endif
 	case WM_SYSCHAR: {
 		if (wparam == VK_RETURN && (HIWORD(lparam) & KF_ALTDOWN)) {
 			game_window.window.set_fullscreen(!game_window.window.is_fullscreen());
@@ -34,11 +50,38 @@ LRESULT win_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 	return DefWindowProc(hwnd, msg, wparam, lparam);
 }
 
+// Copies what the render thread needs from the simulation state, so the next frame can be simulated while this one
+// is rendered.
+void extract_render_snapshot() {
+	PROFILE_FUNCTION();
+	GRAPHICS::render_snapshot& snapshot{ GRAPHICS::begin_render_snapshot() };
+	snapshot.alpha = FRAME::alpha();
+	snapshot.targets.clear();
+	if (game_window.surface.is_valid() && !game_window.window.is_closed()) {
+		snapshot.targets.emplace_back(GRAPHICS::render_target{ game_window.surface.get_id(), game_window.window.width(), game_window.window.height() });
+	}
+	GRAPHICS::submit_render_snapshot();
+}
+
 }
 
 bool engine_initialize() {
+	PROFILE_THREAD("Main");
+	if (!WAVEENGINE::JOBS::initialize())
+		return false;
+
+	WAVEENGINE::FRAME::initialize();
+
+	if (!WAVEENGINE::STREAMING::initialize())
+		return false;
+
 	if (!WAVEENGINE::CONTENT::load_game())
 		return false;
+
+	// NOTE: the game still runs without hot reload, e.g. when the directory can't be watched.
+	if (!WAVEENGINE::CONTENT::start_hot_reload()) {
+		OutputDebugStringA("Hot reload is disabled\n");
+	}
 	
 	PLATFORM::window_init_info info{
 		&win_proc, nullptr, L"Wave Game"
@@ -47,17 +90,80 @@ bool engine_initialize() {
 	game_window.window = PLATFORM::create_window(&info);
 	if (!game_window.window.is_valid())
 		return false;
-	return true;
+
+#if USE_D3D12
+	if (!GRAPHICS::initialize(GRAPHICS::graphics_platform::Direct3D12))
+		return false;
+#elif USE_VULKAN
+	if (!GRAPHICS::initialize(GRAPHICS::graphics_platform::Vulkan))
+		return false;
+#endif
+
+	// NOTE: surfaces can't be created once the render thread runs, see GRAPHICS::start_render_thread().
+	game_window.surface = GRAPHICS::create_surface(game_window.window);
+	if (!game_window.surface.is_valid())
+		return false;
+
+	return GRAPHICS::start_render_thread();
 }
 
 void engine_update() {
-	WAVEENGINE::SCRIPT::update(10.0f);
-	std::this_thread::sleep_for(std::chrono::microseconds(10));
+	PROFILE_FRAME("Frame");
+	WAVEENGINE::FRAME::begin_frame();
+	WAVEENGINE::MEMORY::begin_frame();
+	if (!WAVEENGINE::CONTENT::update_streamed_sections()) {
+		OutputDebugStringA("Failed to load a streamed world section\n");
+	}
+	if (!WAVEENGINE::CONTENT::update_hot_reload()) {
+		OutputDebugStringA("Failed to hot reload a world section\n");
+	}
+	WAVEENGINE::RESOURCES::update();
+	{
+		PROFILE_SCOPE("Simulate");
+		while (WAVEENGINE::FRAME::step()) {
+			WAVEENGINE::SCRIPT::update(WAVEENGINE::FRAME::fixed_step());
+		}
+		WAVEENGINE::TRANSFORM::publish_changes();
+	}
+	{
+		PROFILE_SCOPE("Spatial update");
+		WAVEENGINE::SPATIAL::update();
+	}
+	extract_render_snapshot();
+	{
+		PROFILE_SCOPE("Frame pacing");
+		WAVEENGINE::FRAME::end_frame();
+	}
+	PROFILE_COUNTER("Frame ms", WAVEENGINE::FRAME::stats().frame_ms);
+	PROFILE_COUNTER("Simulation steps", WAVEENGINE::FRAME::stats().steps);
+#if USE_PROFILER
+	for (u32 i{ 0 }; i < (u32)MEMORY::memory_tag::count; ++i) {
+		PROFILE_COUNTER(MEMORY::memory_tag_names[i], MEMORY::get_stats((MEMORY::memory_tag)i).live_bytes);
+	}
+#endif
 }
 
 void engine_shutdown() {
-	PLATFORM::remove_window(game_window.window.get_id());
+	GRAPHICS::stop_render_thread();
+	if (game_window.surface.is_valid()) GRAPHICS::remove_surface(game_window.surface.get_id());
+	if (game_window.window.is_valid()) PLATFORM::remove_window(game_window.window.get_id());
+	game_window = {};
+	GRAPHICS::shutdown();
+	WAVEENGINE::CONTENT::stop_hot_reload();
+	WAVEENGINE::STREAMING::shutdown();
+	WAVEENGINE::RESOURCES::shutdown();
 	WAVEENGINE::CONTENT::unload_game();
+	WAVEENGINE::SPATIAL::shutdown();
+	WAVEENGINE::JOBS::shutdown();
+	WAVEENGINE::FRAME::shutdown();
+
+	// NOTE: module storage that is only freed by static destructors shows up here as well,
+	//		 compare the reports of two runs to find the leaks.
+	char report[1024];
+	if (MEMORY::write_report(&report[0], sizeof(report))) {
+		OutputDebugStringA("Memory still allocated at shutdown:\n");
+		OutputDebugStringA(report);
+	}
 }
 
 #endif // !defined(SHIPPING)
\ No newline at end of file
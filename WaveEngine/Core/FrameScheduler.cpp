@@ -0,0 +1,180 @@
+#include "FrameScheduler.h"
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _WIN64
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace WAVEENGINE::FRAME {
+
+namespace {
+
+// NOTE: steady_clock is monotonic and uses QueryPerformanceCounter on Windows.
+using clock = std::chrono::steady_clock;
+using seconds = std::chrono::duration<f64>;
+
+frame_settings	settings{};
+frame_stats		statistics{};
+clock::time_point frame_start{};
+clock::time_point work_end{};
+f64				accumulator{ 0.0 };
+f64				simulated_time{ 0.0 };
+u32				steps_this_frame{ 0 };
+bool			first_frame{ true };
+bool			is_timer_period_set{ false };
+
+/*
+ * Sleeping is only accurate to the OS scheduler's granularity (often 1-16ms on Windows), and spinning wastes a core.
+ * We sleep in 1ms slices while the remaining time is larger than what a slice has been observed to take
+ * (running mean + standard deviation), then spin for the rest.
+ * refs: Blat Blatnik, "Making an accurate Sleep() function"
+ */
+struct sleep_estimator {
+	f64 estimate{ 0.005 };
+	f64 mean{ 0.005 };
+	f64 m2{ 0.0 };
+	u64 count{ 1 };
+
+	void add(f64 observed) {
+		// Welford's online variance
+		++count;
+		const f64 delta{ observed - mean };
+		mean += delta / (f64)count;
+		m2 += delta * (observed - mean);
+		estimate = mean + std::sqrt(m2 / (f64)(count - 1));
+		// NOTE: keep adapting to changes of the scheduler's behavior instead of averaging forever.
+		if (count > 1000) {
+			count = 1;
+			m2 = 0.0;
+		}
+	}
+} sleeper;
+
+void wait_until(clock::time_point target) {
+	while (true) {
+		const f64 remaining{ seconds(target - clock::now()).count() };
+		if (remaining <= sleeper.estimate) break;
+
+		const clock::time_point start{ clock::now() };
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		sleeper.add(seconds(clock::now() - start).count());
+	}
+
+	while (clock::now() < target) {
+		std::this_thread::yield();
+	}
+}
+
+} // anonymous namespace
+
+void initialize(const frame_settings& init_settings) {
+	assert(init_settings.fixed_step > 0.0f && init_settings.max_steps_per_frame);
+	settings = init_settings;
+	accumulator = 0.0;
+	simulated_time = 0.0;
+	first_frame = true;
+	statistics = {};
+	reset_stats();
+
+#ifdef _WIN64
+	// NOTE: the default timer resolution is 15.6ms, which makes every 1ms sleep in wait_until() take a whole tick.
+	if (!is_timer_period_set) {
+		is_timer_period_set = timeBeginPeriod(1) == TIMERR_NOERROR;
+	}
+#endif
+}
+
+void shutdown() {
+#ifdef _WIN64
+	if (is_timer_period_set) {
+		timeEndPeriod(1);
+		is_timer_period_set = false;
+	}
+#endif
+}
+
+void set_target_fps(f32 target_fps) {
+	assert(target_fps >= 0.0f);
+	settings.target_fps = target_fps;
+}
+
+f32 begin_frame() {
+	const clock::time_point now{ clock::now() };
+	f64 dt{ 0.0 };
+	if (first_frame) {
+		first_frame = false;
+	}
+	else {
+		dt = seconds(now - frame_start).count();
+	}
+	frame_start = now;
+
+	accumulator += dt;
+	// NOTE: after a stall (debugger, loading) only simulate up to max_steps_per_frame and drop the rest.
+	const f64 max_accumulated{ (f64)settings.fixed_step * settings.max_steps_per_frame };
+	if (accumulator > max_accumulated) accumulator = max_accumulated;
+
+	steps_this_frame = 0;
+	return (f32)dt;
+}
+
+bool step() {
+	const f64 fixed{ settings.fixed_step };
+	if (accumulator < fixed) return false;
+
+	accumulator -= fixed;
+	simulated_time += fixed;
+	++steps_this_frame;
+	return true;
+}
+
+f32 alpha() {
+	return (f32)(accumulator / settings.fixed_step);
+}
+
+void end_frame() {
+	work_end = clock::now();
+	if (settings.target_fps > 0.0f) {
+		const auto frame_time{ std::chrono::duration_cast<clock::duration>(seconds(1.0 / settings.target_fps)) };
+		wait_until(frame_start + frame_time);
+	}
+
+	const f32 work_ms{ (f32)(seconds(work_end - frame_start).count() * 1000.0) };
+	const f32 frame_ms{ (f32)(seconds(clock::now() - frame_start).count() * 1000.0) };
+	frame_stats& s{ statistics };
+	s.work_ms = work_ms;
+	s.frame_ms = frame_ms;
+	s.average_ms = s.frame_count ? s.average_ms + (frame_ms - s.average_ms) * 0.05f : frame_ms;
+	s.min_ms = (std::min)(s.min_ms, frame_ms);
+	s.max_ms = (std::max)(s.max_ms, frame_ms);
+	s.fps = s.average_ms > 0.0f ? 1000.0f / s.average_ms : 0.0f;
+	s.steps = steps_this_frame;
+	++s.frame_count;
+}
+
+f32 fixed_step() {
+	return settings.fixed_step;
+}
+
+f64 simulation_time() {
+	return simulated_time;
+}
+
+const frame_stats& stats() {
+	return statistics;
+}
+
+void reset_stats() {
+	statistics.min_ms = 1e9f;
+	statistics.max_ms = 0.0f;
+}
+
+}
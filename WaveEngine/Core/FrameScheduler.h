@@ -0,0 +1,45 @@
+#pragma once
+#include "CommonHeaders.h"
+
+namespace WAVEENGINE::FRAME {
+
+struct frame_settings {
+	f32 fixed_step{ 1.0f / 60.0f };		// simulation step in seconds
+	f32 target_fps{ 60.0f };			// 0 doesn't pace frames, the main thread then spins as fast as it can
+	u32 max_steps_per_frame{ 8 };		// drops simulation time after a long stall instead of spiraling
+};
+
+struct frame_stats {
+	f32 frame_ms;				// last frame, including pacing
+	f32 work_ms;				// last frame, without pacing
+	f32 average_ms;				// exponential moving average of frame_ms
+	f32 min_ms;					// since the last reset_stats()
+	f32 max_ms;
+	f32 fps;					// from average_ms
+	u64 frame_count;
+	u32 steps;					// simulation steps taken in the last frame
+};
+
+void initialize(const frame_settings& settings = {});
+void shutdown();
+void set_target_fps(f32 target_fps);
+
+// Starts a frame: measures the time since the previous frame and adds it to the simulation accumulator.
+// Returns the real time of the previous frame in seconds.
+f32 begin_frame();
+
+// Takes one fixed step out of the accumulator. Use as: while (FRAME::step()) simulate(FRAME::fixed_step());
+bool step();
+
+// How far the current time is between the last two simulation steps [0, 1), for interpolating rendered state.
+f32 alpha();
+
+// Waits until the target frame time is reached (sleeps, then spins for the last part) and updates the statistics.
+void end_frame();
+
+f32 fixed_step();
+f64 simulation_time();		// seconds of simulated time
+const frame_stats& stats();
+void reset_stats();
+
+}
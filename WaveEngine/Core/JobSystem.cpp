@@ -0,0 +1,142 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+
+namespace WAVEENGINE::JOBS {
+
+namespace {
+
+struct job {
+	job_function		func;
+	void*				context;
+	u32					begin;
+	u32					end;
+	std::atomic<u32>*	pending; // number of chunks of the same parallel_for that are not finished yet, null for submit()
+};
+
+UTL::vector<std::thread>	workers;
+UTL::deque<job>				jobs;
+std::mutex					jobs_mutex;
+std::condition_variable		jobs_cv;
+bool						is_running{ false };
+
+bool try_pop(job& j) {
+	std::lock_guard lock{ jobs_mutex };
+	if (jobs.empty()) return false;
+	j = jobs.front();
+	jobs.pop_front();
+	return true;
+}
+
+void execute(const job& j) {
+	j.func(j.context, j.begin, j.end);
+	if (j.pending) j.pending->fetch_sub(1, std::memory_order_release);
+}
+
+void worker_loop() {
+	PROFILE_THREAD("Job worker");
+	while (true) {
+		job j{};
+		{
+			std::unique_lock lock{ jobs_mutex };
+			jobs_cv.wait(lock, [] { return !jobs.empty() || !is_running; });
+			if (jobs.empty()) return; // shutting down and nothing left to do
+			j = jobs.front();
+			jobs.pop_front();
+		}
+		execute(j);
+	}
+}
+
+} // anonymous namespace
+
+bool initialize(u32 num_workers) {
+	assert(!is_running);
+	if (!num_workers) {
+		const u32 hw_threads{ std::thread::hardware_concurrency() };
+		num_workers = hw_threads > 1 ? hw_threads - 1 : 1;
+	}
+
+	is_running = true;
+	workers.reserve(num_workers);
+	for (u32 i{ 0 }; i < num_workers; ++i) {
+		workers.emplace_back(worker_loop);
+	}
+	return true;
+}
+
+void shutdown() {
+	{
+		std::lock_guard lock{ jobs_mutex };
+		is_running = false;
+	}
+	jobs_cv.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+	assert(jobs.empty());
+}
+
+u32 worker_count() {
+	return (u32)workers.size();
+}
+
+void submit(job_function func, void* context) {
+	assert(func);
+	{
+		std::lock_guard lock{ jobs_mutex };
+		if (is_running && !workers.empty()) {
+			jobs.push_back(job{ func, context, 0, 1, nullptr });
+			func = nullptr;
+		}
+	}
+	if (func) {
+		func(context, 0, 1);
+	}
+	else {
+		jobs_cv.notify_one();
+	}
+}
+
+namespace DETAIL {
+
+void run(job_function func, void* context, u32 count, u32 chunk_size) {
+	assert(func && chunk_size);
+	if (!count) return;
+
+	const u32 num_chunks{ (count + chunk_size - 1) / chunk_size };
+	if (num_chunks == 1 || workers.empty()) {
+		func(context, 0, count);
+		return;
+	}
+
+	std::atomic<u32> pending{ num_chunks };
+	{
+		std::lock_guard lock{ jobs_mutex };
+		for (u32 begin{ 0 }; begin < count; begin += chunk_size) {
+			const u32 end{ std::min(begin + chunk_size, count) };
+			jobs.push_back(job{ func, context, begin, end, &pending });
+		}
+	}
+	jobs_cv.notify_all();
+
+	// NOTE: the calling thread helps instead of blocking, this also makes nested parallel_for calls safe.
+	while (pending.load(std::memory_order_acquire)) {
+		job j{};
+		if (try_pop(j)) {
+			execute(j);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+}
+
+}
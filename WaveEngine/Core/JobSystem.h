@@ -0,0 +1,33 @@
+#pragma once
+#include "CommonHeaders.h"
+
+namespace WAVEENGINE::JOBS {
+
+using job_function = void(*)(void* context, u32 begin, u32 end);
+
+// starts the worker threads. 0 means one worker per hardware thread, minus the calling thread.
+bool initialize(u32 num_workers = 0);
+void shutdown();
+
+u32 worker_count();
+
+// Queues func(context, 0, 1) and returns without waiting for it. The caller keeps 'context' alive until it ran.
+// NOTE: when the job system is not initialized, func is called on the calling thread before submit returns.
+void submit(job_function func, void* context);
+
+namespace DETAIL {
+void run(job_function func, void* context, u32 count, u32 chunk_size);
+}
+
+// Splits [0, count) into chunks of 'chunk_size' items and calls func(begin, end) for each chunk on the workers.
+// The calling thread also executes chunks and returns only when all of them are done.
+// NOTE: when the job system is not initialized, all chunks are executed on the calling thread.
+template<typename function>
+void parallel_for(u32 count, u32 chunk_size, function&& func) {
+	using function_type = std::remove_reference_t<function>;
+	DETAIL::run([](void* context, u32 begin, u32 end) {
+		(*static_cast<function_type*>(context))(begin, end);
+		}, const_cast<void*>(static_cast<const void*>(std::addressof(func))), count, chunk_size);
+}
+
+}
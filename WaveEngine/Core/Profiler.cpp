@@ -0,0 +1,161 @@
+#include "Profiler.h"
+
+#if USE_PROFILER
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+namespace WAVEENGINE::PROFILER {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+enum class event_type : u32 {
+	scope,
+	frame,
+	counter,
+};
+
+struct event {
+	const char*		name;
+	u64				start;
+	union {
+		u64			end;		// scope
+		f64			value;		// counter
+	};
+	event_type		type;
+};
+
+// NOTE: only the owning thread writes 'head' and the events, the exporter reads the events from 'tail' up to 'head'.
+struct thread_buffer {
+	std::atomic<u64>	head{ 0 };
+	std::atomic<u64>	tail{ 0 };		// moved to 'head' by clear()
+	const char*			name{ nullptr };
+	u32					thread_index{ 0 };
+	event				events[events_per_thread];
+};
+
+static_assert((events_per_thread & (events_per_thread - 1)) == 0, "events_per_thread must be a power of 2.");
+
+const clock::time_point					epoch{ clock::now() };
+std::mutex								buffers_mutex;
+UTL::vector<std::unique_ptr<thread_buffer>>	buffers;
+thread_local thread_buffer*				local_buffer{ nullptr };
+
+thread_buffer& get_thread_buffer() {
+	MEMORY_TAG(profiler);
+	if (!local_buffer) {
+		std::lock_guard lock{ buffers_mutex };
+		buffers.emplace_back(std::make_unique<thread_buffer>());
+		local_buffer = buffers.back().get();
+		local_buffer->thread_index = (u32)buffers.size() - 1;
+	}
+	return *local_buffer;
+}
+
+void record(const event& e) {
+	thread_buffer& buffer{ get_thread_buffer() };
+	const u64 head{ buffer.head.load(std::memory_order_relaxed) };
+	buffer.events[head & (events_per_thread - 1)] = e;
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+f64 to_microseconds(u64 ticks) {
+	return (f64)ticks * ((f64)clock::period::num * 1'000'000.0 / (f64)clock::period::den);
+}
+
+void write_name(std::ofstream& file, const char* name) {
+	file << '"';
+	for (const char* c{ name }; *c; ++c) {
+		if (*c == '"' || *c == '\\') file << '\\';
+		file << *c;
+	}
+	file << '"';
+}
+
+} // anonymous namespace
+
+u64 now() {
+	return (u64)(clock::now() - epoch).count();
+}
+
+void record_scope(const char* name, u64 start, u64 end) {
+	event e{ name, start, {}, event_type::scope };
+	e.end = end;
+	record(e);
+}
+
+void frame_mark(const char* name) {
+	event e{ name, now(), {}, event_type::frame };
+	record(e);
+}
+
+void counter(const char* name, f64 value) {
+	event e{ name, now(), {}, event_type::counter };
+	e.value = value;
+	record(e);
+}
+
+void set_thread_name(const char* name) {
+	get_thread_buffer().name = name;
+}
+
+bool export_chrome_trace(const char* path) {
+	std::ofstream file{ path, std::ios::out | std::ios::trunc };
+	if (!file) return false;
+
+	file.precision(3);
+	file << std::fixed << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first{ true };
+	auto separate = [&]() { if (!first) file << ",\n"; first = false; };
+
+	std::lock_guard lock{ buffers_mutex };
+	for (u32 i{ 0 }; i < buffers.size(); ++i) {
+		const thread_buffer& buffer{ *buffers[i] };
+		const u32 tid{ buffer.thread_index };
+		if (buffer.name) {
+			separate();
+			file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":";
+			write_name(file, buffer.name);
+			file << "}}";
+		}
+
+		const u64 head{ buffer.head.load(std::memory_order_acquire) };
+		const u64 tail{ (std::max)(buffer.tail.load(std::memory_order_relaxed), head > events_per_thread ? head - events_per_thread : 0) };
+		for (u64 j{ tail }; j < head; ++j) {
+			const event& e{ buffer.events[j & (events_per_thread - 1)] };
+			separate();
+			file << "{\"name\":";
+			write_name(file, e.name);
+			file << ",\"pid\":0,\"tid\":" << tid << ",\"ts\":" << to_microseconds(e.start);
+			switch (e.type) {
+			case event_type::scope:
+				file << ",\"ph\":\"X\",\"dur\":" << to_microseconds(e.end - e.start) << '}';
+				break;
+			case event_type::frame:
+				file << ",\"ph\":\"i\",\"s\":\"g\"}";
+				break;
+			case event_type::counter:
+				file << ",\"ph\":\"C\",\"args\":{\"value\":" << e.value << "}}";
+				break;
+			}
+		}
+	}
+	file << "\n]}\n";
+	return (bool)file;
+}
+
+void clear() {
+	std::lock_guard lock{ buffers_mutex };
+	for (u32 i{ 0 }; i < buffers.size(); ++i) {
+		buffers[i]->tail.store(buffers[i]->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+}
+
+#endif // USE_PROFILER
@@ -0,0 +1,64 @@
+#pragma once
+#include "CommonHeaders.h"
+
+// Instrumentation is compiled out of shipping builds, define USE_PROFILER to override.
+#if !defined(USE_PROFILER)
+#if defined(SHIPPING)
+#define USE_PROFILER 0
+#else
+#define USE_PROFILER 1
+#endif
+#endif
+
+#if USE_PROFILER
+
+namespace WAVEENGINE::PROFILER {
+
+// Events are written to a ring buffer of the thread that records them, without locks.
+// When a thread records more events than this, its oldest events are overwritten.
+constexpr u32 events_per_thread{ 64 * 1024 };
+
+u64 now();
+
+// NOTE: names are stored as pointers and must outlive the profiler, use string literals.
+void record_scope(const char* name, u64 start, u64 end);
+void frame_mark(const char* name);
+void counter(const char* name, f64 value);
+void set_thread_name(const char* name);
+
+// Writes the recorded events of all threads in Chrome's trace event format (chrome://tracing, ui.perfetto.dev).
+// NOTE: events that are recorded while exporting may be torn, export between frames or after stopping the threads.
+bool export_chrome_trace(const char* path);
+
+// Drops all recorded events.
+void clear();
+
+class scope {
+public:
+	explicit scope(const char* name) : _name{ name }, _start{ now() } {}
+	~scope() { record_scope(_name, _start, now()); }
+	DISABLE_COPY_AND_MOVE(scope);
+private:
+	const char* const	_name;
+	const u64			_start;
+};
+
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) const ::WAVEENGINE::PROFILER::scope PROFILE_CONCAT(profile_scope_, __LINE__){ name }
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_FRAME(name) ::WAVEENGINE::PROFILER::frame_mark(name)
+#define PROFILE_COUNTER(name, value) ::WAVEENGINE::PROFILER::counter(name, (f64)(value))
+#define PROFILE_THREAD(name) ::WAVEENGINE::PROFILER::set_thread_name(name)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_FRAME(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+
+#endif // USE_PROFILER
@@ -31,6 +31,11 @@ public:
 	virtual ~entity_script() = default;
 	virtual void begin_play() {}
 	virtual void update(float) {}
+
+	// Optional state that is kept in world snapshots. save_state() returns the number of bytes
+	// it writes, and only returns the size when 'buffer' is nullptr.
+	virtual u32 save_state(u8* const /*buffer*/) const { return 0; }
+	virtual void load_state(const u8* const /*buffer*/, u32 /*size*/) {}
 protected:
 	constexpr explicit entity_script(GAME_ENTITY::entity entity) 
 		: GAME_ENTITY::entity(entity.get_id()) {}
@@ -15,6 +15,12 @@ public:
 	MATH::v4 rotation() const;
 	MATH::v3 position() const;
 	MATH::v3 scale() const;
+
+	void set_rotation(const MATH::v4& rotation) const;
+	void set_position(const MATH::v3& position) const;
+	void set_scale(const MATH::v3& scale) const;
+	// the version in which this transform last changed (see TRANSFORM::publish_changes())
+	u32 version() const;
 private:
 	transform_id _id;
 };
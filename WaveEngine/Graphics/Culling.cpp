@@ -0,0 +1,146 @@
+#include "Culling.h"
+#include "..\Core\JobSystem.h"
+#include "..\Core\Profiler.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+namespace {
+
+using namespace DirectX;
+
+// NOTE: must be a multiple of 4, so only the last chunk can end with a partial group.
+constexpr u32 cull_chunk_size{ 16 * 1024 };
+
+// frustum planes with each component replicated to all lanes, so 4 bounds are tested per plane at once.
+struct plane_set {
+	XMVECTOR x[6];
+	XMVECTOR y[6];
+	XMVECTOR z[6];
+	XMVECTOR w[6];
+	XMVECTOR abs_x[6];
+	XMVECTOR abs_y[6];
+	XMVECTOR abs_z[6];
+};
+
+plane_set load_planes(const SPATIAL::frustum& f) {
+	plane_set p{};
+	for (u32 i{ 0 }; i < 6; ++i) {
+		const MATH::v4& plane{ f.planes[i] };
+		p.x[i] = XMVectorReplicate(plane.x);
+		p.y[i] = XMVectorReplicate(plane.y);
+		p.z[i] = XMVectorReplicate(plane.z);
+		p.w[i] = XMVectorReplicate(plane.w);
+		p.abs_x[i] = XMVectorReplicate(std::abs(plane.x));
+		p.abs_y[i] = XMVectorReplicate(std::abs(plane.y));
+		p.abs_z[i] = XMVectorReplicate(std::abs(plane.z));
+	}
+	return p;
+}
+
+// loads 'count' (at most 4) floats, the missing lanes are 0.
+XMVECTOR load(const f32* const data, u32 count) {
+	if (count == 4) return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(data));
+	XMFLOAT4 v{ 0.0f, 0.0f, 0.0f, 0.0f };
+	memcpy(&v, data, count * sizeof(f32));
+	return XMLoadFloat4(&v);
+}
+
+// one bit per lane that is set in the comparison result
+u32 lane_mask(XMVECTOR v) {
+#if defined(_XM_SSE_INTRINSICS_)
+	return (u32)_mm_movemask_ps(v);
+#else
+	return (XMVectorGetIntX(v) & 1) | ((XMVectorGetIntY(v) & 1) << 1) | ((XMVectorGetIntZ(v) & 1) << 2) | ((XMVectorGetIntW(v) & 1) << 3);
+#endif
+}
+
+u32 test_spheres(const plane_set& p, const sphere_bounds& spheres, u32 first, u32 count) {
+	const XMVECTOR x{ load(&spheres.x[first], count) };
+	const XMVECTOR y{ load(&spheres.y[first], count) };
+	const XMVECTOR z{ load(&spheres.z[first], count) };
+	const XMVECTOR neg_radius{ XMVectorNegate(load(&spheres.radius[first], count)) };
+
+	// a sphere is outside when it's behind any plane by more than its radius
+	XMVECTOR inside{ XMVectorTrueInt() };
+	for (u32 i{ 0 }; i < 6; ++i) {
+		const XMVECTOR distance{ XMVectorMultiplyAdd(p.x[i], x, XMVectorMultiplyAdd(p.y[i], y, XMVectorMultiplyAdd(p.z[i], z, p.w[i]))) };
+		inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(distance, neg_radius));
+	}
+	return lane_mask(inside);
+}
+
+u32 test_boxes(const plane_set& p, const box_bounds& boxes, u32 first, u32 count) {
+	const XMVECTOR cx{ load(&boxes.center_x[first], count) };
+	const XMVECTOR cy{ load(&boxes.center_y[first], count) };
+	const XMVECTOR cz{ load(&boxes.center_z[first], count) };
+	const XMVECTOR ex{ load(&boxes.extent_x[first], count) };
+	const XMVECTOR ey{ load(&boxes.extent_y[first], count) };
+	const XMVECTOR ez{ load(&boxes.extent_z[first], count) };
+
+	// a box is outside when its center is behind any plane by more than the box's projected radius on the normal
+	XMVECTOR inside{ XMVectorTrueInt() };
+	for (u32 i{ 0 }; i < 6; ++i) {
+		const XMVECTOR distance{ XMVectorMultiplyAdd(p.x[i], cx, XMVectorMultiplyAdd(p.y[i], cy, XMVectorMultiplyAdd(p.z[i], cz, p.w[i]))) };
+		const XMVECTOR radius{ XMVectorMultiplyAdd(p.abs_x[i], ex, XMVectorMultiplyAdd(p.abs_y[i], ey, XMVectorMultiply(p.abs_z[i], ez))) };
+		inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorAdd(distance, radius), XMVectorZero()));
+	}
+	return lane_mask(inside);
+}
+
+// Writes the visible indices in [begin, end) to 'visible' and returns their number.
+// The store is unconditional and only the cursor depends on the mask, so mostly culled groups don't mispredict.
+template<typename test_function>
+u32 cull_range(u32 begin, u32 end, u32* const visible, test_function& test) {
+	u32 count{ 0 };
+	for (u32 i{ begin }; i < end; i += 4) {
+		const u32 group_size{ (std::min)(4u, end - i) };
+		const u32 mask{ test(i, group_size) };
+		for (u32 lane{ 0 }; lane < group_size; ++lane) {
+			visible[count] = i + lane;
+			count += (mask >> lane) & 1;
+		}
+	}
+	return count;
+}
+
+// Culls each chunk into its own part of 'visible', then moves the chunks' results together.
+template<typename test_function>
+u32 cull_parallel(u32 count, u32* const visible, test_function&& test) {
+	assert(visible || !count);
+	const u32 num_chunks{ (count + cull_chunk_size - 1) / cull_chunk_size };
+	if (num_chunks <= 1) return cull_range(0, count, visible, test);
+
+	UTL::vector<u32> chunk_counts(num_chunks);
+	JOBS::parallel_for(count, cull_chunk_size, [&](u32 begin, u32 end) {
+		chunk_counts[begin / cull_chunk_size] = cull_range(begin, end, &visible[begin], test);
+		});
+
+	u32 total{ chunk_counts[0] };
+	for (u32 i{ 1 }; i < num_chunks; ++i) {
+		memmove(&visible[total], &visible[i * cull_chunk_size], chunk_counts[i] * sizeof(u32));
+		total += chunk_counts[i];
+	}
+	return total;
+}
+
+} // anonymous namespace
+
+u32 cull(const SPATIAL::frustum& f, const sphere_bounds& spheres, u32* const visible) {
+	PROFILE_SCOPE("Frustum cull spheres");
+	assert((spheres.x && spheres.y && spheres.z && spheres.radius) || !spheres.count);
+	const plane_set planes{ load_planes(f) };
+	return cull_parallel(spheres.count, visible, [&](u32 first, u32 count) {
+		return test_spheres(planes, spheres, first, count);
+		});
+}
+
+u32 cull(const SPATIAL::frustum& f, const box_bounds& boxes, u32* const visible) {
+	PROFILE_SCOPE("Frustum cull boxes");
+	assert((boxes.center_x && boxes.center_y && boxes.center_z && boxes.extent_x && boxes.extent_y && boxes.extent_z) || !boxes.count);
+	const plane_set planes{ load_planes(f) };
+	return cull_parallel(boxes.count, visible, [&](u32 first, u32 count) {
+		return test_boxes(planes, boxes, first, count);
+		});
+}
+
+}
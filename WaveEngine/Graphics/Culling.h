@@ -0,0 +1,34 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "..\Spatial\SpatialCommon.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+// World space bounding spheres in structure of arrays layout.
+struct sphere_bounds {
+	const f32*	x;
+	const f32*	y;
+	const f32*	z;
+	const f32*	radius;
+	u32			count;
+};
+
+// World space axis aligned boxes in structure of arrays layout.
+struct box_bounds {
+	const f32*	center_x;
+	const f32*	center_y;
+	const f32*	center_z;
+	const f32*	extent_x;	// half sizes
+	const f32*	extent_y;
+	const f32*	extent_z;
+	u32			count;
+};
+
+// Tests the bounds against the frustum planes, 4 at a time, and writes the indices of the visible ones to
+// 'visible' in ascending order. Returns the number of visible indices.
+// 'visible' must have room for 'count' indices. Large inputs are split across the job system.
+// NOTE: this test is conservative, bounds near frustum corners can be reported visible while they're not.
+u32 cull(const SPATIAL::frustum& f, const sphere_bounds& spheres, u32* const visible);
+u32 cull(const SPATIAL::frustum& f, const box_bounds& boxes, u32* const visible);
+
+}
@@ -15,17 +15,18 @@ typedef struct compiledShader {
 compiledShaderPtr engine_shaders[engineShader::id::count]{};
 
 /// <summary>
-/// this is a chunk of memory that contains all compiled engine shaders.
+/// this is a mapped file that contains all compiled engine shaders.
 /// The blob is an array of shader byte code consisting of an u64 size and an array of bytes.
+/// The pages are read when the pipelines are created and can be paged out afterwards.
 /// </summary>
-std::unique_ptr<u8[]> shaders_blob{};
+PLATFORM::mappedFile shaders_blob{};
 
 bool load_engine_shaders() {
-	assert(!shaders_blob);
-	u64 size{ 0 };
-	bool result{ CONTENT::load_engine_shaders(shaders_blob, size) };
+	assert(!shaders_blob.is_valid());
+	bool result{ CONTENT::load_engine_shaders(shaders_blob) };
+	const u64 size{ shaders_blob.size() };
 
-	assert(shaders_blob && size);
+	assert(shaders_blob.is_valid() && size);
 
 	u64 offset{ 0 };
 	u32 index{ 0 };
@@ -35,7 +36,7 @@ bool load_engine_shaders() {
 		assert(!shader);
 		result &= index < engineShader::id::count && !shader;
 		if (!result)	break;
-		shader = reinterpret_cast<const compiledShaderPtr>(&shaders_blob[offset]);
+		shader = reinterpret_cast<const compiledShaderPtr>(&shaders_blob.data()[offset]);
 		offset += sizeof(u64) + shader->size;
 		++index;
 	}
@@ -54,7 +55,7 @@ void shutdown() {
 	for (u32 i{ 0 }; i < engineShader::id::count; ++i) {
 		engine_shaders[i] = nullptr;
 	}
-	shaders_blob.reset();
+	shaders_blob.close();
 }
 
 D3D12_SHADER_BYTECODE get_engine_shader(engineShader::id id) {
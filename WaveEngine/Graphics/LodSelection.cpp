@@ -0,0 +1,97 @@
+#include "LodSelection.h"
+#include "..\Core\JobSystem.h"
+#include "..\Core\Profiler.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+namespace {
+
+using namespace DirectX;
+
+// NOTE: must be a multiple of 4, so only the last chunk can end with a partial group.
+constexpr u32 lod_chunk_size{ 8 * 1024 };
+
+} // anonymous namespace
+
+lod_group_info make_lod_group(const f32* const lod_thresholds, u32 lod_count, f32 radius, f32 projection_scale) {
+	assert(lod_thresholds && lod_count && lod_count <= max_lod_count);
+	lod_group_info info{};
+	info.lod_count = (std::min)(lod_count, max_lod_count);
+
+	for (u32 i{ 1 }; i < info.lod_count; ++i) {
+		// projected radius of the object at the distance where LOD i takes over
+		const f32 threshold{ lod_thresholds[i] };
+		assert(threshold > 0.0f && threshold >= lod_thresholds[i - 1]);
+		const f32 screen_size{ radius * projection_scale / threshold };
+		info.screen_size_sq[i] = screen_size * screen_size;
+	}
+	return info;
+}
+
+void select_lods(const lod_camera& camera, const lod_group_info& group, const sphere_bounds& spheres,
+				 const u32* const indices, u32 count, f32 hysteresis, u8* const lods) {
+	PROFILE_SCOPE("Select LODs");
+	assert((spheres.x && spheres.y && spheres.z && spheres.radius && indices && lods) || !count);
+	assert(group.lod_count && group.lod_count <= max_lod_count);
+	if (group.lod_count == 1) {
+		for (u32 i{ 0 }; i < count; ++i) lods[indices[i]] = 0;
+		return;
+	}
+
+	// Compare squared sizes, so there is no square root or division per object:
+	//		radius * scale / distance < size  <=>  (radius * scale)^2 < size^2 * distance^2
+	// An object must get (1 - hysteresis) below a switch point to go to the coarser LOD, and (1 + hysteresis) above it
+	// to come back. This gives a range of LODs the object may stay in.
+	XMVECTOR coarse_size_sq[max_lod_count];
+	XMVECTOR fine_size_sq[max_lod_count];
+	const f32 coarse_factor{ (1.0f - hysteresis) * (1.0f - hysteresis) };
+	const f32 fine_factor{ (1.0f + hysteresis) * (1.0f + hysteresis) };
+	for (u32 i{ 1 }; i < group.lod_count; ++i) {
+		coarse_size_sq[i] = XMVectorReplicate(group.screen_size_sq[i] * coarse_factor);
+		fine_size_sq[i] = XMVectorReplicate(group.screen_size_sq[i] * fine_factor);
+	}
+
+	const XMVECTOR camera_x{ XMVectorReplicate(camera.position.x) };
+	const XMVECTOR camera_y{ XMVectorReplicate(camera.position.y) };
+	const XMVECTOR camera_z{ XMVectorReplicate(camera.position.z) };
+	const XMVECTOR scale_sq{ XMVectorReplicate(camera.projection_scale * camera.projection_scale) };
+	const XMVECTOR zero{ XMVectorZero() };
+	const XMVECTOR one{ XMVectorSplatOne() };
+
+	JOBS::parallel_for(count, lod_chunk_size, [&](u32 begin, u32 end) {
+		for (u32 first{ begin }; first < end; first += 4) {
+			const u32 group_size{ (std::min)(4u, end - first) };
+			// the objects are picked by index, so the lanes are gathered one by one. Missing lanes repeat the first object.
+			u32 index[4];
+			for (u32 lane{ 0 }; lane < 4; ++lane) index[lane] = indices[first + (lane < group_size ? lane : 0)];
+
+			const XMVECTOR dx{ XMVectorSubtract(XMVectorSet(spheres.x[index[0]], spheres.x[index[1]], spheres.x[index[2]], spheres.x[index[3]]), camera_x) };
+			const XMVECTOR dy{ XMVectorSubtract(XMVectorSet(spheres.y[index[0]], spheres.y[index[1]], spheres.y[index[2]], spheres.y[index[3]]), camera_y) };
+			const XMVECTOR dz{ XMVectorSubtract(XMVectorSet(spheres.z[index[0]], spheres.z[index[1]], spheres.z[index[2]], spheres.z[index[3]]), camera_z) };
+			const XMVECTOR radius{ XMVectorSet(spheres.radius[index[0]], spheres.radius[index[1]], spheres.radius[index[2]], spheres.radius[index[3]]) };
+
+			const XMVECTOR distance_sq{ XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz))) };
+			const XMVECTOR projected_sq{ XMVectorMultiply(XMVectorMultiply(radius, radius), scale_sq) };
+
+			// count the switch points the object is past, with and without the hysteresis band
+			XMVECTOR min_lod{ zero };
+			XMVECTOR max_lod{ zero };
+			for (u32 i{ 1 }; i < group.lod_count; ++i) {
+				min_lod = XMVectorAdd(min_lod, XMVectorSelect(zero, one, XMVectorLess(projected_sq, XMVectorMultiply(coarse_size_sq[i], distance_sq))));
+				max_lod = XMVectorAdd(max_lod, XMVectorSelect(zero, one, XMVectorLess(projected_sq, XMVectorMultiply(fine_size_sq[i], distance_sq))));
+			}
+
+			XMFLOAT4 min_lods, max_lods;
+			XMStoreFloat4(&min_lods, min_lod);
+			XMStoreFloat4(&max_lods, max_lod);
+			const f32 lane_min[4]{ min_lods.x, min_lods.y, min_lods.z, min_lods.w };
+			const f32 lane_max[4]{ max_lods.x, max_lods.y, max_lods.z, max_lods.w };
+			for (u32 lane{ 0 }; lane < group_size; ++lane) {
+				u8& lod{ lods[index[lane]] };
+				lod = (std::min)((std::max)(lod, (u8)lane_min[lane]), (u8)lane_max[lane]);
+			}
+		}
+		});
+}
+
+}
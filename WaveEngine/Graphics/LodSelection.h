@@ -0,0 +1,36 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "Culling.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+constexpr u32 max_lod_count{ 8 };
+
+struct lod_camera {
+	MATH::v3	position;
+	f32			projection_scale;	// pixels covered by 1 unit at distance 1, see lod_projection_scale()
+};
+
+// LOD switch points of one LOD group, as projected sizes that are compared against the objects' projected radius.
+struct lod_group_info {
+	f32			screen_size_sq[max_lod_count];	// squared projected radius below which LOD i is used (LOD 0 is unused)
+	u32			lod_count;
+};
+
+inline f32 lod_projection_scale(f32 fov_y, f32 viewport_height) {
+	return 0.5f * viewport_height / std::tan(0.5f * fov_y);
+}
+
+// Converts the lod_threshold values of a LOD group's meshes (the distance from which LOD i is used, -1 for LOD 0)
+// to projected sizes. 'radius' is the model space bounding radius of LOD 0 and 'projection_scale' the one the
+// thresholds were authored for. Objects that are scaled up then switch LODs proportionally further away.
+lod_group_info make_lod_group(const f32* const lod_thresholds, u32 lod_count, f32 radius, f32 projection_scale);
+
+// Selects the LOD of the world space spheres spheres[indices[i]] of objects that share 'group' and writes it to
+// lods[indices[i]]. 'lods' holds the LODs of the previous frame: an object only changes LOD when its projected size
+// is more than 'hysteresis' (relative, e.g. 0.1) past the switch point, so objects at a switch point don't pop.
+// 4 objects are processed at a time, large batches are split across the job system.
+void select_lods(const lod_camera& camera, const lod_group_info& group, const sphere_bounds& spheres,
+				 const u32* const indices, u32 count, f32 hysteresis, u8* const lods);
+
+}
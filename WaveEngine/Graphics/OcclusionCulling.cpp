@@ -0,0 +1,278 @@
+#include "OcclusionCulling.h"
+#include "..\Core\JobSystem.h"
+#include "..\Core\Profiler.h"
+#include <cmath>
+
+namespace WAVEENGINE::GRAPHICS {
+
+namespace {
+
+using namespace DirectX;
+
+// vertices closer to the eye plane than this are treated as crossing the near plane
+constexpr f32 min_w{ 1e-5f };
+constexpr u32 test_chunk_size{ 256 };
+
+// clip space to screen space, y goes down and depth is z / w.
+struct screen_vertex {
+	f32 x, y, z;
+};
+
+screen_vertex to_screen(const XMFLOAT4& clip, f32 width, f32 height) {
+	const f32 inv_w{ 1.0f / clip.w };
+	return {
+		(clip.x * inv_w * 0.5f + 0.5f) * width,
+		(0.5f - clip.y * inv_w * 0.5f) * height,
+		clip.z * inv_w
+	};
+}
+
+// the edge function of p -> q, positive on the left side
+void edge(const screen_vertex& p, const screen_vertex& q, f32& a, f32& b, f32& c) {
+	a = p.y - q.y;
+	b = q.x - p.x;
+	c = p.x * q.y - p.y * q.x;
+}
+
+} // anonymous namespace
+
+occlusionBuffer::occlusionBuffer(u32 width, u32 height)
+	: _width{ (width + tile_size - 1) & ~(tile_size - 1) },
+	  _height{ (height + tile_size - 1) & ~(tile_size - 1) },
+	  _tiles_x{ _width / tile_size },
+	  _tiles_y{ _height / tile_size } {
+	assert(_width && _height);
+	_depth.resize((u64)_width * _height, 1.0f);
+	_tile_max_depth.resize((u64)_tiles_x * _tiles_y, 1.0f);
+}
+
+void occlusionBuffer::render(const occluder* const occluders, u32 count, const MATH::m4x4& view_projection) {
+	PROFILE_SCOPE("Render occluders");
+	assert(occluders || !count);
+	_view_projection = view_projection;
+
+	_triangle_offsets.resize(count + 1);
+	u32 triangle_count{ 0 };
+	for (u32 i{ 0 }; i < count; ++i) {
+		assert(occluders[i].index_count % 3 == 0);
+		_triangle_offsets[i] = triangle_count;
+		triangle_count += occluders[i].index_count / 3;
+	}
+	_triangle_offsets[count] = triangle_count;
+	_triangles.resize(triangle_count);
+
+	// 1. transform the occluders and set up their triangles
+	const XMMATRIX vp{ XMLoadFloat4x4(&view_projection) };
+	const f32 width{ (f32)_width };
+	const f32 height{ (f32)_height };
+	JOBS::parallel_for(count, 1, [&](u32 begin, u32 end) {
+		UTL::vector<XMFLOAT4> clip_positions;
+		for (u32 i{ begin }; i < end; ++i) {
+			const occluder& o{ occluders[i] };
+			assert((o.positions && o.indices) || !o.index_count);
+			const XMMATRIX world_view_projection{ XMMatrixMultiply(XMLoadFloat4x4(&o.world), vp) };
+
+			clip_positions.resize(o.vertex_count);
+			for (u32 v{ 0 }; v < o.vertex_count; ++v) {
+				XMStoreFloat4(&clip_positions[v], XMVector3Transform(XMLoadFloat3(&o.positions[v]), world_view_projection));
+			}
+
+			triangle* const triangles{ &_triangles[_triangle_offsets[i]] };
+			for (u32 t{ 0 }; t < o.index_count / 3; ++t) {
+				triangle& tri{ triangles[t] };
+				tri = {};
+
+				const XMFLOAT4& c0{ clip_positions[o.indices[t * 3]] };
+				const XMFLOAT4& c1{ clip_positions[o.indices[t * 3 + 1]] };
+				const XMFLOAT4& c2{ clip_positions[o.indices[t * 3 + 2]] };
+				if (c0.w < min_w || c1.w < min_w || c2.w < min_w) continue;
+
+				const screen_vertex v0{ to_screen(c0, width, height) };
+				const screen_vertex v1{ to_screen(c1, width, height) };
+				const screen_vertex v2{ to_screen(c2, width, height) };
+				if (v0.z < 0.0f || v1.z < 0.0f || v2.z < 0.0f) continue;
+
+				f32 area{ (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y) };
+				if (std::abs(area) < 1e-8f) continue;
+
+				// edge i is opposite to vertex i, so edge i divided by the area is the barycentric weight of vertex i.
+				edge(v1, v2, tri.edge_a[0], tri.edge_b[0], tri.edge_c[0]);
+				edge(v2, v0, tri.edge_a[1], tri.edge_b[1], tri.edge_c[1]);
+				edge(v0, v1, tri.edge_a[2], tri.edge_b[2], tri.edge_c[2]);
+				// both windings are rasterized, flip the edges of clockwise triangles so inside is always positive
+				if (area < 0.0f) {
+					area = -area;
+					for (u32 e{ 0 }; e < 3; ++e) {
+						tri.edge_a[e] = -tri.edge_a[e];
+						tri.edge_b[e] = -tri.edge_b[e];
+						tri.edge_c[e] = -tri.edge_c[e];
+					}
+				}
+
+				const f32 inv_area{ 1.0f / area };
+				tri.depth_a = (tri.edge_a[0] * v0.z + tri.edge_a[1] * v1.z + tri.edge_a[2] * v2.z) * inv_area;
+				tri.depth_b = (tri.edge_b[0] * v0.z + tri.edge_b[1] * v1.z + tri.edge_b[2] * v2.z) * inv_area;
+				tri.depth_c = (tri.edge_c[0] * v0.z + tri.edge_c[1] * v1.z + tri.edge_c[2] * v2.z) * inv_area;
+
+				tri.min_x = (std::max)((s32)std::floor((std::min)({ v0.x, v1.x, v2.x })), 0);
+				tri.min_y = (std::max)((s32)std::floor((std::min)({ v0.y, v1.y, v2.y })), 0);
+				tri.max_x = (std::min)((s32)std::ceil((std::max)({ v0.x, v1.x, v2.x })), (s32)_width);
+				tri.max_y = (std::min)((s32)std::ceil((std::max)({ v0.y, v1.y, v2.y })), (s32)_height);
+			}
+		}
+		});
+
+	// 2. bin the triangles to the rows of tiles they touch
+	_row_offsets.clear();
+	_row_offsets.resize(_tiles_y + 1, 0);
+	for (const triangle& tri : _triangles) {
+		if (tri.min_x >= tri.max_x || tri.min_y >= tri.max_y) continue;
+		for (s32 row{ tri.min_y / (s32)tile_size }; row <= (tri.max_y - 1) / (s32)tile_size; ++row) ++_row_offsets[row + 1];
+	}
+	for (u32 row{ 0 }; row < _tiles_y; ++row) _row_offsets[row + 1] += _row_offsets[row];
+	_row_triangles.resize(_row_offsets[_tiles_y]);
+	// NOTE: _row_offsets[row] is used as the write cursor of the row, which leaves it at the start of the next row.
+	for (u32 i{ 0 }; i < triangle_count; ++i) {
+		const triangle& tri{ _triangles[i] };
+		if (tri.min_x >= tri.max_x || tri.min_y >= tri.max_y) continue;
+		for (s32 row{ tri.min_y / (s32)tile_size }; row <= (tri.max_y - 1) / (s32)tile_size; ++row) _row_triangles[_row_offsets[row]++] = i;
+	}
+	for (u32 row{ _tiles_y }; row > 0; --row) _row_offsets[row] = _row_offsets[row - 1];
+	_row_offsets[0] = 0;
+
+	// 3. rasterize, each row of tiles is owned by one job so no pixel is written by two threads
+	JOBS::parallel_for(_tiles_y, 1, [this](u32 begin, u32 end) {
+		for (u32 row{ begin }; row < end; ++row) rasterize_tile_row(row);
+		});
+}
+
+void occlusionBuffer::rasterize_tile_row(u32 tile_row) {
+	const s32 row_min_y{ (s32)(tile_row * tile_size) };
+	const s32 row_max_y{ row_min_y + (s32)tile_size };
+	f32* const row_depth{ &_depth[(u64)row_min_y * _width] };
+	std::fill(row_depth, row_depth + (u64)tile_size * _width, 1.0f);
+
+	const XMVECTOR lane_offsets{ XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f) };
+	const XMVECTOR zero{ XMVectorZero() };
+
+	for (u32 i{ _row_offsets[tile_row] }; i < _row_offsets[tile_row + 1]; ++i) {
+		const triangle& tri{ _triangles[_row_triangles[i]] };
+		const s32 min_y{ (std::max)(tri.min_y, row_min_y) };
+		const s32 max_y{ (std::min)(tri.max_y, row_max_y) };
+		// NOTE: the width is a multiple of 4, groups of 4 pixels that start at a multiple of 4 never leave the row.
+		const s32 min_x{ tri.min_x & ~3 };
+
+		XMVECTOR edge_a[3];
+		for (u32 e{ 0 }; e < 3; ++e) edge_a[e] = XMVectorReplicate(tri.edge_a[e]);
+		const XMVECTOR depth_a{ XMVectorReplicate(tri.depth_a) };
+		const XMVECTOR four{ XMVectorReplicate(4.0f) };
+
+		for (s32 y{ min_y }; y < max_y; ++y) {
+			const f32 py{ (f32)y + 0.5f };
+			const XMVECTOR row_e0{ XMVectorReplicate(tri.edge_b[0] * py + tri.edge_c[0]) };
+			const XMVECTOR row_e1{ XMVectorReplicate(tri.edge_b[1] * py + tri.edge_c[1]) };
+			const XMVECTOR row_e2{ XMVectorReplicate(tri.edge_b[2] * py + tri.edge_c[2]) };
+			const XMVECTOR row_depth{ XMVectorReplicate(tri.depth_b * py + tri.depth_c) };
+			f32* const pixels{ &_depth[(u64)y * _width] };
+
+			// NOTE: the edge functions are evaluated directly instead of stepped, so a shared edge gives exactly opposite
+			//		 values in both triangles. Pixels on the edge are then covered by both, and a mesh has no cracks.
+			XMVECTOR px{ XMVectorAdd(XMVectorReplicate((f32)min_x), lane_offsets) };
+			for (s32 x{ min_x }; x < tri.max_x; x += 4) {
+				const XMVECTOR e0{ XMVectorMultiplyAdd(edge_a[0], px, row_e0) };
+				const XMVECTOR e1{ XMVectorMultiplyAdd(edge_a[1], px, row_e1) };
+				const XMVECTOR e2{ XMVectorMultiplyAdd(edge_a[2], px, row_e2) };
+				const XMVECTOR inside{ XMVectorAndInt(XMVectorAndInt(XMVectorGreaterOrEqual(e0, zero), XMVectorGreaterOrEqual(e1, zero)), XMVectorGreaterOrEqual(e2, zero)) };
+				if (!XMVector4EqualInt(inside, XMVectorFalseInt())) {
+					XMFLOAT4* const group{ reinterpret_cast<XMFLOAT4*>(&pixels[x]) };
+					const XMVECTOR old_depth{ XMLoadFloat4(group) };
+					const XMVECTOR depth{ XMVectorMultiplyAdd(depth_a, px, row_depth) };
+					XMStoreFloat4(group, XMVectorSelect(old_depth, XMVectorMin(old_depth, depth), inside));
+				}
+				px = XMVectorAdd(px, four);
+			}
+		}
+	}
+
+	// farthest depth of each tile in this row
+	for (u32 tile_x{ 0 }; tile_x < _tiles_x; ++tile_x) {
+		f32 max_depth{ 0.0f };
+		for (u32 y{ 0 }; y < tile_size; ++y) {
+			const f32* const pixels{ &row_depth[(u64)y * _width + tile_x * tile_size] };
+			for (u32 x{ 0 }; x < tile_size; ++x) max_depth = (std::max)(max_depth, pixels[x]);
+		}
+		_tile_max_depth[(u64)tile_row * _tiles_x + tile_x] = max_depth;
+	}
+}
+
+bool occlusionBuffer::is_visible(const SPATIAL::aabb& box) const {
+	const XMMATRIX vp{ XMLoadFloat4x4(&_view_projection) };
+	const f32 width{ (f32)_width };
+	const f32 height{ (f32)_height };
+
+	f32 min_x{ width }, min_y{ height }, max_x{ 0.0f }, max_y{ 0.0f };
+	f32 min_z{ 1.0f };
+	for (u32 i{ 0 }; i < 8; ++i) {
+		const XMFLOAT3 corner{ i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z };
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), vp));
+		if (clip.w < min_w) return true;
+
+		const screen_vertex v{ to_screen(clip, width, height) };
+		min_x = (std::min)(min_x, v.x);
+		min_y = (std::min)(min_y, v.y);
+		max_x = (std::max)(max_x, v.x);
+		max_y = (std::max)(max_y, v.y);
+		min_z = (std::min)(min_z, v.z);
+	}
+
+	// the pixels the box may cover, boxes that are completely off screen are not visible
+	const s32 x0{ (std::max)((s32)std::floor(min_x), 0) };
+	const s32 y0{ (std::max)((s32)std::floor(min_y), 0) };
+	const s32 x1{ (std::min)((s32)std::ceil(max_x), (s32)_width) };
+	const s32 y1{ (std::min)((s32)std::ceil(max_y), (s32)_height) };
+	if (x0 >= x1 || y0 >= y1) return false;
+
+	for (s32 tile_y{ y0 / (s32)tile_size }; tile_y * (s32)tile_size < y1; ++tile_y) {
+		for (s32 tile_x{ x0 / (s32)tile_size }; tile_x * (s32)tile_size < x1; ++tile_x) {
+			// the nearest point of the box is behind everything in this tile
+			if (_tile_max_depth[(u64)tile_y * _tiles_x + tile_x] < min_z) continue;
+
+			const s32 ty0{ (std::max)(y0, tile_y * (s32)tile_size) }, ty1{ (std::min)(y1, (tile_y + 1) * (s32)tile_size) };
+			const s32 tx0{ (std::max)(x0, tile_x * (s32)tile_size) }, tx1{ (std::min)(x1, (tile_x + 1) * (s32)tile_size) };
+			for (s32 y{ ty0 }; y < ty1; ++y) {
+				const f32* const pixels{ &_depth[(u64)y * _width] };
+				for (s32 x{ tx0 }; x < tx1; ++x) {
+					if (pixels[x] >= min_z) return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+u32 occlusionBuffer::test(const SPATIAL::aabb* const boxes, const u32* const indices, u32 count, u32* const visible) const {
+	PROFILE_SCOPE("Occlusion test");
+	assert((boxes && indices && visible) || !count);
+	const u32 num_chunks{ (count + test_chunk_size - 1) / test_chunk_size };
+	UTL::vector<u32> chunk_counts(num_chunks);
+
+	// NOTE: a chunk only writes to its own range of 'visible', at or before the index it reads, so 'visible' can alias 'indices'.
+	JOBS::parallel_for(count, test_chunk_size, [&](u32 begin, u32 end) {
+		u32 n{ 0 };
+		for (u32 i{ begin }; i < end; ++i) {
+			const u32 index{ indices[i] };
+			if (is_visible(boxes[index])) visible[begin + n++] = index;
+		}
+		chunk_counts[begin / test_chunk_size] = n;
+		});
+
+	u32 total{ 0 };
+	for (u32 i{ 0 }; i < num_chunks; ++i) {
+		memmove(&visible[total], &visible[i * test_chunk_size], chunk_counts[i] * sizeof(u32));
+		total += chunk_counts[i];
+	}
+	return total;
+}
+
+}
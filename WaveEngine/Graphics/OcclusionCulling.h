@@ -0,0 +1,70 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "..\Spatial\SpatialCommon.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+// A triangle mesh that hides what's behind it, e.g. the positions and indices of a (simplified) LOD of a mesh.
+struct occluder {
+	const MATH::v3*		positions;		// model space
+	const u32*			indices;		// triangle list
+	u32					vertex_count;
+	u32					index_count;
+	MATH::m4x4			world;			// model to world, row vectors like DirectXMath
+};
+
+// refs: Hasselgren et al., "Masked Software Occlusion Culling"
+//		 Intel, "Software Occlusion Culling" sample
+//
+// Low resolution depth buffer that occluders are rasterized into on the CPU, and bounding boxes are tested against.
+// - the screen is split in 8x8 pixel tiles, rows of tiles are rasterized in parallel on the job system
+// - triangles are binned to the rows of tiles they touch, so a row only visits its own triangles
+// - pixels are rasterized 4 at a time with edge functions, depth is the nearest occluder (0 = near, 1 = far)
+// - every tile keeps its farthest depth, so most box tests never touch the pixels
+class occlusionBuffer {
+public:
+	static constexpr u32 tile_size{ 8 };
+
+	// width and height are rounded up to multiples of the tile size.
+	explicit occlusionBuffer(u32 width = 320, u32 height = 192);
+	DISABLE_COPY_AND_MOVE(occlusionBuffer);
+
+	// clears the buffer and rasterizes the occluders as seen through 'view_projection' (row vectors, depth in [0, 1]).
+	// NOTE: triangles that cross the near plane are skipped, which only makes the buffer hide less.
+	void render(const occluder* const occluders, u32 count, const MATH::m4x4& view_projection);
+
+	// Tests boxes[indices[i]] for i in [0, count) against the buffer and writes the indices of the boxes that
+	// may be visible to 'visible', in the same order. Returns their number. Runs on the job system.
+	// 'indices' can be the output of GRAPHICS::cull(), 'visible' can be the same array as 'indices'.
+	u32 test(const SPATIAL::aabb* const boxes, const u32* const indices, u32 count, u32* const visible) const;
+
+	// true if any part of the box may be visible. Boxes that cross the near plane are always visible.
+	[[nodiscard]] bool is_visible(const SPATIAL::aabb& box) const;
+
+	[[nodiscard]] u32 width() const { return _width; }
+	[[nodiscard]] u32 height() const { return _height; }
+	[[nodiscard]] const f32* depth() const { return _depth.data(); }
+
+private:
+	struct triangle {
+		s32 min_x, min_y, max_x, max_y;	// pixel bounds clamped to the screen, max is exclusive
+		f32 edge_a[3], edge_b[3], edge_c[3];	// inside when edge_a * x + edge_b * y + edge_c > 0 for all 3 edges
+		f32 depth_a, depth_b, depth_c;		// depth = depth_a * x + depth_b * y + depth_c
+	};
+
+	void rasterize_tile_row(u32 tile_row);
+
+	u32								_width;
+	u32								_height;
+	u32								_tiles_x;
+	u32								_tiles_y;
+	MATH::m4x4						_view_projection{};
+	UTL::vector<f32>				_depth;			// per pixel, row major
+	UTL::vector<f32>				_tile_max_depth;	// per tile, row major
+	UTL::vector<triangle>			_triangles;
+	UTL::vector<u32>				_triangle_offsets;	// per occluder, into _triangles
+	UTL::vector<u32>				_row_triangles;		// indices into _triangles, grouped by row of tiles
+	UTL::vector<u32>				_row_offsets;		// per row of tiles + 1, into _row_triangles
+};
+
+}
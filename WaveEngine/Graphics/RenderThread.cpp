@@ -0,0 +1,114 @@
+#include "RenderThread.h"
+#include "..\Core\Profiler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace WAVEENGINE::GRAPHICS {
+
+namespace {
+
+constexpr u32 snapshot_count{ 3 };
+constexpr u32 no_snapshot{ u32_invalid_id };
+
+render_snapshot				snapshots[snapshot_count]{};
+std::thread					render_thread;
+std::mutex					snapshot_mutex;
+std::condition_variable		snapshot_cv;
+
+// every snapshot is in at most one of these states, all guarded by snapshot_mutex.
+u32							writing{ no_snapshot };
+u32							pending{ no_snapshot };
+u32							rendering{ no_snapshot };
+u64							submitted_frames{ 0 };
+u64							rendered_frame{ 0 };
+bool						running{ false };
+
+void render_snapshot_targets(const render_snapshot& snapshot) {
+	for (u32 i{ 0 }; i < snapshot.targets.size(); ++i) {
+		const render_target& target{ snapshot.targets[i] };
+		const surface s{ target.id };
+		if (!s.is_valid()) continue;
+		if (s.width() != target.width || s.height() != target.height) {
+			s.resize(target.width, target.height);
+		}
+		s.render();
+	}
+}
+
+void render_loop() {
+	PROFILE_THREAD("Render");
+	while (true) {
+		u32 index{ no_snapshot };
+		{
+			std::unique_lock lock{ snapshot_mutex };
+			// the previous snapshot is done, it can be written again.
+			if (rendering != no_snapshot) {
+				rendered_frame = snapshots[rendering].frame;
+				rendering = no_snapshot;
+			}
+			snapshot_cv.wait(lock, [] { return pending != no_snapshot || !running; });
+			if (pending == no_snapshot) break;
+
+			index = rendering = pending;
+			pending = no_snapshot;
+		}
+		PROFILE_SCOPE("Render snapshot");
+		render_snapshot_targets(snapshots[index]);
+	}
+}
+
+} // anonymous namespace
+
+bool start_render_thread() {
+	assert(!running);
+	if (running) return false;
+	writing = pending = rendering = no_snapshot;
+	running = true;
+	render_thread = std::thread{ render_loop };
+	return true;
+}
+
+void stop_render_thread() {
+	if (!running) return;
+	{
+		std::lock_guard lock{ snapshot_mutex };
+		running = false;
+	}
+	snapshot_cv.notify_one();
+	render_thread.join();
+	writing = no_snapshot;
+}
+
+render_snapshot& begin_render_snapshot() {
+	std::lock_guard lock{ snapshot_mutex };
+	assert(writing == no_snapshot);
+	// with 3 snapshots there is always one that is neither pending nor being rendered.
+	for (u32 i{ 0 }; i < snapshot_count; ++i) {
+		if (i != pending && i != rendering) {
+			writing = i;
+			break;
+		}
+	}
+	assert(writing != no_snapshot);
+	return snapshots[writing];
+}
+
+void submit_render_snapshot() {
+	{
+		std::lock_guard lock{ snapshot_mutex };
+		assert(writing != no_snapshot);
+		snapshots[writing].frame = ++submitted_frames;
+		// NOTE: a pending snapshot that wasn't picked up yet is dropped, the render thread always gets the newest frame.
+		pending = writing;
+		writing = no_snapshot;
+	}
+	snapshot_cv.notify_one();
+}
+
+u64 last_rendered_frame() {
+	std::lock_guard lock{ snapshot_mutex };
+	return rendered_frame;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "Renderer.h"
+
+namespace WAVEENGINE::GRAPHICS {
+
+// A surface to render and the size the window had when the snapshot was taken.
+struct render_target {
+	surface_id	id;
+	u32			width;
+	u32			height;
+};
+
+// Everything the render thread needs for one frame. The simulation thread fills it at the end of a frame,
+// after that the render thread only reads it.
+// NOTE: surfaces don't draw entities yet, so there are no per-entity items or a camera to copy. They belong here
+//		 once entities reference meshes.
+struct render_snapshot {
+	u64							frame;		// set by submit_render_snapshot()
+	f32							alpha;		// FRAME::alpha() when the snapshot was taken
+	UTL::vector<render_target>	targets;
+};
+
+// Starts the thread that renders the submitted snapshots. Once it runs, the surfaces are only resized and rendered
+// on the render thread, so they must be created before and removed after it runs.
+bool start_render_thread();
+
+// Renders the last submitted snapshot, if it wasn't rendered yet, and joins the render thread.
+void stop_render_thread();
+
+// Returns the snapshot to fill for the current frame. The snapshots are triple buffered: one is rendered, one waits
+// for the render thread, and one is written, so the simulation never waits for rendering. When the simulation
+// is faster, the waiting snapshot is replaced by the newer one and the older frame is not rendered.
+// NOTE: the snapshot keeps the targets of the frame it was last used for. Clear them before filling it.
+render_snapshot& begin_render_snapshot();
+
+// Hands the snapshot from begin_render_snapshot() to the render thread.
+void submit_render_snapshot();
+
+// Number of the last frame the render thread finished, 0 before the first one.
+u64 last_rendered_frame();
+
+}
@@ -40,6 +40,7 @@ bool set_platform_interface(graphics_platform platform) {
 } // anonymous namespace
 
 bool initialize(graphics_platform platform) {
+	MEMORY_TAG(graphics);
 #if USE_VULKAN
 	if (platform == graphics_platform::Vulkan) {
 		set_platform_interface(graphics_platform::Vulkan);
@@ -62,6 +63,7 @@ void shutdown() {
 }
 
 surface create_surface(PLATFORM::window window) {
+	MEMORY_TAG(graphics);
 	return gfx.surface.create(window);
 }
 
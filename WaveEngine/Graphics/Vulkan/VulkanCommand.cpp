@@ -15,7 +15,7 @@ bool vulkanCommandPool::initialize(VkDevice device, u32 queueFamilyIndex, const
     createInfo.queueFamilyIndex = queueFamilyIndex;
     createInfo.pNext = next;
 
-    VKCall(vkCreateCommandPool(_device, &createInfo, nullptr, &_pool), "::VULKAN:ERROR Failed to create a command pool\n");
+    VKCall(vkCreateCommandPool(_device, &createInfo, host_allocator(), &_pool), "::VULKAN:ERROR Failed to create a command pool\n");
     return true;
 }
 
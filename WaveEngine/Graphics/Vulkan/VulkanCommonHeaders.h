@@ -33,6 +33,10 @@ namespace WAVEENGINE::GRAPHICS::VULKAN {
 
 constexpr u32 frame_buffer_count{ 3 };
 
+// Host memory callbacks for creating and destroying every Vulkan object, they account the driver's
+// allocations to MEMORY::memory_tag::vulkan. Null when memory tracking is compiled out.
+const VkAllocationCallbacks* host_allocator();
+
 }
 
 #ifdef _WIN32
@@ -197,7 +201,7 @@ inline void debug_output(const char* message) {
 #define VK_DEFINE_PTR_TYPE_OPERATOR(ptr) operator decltype(ptr)() const { return ptr; }
 #define VK_DEFINE_ADDRESS_FUNCTION(ptr) const decltype(ptr)* Address() const { return &ptr; }
 
-#define VK_DESTROY_PTR_BY(Func, device, ptr) if(ptr) { Func(device, ptr, nullptr); ptr = VK_NULL_HANDLE; }
+#define VK_DESTROY_PTR_BY(Func, device, ptr) if(ptr) { Func(device, ptr, ::WAVEENGINE::GRAPHICS::VULKAN::host_allocator()); ptr = VK_NULL_HANDLE; }
 
 ////////////////////////////////////////// MOVE CONSTRUCTOR ///////////////////////////////////////
 
@@ -234,7 +238,7 @@ inline void debug_output(const char* message) {
 		cName& operator=(cName&& other) noexcept {									\
 			if(this != &other) {													\
 				if(p0 != VK_NULL_HANDLE) {											\
-					destroyFunc(_device, p0, nullptr);								\
+					destroyFunc(_device, p0, ::WAVEENGINE::GRAPHICS::VULKAN::host_allocator());	\
 				}																	\
 				VK_MOVE_PTR(p0)														\
 			}																		\
@@ -245,7 +249,7 @@ inline void debug_output(const char* message) {
 		cName& operator=(cName&& other) noexcept {									\
 			if(this != &other) {													\
 				if (handlePtr != VK_NULL_HANDLE) {									\
-					destroyFunc(devicePtr, handlePtr, nullptr);						\
+					destroyFunc(devicePtr, handlePtr, ::WAVEENGINE::GRAPHICS::VULKAN::host_allocator());	\
 				}																	\
 				VK_MOVE_PTR(handlePtr)												\
 				VK_MOVE_PTR(devicePtr)												\
@@ -86,7 +86,7 @@ void vulkanContext::setupDebugMessenger() const{
 	VkDebugUtilsMessengerCreateInfoEXT createInfo;
 	populateDebugMessengerCreateInfo(createInfo);
 
-	VKCall(CreateDebugUtilsMessengerEXT(_instanceContext._instance, &createInfo, nullptr, &_callback), "::VULKAN:ERROR Failed to set up debug callback\n");
+	VKCall(CreateDebugUtilsMessengerEXT(_instanceContext._instance, &createInfo, _instanceContext._allocator, &_callback), "::VULKAN:ERROR Failed to set up debug callback\n");
 
 #ifdef _DEBUG
 	debug_output("::VULKAN:INFO debug messenger successfully set up\n");
@@ -171,7 +171,8 @@ VkResult vulkanContext::createInstance() {
         instanceInfo.enabledLayerCount = 0;
     }
 
-    VKCall(vkCreateInstance(&instanceInfo, nullptr, &_instanceContext._instance), "::VULKAN:ERROR Failed to create instance\n");
+    _instanceContext._allocator = host_allocator();
+    VKCall(vkCreateInstance(&instanceInfo, _instanceContext._allocator, &_instanceContext._instance), "::VULKAN:ERROR Failed to create instance\n");
 
 	// TODO add instance callback
 
@@ -348,7 +349,8 @@ VkResult vulkanContext::createLogicalDevice() {
 		createInfo.enabledLayerCount = 0;
 	}
 
-	VKCall(vkCreateDevice(_adapterContext._physicalDevice, &createInfo, nullptr, &_deviceContext._device), "::VULKAN:ERROR Failed to create vulkan device\n");
+	_deviceContext._allocator = host_allocator();
+	VKCall(vkCreateDevice(_adapterContext._physicalDevice, &createInfo, _deviceContext._allocator, &_deviceContext._device), "::VULKAN:ERROR Failed to create vulkan device\n");
 
 	_deviceContext._graphicsQueue.initialize(_deviceContext._device, indices.graphicsFamily);
 	// assume that present queue is same as graphics queue
@@ -6,6 +6,7 @@
 #include "VulkanSync.h"
 #include "VulkanFramebuffer.h"
 #include "VulkanRenderTarget.h"
+#include "..\..\Core\Profiler.h"
 
 namespace WAVEENGINE::GRAPHICS::VULKAN::CORE {
 
@@ -573,6 +574,7 @@ u32 surface_height(surface_id id) {
 }
 
 void render_surface(surface_id id) {
+	PROFILE_FUNCTION();
 	const u32 frame_idx = current_frame_index();
 	frameContext& frame_data = frames_data[frame_idx];
 	perFrameResources& frame_resources = per_frame_resources[frame_idx];
@@ -580,7 +582,10 @@ void render_surface(surface_id id) {
 	assert(frame_data.frame_index == frame_idx);
 
 	// wait for completion of current frame
-	frame_data.fence.wait(VK_TRUE, UINT64_MAX);
+	{
+		PROFILE_SCOPE("Wait for frame fence");
+		frame_data.fence.wait(VK_TRUE, UINT64_MAX);
+	}
 
 	per_frame_pool[frame_idx].begin_frame(frame_idx);
 	deferred_pool.begin_frame(frame_idx);
@@ -632,57 +637,67 @@ void render_surface(surface_id id) {
 
 	// TODO =======================================================================================
 
-	// reset and begin recording
-	frame_data.graphics_cmd_buffer.resetCmd();
-	frame_data.graphics_cmd_buffer.beginCmd();
+	{
+		PROFILE_SCOPE("Record commands");
+		// reset and begin recording
+		frame_data.graphics_cmd_buffer.resetCmd();
+		frame_data.graphics_cmd_buffer.beginCmd();
 
-	frame_data.render_encoder = { frame_data.graphics_cmd_buffer, render_passes.forward, swapchains[id].framebuffer(image_index) };
+		frame_data.render_encoder = { frame_data.graphics_cmd_buffer, render_passes.forward, swapchains[id].framebuffer(image_index) };
 
-	assert(image_index < frame_buffer_count && "Swap chain image index out of range");
+		assert(image_index < frame_buffer_count && "Swap chain image index out of range");
 
-	auto& render_encoder = frame_data.render_encoder;
+		auto& render_encoder = frame_data.render_encoder;
 
-	VkRect2D render_area{};
-	render_area.offset = { 0, 0 };
-	render_area.extent = swapchains[id].extent();
+		VkRect2D render_area{};
+		render_area.offset = { 0, 0 };
+		render_area.extent = swapchains[id].extent();
 	
-	UTL::vector<VkClearValue> clear_values(2);
-	clear_values[0].color = { {0.1f, 0.1f, 0.15f, 1.0f} };  
-	clear_values[1].depthStencil = { 1.0f, 0 };
-
-	// forward - forwardOpaque 
-	{
-		render_encoder.beginRender(render_area, clear_values.data(), clear_values.size());
-
-		render_encoder.setViewport(0, 0,
-			static_cast<float>(swapchains[id].extent().width),
-			static_cast<float>(swapchains[id].extent().height),
-			0.0f, 1.0f);
-		render_encoder.setScissor(render_area);
-
-		render_encoder.bindPipeline(pipelines.forwardOpaque);
+		UTL::vector<VkClearValue> clear_values(2);
+		clear_values[0].color = { {0.1f, 0.1f, 0.15f, 1.0f} };  
+		clear_values[1].depthStencil = { 1.0f, 0 };
+
+		// forward - forwardOpaque 
+		{
+			render_encoder.beginRender(render_area, clear_values.data(), clear_values.size());
+
+			render_encoder.setViewport(0, 0,
+				static_cast<float>(swapchains[id].extent().width),
+				static_cast<float>(swapchains[id].extent().height),
+				0.0f, 1.0f);
+			render_encoder.setScissor(render_area);
+
+			render_encoder.bindPipeline(pipelines.forwardOpaque);
+
+			VkDescriptorSet sets[] = { frame_resources.descriptorSet.set() };
+			render_encoder.bindDescriptorSets(
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				forward_pipeline_layout.handle(),
+				0,
+				sets,1,
+				nullptr, 0
+			);
 
-		VkDescriptorSet sets[] = { frame_resources.descriptorSet.set() };
-		render_encoder.bindDescriptorSets(
-			VK_PIPELINE_BIND_POINT_GRAPHICS,
-			forward_pipeline_layout.handle(),
-			0,
-			sets,1,
-			nullptr, 0
-		);
+			render_encoder.draw(3, 1, 0, 0);
 
-		render_encoder.draw(3, 1, 0, 0);
+			render_encoder.endRender();
+			render_encoder.reset();
+		}
 
-		render_encoder.endRender();
-		render_encoder.reset();
+		frame_data.graphics_cmd_buffer.endCmd();
 	}
 
-	frame_data.graphics_cmd_buffer.endCmd();
-
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	vk_ctx.graphics_queue().submit(frame_data, waitStages);
+	{
+		PROFILE_SCOPE("Submit");
+		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		vk_ctx.graphics_queue().submit(frame_data, waitStages);
+	}
 
-	VkResult present_result = vk_ctx.present_queue().present(frame_data, swapchains[id].swapchain(), image_index, nullptr);
+	VkResult present_result{ VK_SUCCESS };
+	{
+		PROFILE_SCOPE("Present");
+		present_result = vk_ctx.present_queue().present(frame_data, swapchains[id].swapchain(), image_index, nullptr);
+	}
 
 	if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR) {
 #ifdef _DEBUG
@@ -1,6 +1,50 @@
 ﻿#include "VulkanMemory.h"
 
 namespace WAVEENGINE::GRAPHICS::VULKAN {
+
+namespace {
+
+// NOTE: MEMORY already aligns to 16 bytes, larger alignments are padded.
+size_t host_alignment(size_t alignment) {
+    return (std::max)(alignment, (size_t)16);
+}
+
+void* VKAPI_PTR allocate_host_memory(void*, size_t size, size_t alignment, VkSystemAllocationScope) {
+    return MEMORY::allocate(size, MEMORY::memory_tag::vulkan, host_alignment(alignment));
+}
+
+void* VKAPI_PTR reallocate_host_memory(void*, void* original, size_t size, size_t alignment, VkSystemAllocationScope) {
+    if (!original) return MEMORY::allocate(size, MEMORY::memory_tag::vulkan, host_alignment(alignment));
+    if (!size) {
+        MEMORY::release(original);
+        return nullptr;
+    }
+    return MEMORY::reallocate(original, size, host_alignment(alignment));
+}
+
+void VKAPI_PTR free_host_memory(void*, void* memory) {
+    MEMORY::release(memory);
+}
+
+const VkAllocationCallbacks host_callbacks{
+    nullptr,
+    allocate_host_memory,
+    reallocate_host_memory,
+    free_host_memory,
+    nullptr,
+    nullptr
+};
+
+} // anonymous namespace
+
+const VkAllocationCallbacks* host_allocator() {
+#if USE_MEMORY_TRACKING
+    return &host_callbacks;
+#else
+    return nullptr;
+#endif
+}
+
 ///////////////////////////////////////////////////// VULKAN DEVICE MEMORY //////////////////////////////////////////////////////
 
 vulkanDeviceMemory::vulkanDeviceMemory(VkPhysicalDevice physicalDevice,
@@ -135,7 +179,7 @@ VkResult vulkanDeviceMemory::allocate(VkMemoryAllocateInfo& allocateInfo, VkPhys
         return VK_RESULT_MAX_ENUM;
     }
     allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    if (VkResult result = vkAllocateMemory(_device, &allocateInfo, nullptr, &_device_memory)) {
+    if (VkResult result = vkAllocateMemory(_device, &allocateInfo, host_allocator(), &_device_memory)) {
         debug_error("::VULKAN:ERROR Failed to allocate memory\n");
         return result;
     }
@@ -10,7 +10,7 @@ struct pipelineLayoutImpl {
 
     ~pipelineLayoutImpl() {
         if (layout != VK_NULL_HANDLE) {
-            vkDestroyPipelineLayout(device, layout, nullptr);
+            vkDestroyPipelineLayout(device, layout, host_allocator());
         }
     }
 };
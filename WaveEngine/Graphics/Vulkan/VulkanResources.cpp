@@ -110,7 +110,7 @@ bool vulkanDescriptorPool::initialize(VkDevice device, VkDescriptorPoolCreateInf
 
 	std::lock_guard lock{ _mutex };
 
-	if (VkResult result = vkCreateDescriptorPool(_device, &createInfo, nullptr, &_pool)) {
+	if (VkResult result = vkCreateDescriptorPool(_device, &createInfo, host_allocator(), &_pool)) {
 		debug_error("::VULKAN:ERROR Failed to create descriptor pool\n");
 		return false;
 	}
@@ -384,7 +384,7 @@ void vulkanDescriptorPool::release() {
 			process_deferred_free();
 		}
 
-		vkDestroyDescriptorPool(_device, _pool, nullptr);
+		vkDestroyDescriptorPool(_device, _pool, host_allocator());
 		_pool = VK_NULL_HANDLE;
 
 #ifdef _DEBUG
@@ -396,7 +396,7 @@ void vulkanDescriptorPool::release() {
 	// release all overflow pools
 	for (auto overflow_pool : _overflow_pools) {
 		if (overflow_pool != VK_NULL_HANDLE) {
-			vkDestroyDescriptorPool(_device, overflow_pool, nullptr);
+			vkDestroyDescriptorPool(_device, overflow_pool, host_allocator());
 		}
 	}
 	_overflow_pools.clear();
@@ -421,7 +421,7 @@ bool vulkanDescriptorPool::create_overflow_pool() {
 	createInfo.flags = get_policy_flags();
 
 	VkDescriptorPool overflow_pool = VK_NULL_HANDLE;
-	VkResult result = vkCreateDescriptorPool(_device, &createInfo, nullptr, &overflow_pool);
+	VkResult result = vkCreateDescriptorPool(_device, &createInfo, host_allocator(), &overflow_pool);
 
 	if (result == VK_SUCCESS) {
 		_overflow_pools.push_back(overflow_pool);
@@ -10,7 +10,7 @@ struct descriptorSetLayoutImpl {
 
 	~descriptorSetLayoutImpl() {
 		if (layout != VK_NULL_HANDLE) {
-			vkDestroyDescriptorSetLayout(device, layout, nullptr);
+			vkDestroyDescriptorSetLayout(device, layout, host_allocator());
 		}
 	}
 };
@@ -9,65 +9,34 @@ namespace {
 
 std::array<std::vector<u32>, engineShader::id::count> engine_shaders;
 
-std::unique_ptr<u8[]> shaders_blob{};
-
+// The blob is an array of shader byte code consisting of an u64 size and an array of bytes.
+// NOTE: the SPIR-V words are copied out of the mapping, so the file is unmapped right after loading.
 bool load_engine_shaders() {
-    auto engine_shades_path = get_engine_shaders_path();
-    if (!std::filesystem::exists(engine_shades_path)) return false;
-
-    std::ifstream file(engine_shades_path, std::ios::in | std::ios::binary);
-    if (!file) return false;
-
-    u32 index = 0;
-    while (file.peek() != EOF && index < engineShader::id::count) {
-        // read u64
-        size_t byte_size = 0;
-        file.read(reinterpret_cast<char*>(&byte_size), sizeof(byte_size));
-
-        if (byte_size == 0) break;
-
-        // compute # of u32
-        size_t u32_count = byte_size / sizeof(u32);
-        engine_shaders[index].resize(u32_count);
-        file.read(reinterpret_cast<char*>(engine_shaders[index].data()), byte_size);
-        ++index;
-    }
-    file.close();
-    return index == engineShader::id::count;
-}
-
-// for specific memory layout
-bool load_engine_shaders_raw() {
-    assert(!shaders_blob);
-    u64 size{ 0 };
-    bool result{ CONTENT::load_engine_shaders(shaders_blob, size) };
-
-    assert(shaders_blob && size);
+    PLATFORM::mappedFile shaders_blob{};
+    if (!CONTENT::load_engine_shaders(shaders_blob)) return false;
+    shaders_blob.advise(PLATFORM::access_pattern::sequential);
 
+    const u8* const blob{ shaders_blob.data() };
+    const u64 size{ shaders_blob.size() };
     u64 offset{ 0 };
     u32 index{ 0 };
-    while (offset < size && result) {
-        assert(index < engineShader::id::count);
-        result &= index < engineShader::id::count;
-        if (!result) break;
-
+    while (offset + sizeof(u64) <= size && index < engineShader::id::count) {
         // read size
-        size_t byte_size = *reinterpret_cast<size_t*>(&shaders_blob[offset]);
-        offset += sizeof(size_t);
+        u64 byte_size{ 0 };
+        memcpy(&byte_size, &blob[offset], sizeof(byte_size));
+        offset += sizeof(u64);
+        if (byte_size == 0 || offset + byte_size > size) break;
 
         // load u32 to vector
-        size_t u32_count = byte_size / sizeof(u32);
-        engine_shaders[index].assign(
-            reinterpret_cast<u32*>(&shaders_blob[offset]),
-            reinterpret_cast<u32*>(&shaders_blob[offset] + byte_size)
-        );
+        const u64 u32_count{ byte_size / sizeof(u32) };
+        engine_shaders[index].resize(u32_count);
+        memcpy(engine_shaders[index].data(), &blob[offset], u32_count * sizeof(u32));
 
         offset += byte_size;
         ++index;
     }
-    assert(offset == size && index == engineShader::id::count);
-
-    return result;
+    assert(offset == size);
+    return index == engineShader::id::count;
 }
 
 const std::vector<u32>* get_engine_shader(engineShader::id id) {
@@ -88,7 +57,6 @@ void unloadEngineShaders() {
     for (auto& shader : engine_shaders) {
         shader.clear();
     }
-    shaders_blob.reset();
 }
 
 VkShaderStageFlagBits vulkanShader::vkStage() const {
@@ -120,7 +88,7 @@ VkResult vulkanShader::create(VkDevice device, engineShader::id shaderId) {
     createInfo.codeSize = spir_v->size() * sizeof(u32);
     createInfo.pCode = spir_v->data();
 
-    if (VkResult result = vkCreateShaderModule(_device, &createInfo, nullptr, &_shaderModule)) {
+    if (VkResult result = vkCreateShaderModule(_device, &createInfo, host_allocator(), &_shaderModule)) {
         debug_error("::VULKAN:ERROR Failed to create shader\n");
         return result;
     }
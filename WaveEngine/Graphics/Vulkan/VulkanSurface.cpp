@@ -19,7 +19,7 @@ bool vulkanSurface::create(const instanceContext& ctx) {
     // TODO get window handle in MacOS / IOS
     createInfo.pNext = nullptr;
     createInfo.flags = 0;
-    VKCall(vkCreateMetalSurfaceEXT(instance, &createInfo, nullptr, &_surface), "::VULKAN:ERROR Failed to create a Metal surface");
+    VKCall(vkCreateMetalSurfaceEXT(instance, &createInfo, host_allocator(), &_surface), "::VULKAN:ERROR Failed to create a Metal surface");
 #elif defined(__linux__)
 
     // TODO wayland / x11
@@ -30,7 +30,7 @@ bool vulkanSurface::create(const instanceContext& ctx) {
     // TODO get window handle in android
     createInfo.sNext = nullptr;
     createInfo.flags = 0;
-    VKCall(vkCreateAndroidSurfaceKHR(instance, &createInfo, nullptr, &_surface), "::VULKAN:ERROR Failed to create an Android surface");
+    VKCall(vkCreateAndroidSurfaceKHR(instance, &createInfo, host_allocator(), &_surface), "::VULKAN:ERROR Failed to create an Android surface");
 #else
     debug_error("Unsupported platform");
 #endif
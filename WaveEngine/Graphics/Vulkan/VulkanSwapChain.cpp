@@ -123,7 +123,7 @@ void vulkanSwapChain::create() {
     createInfo.clipped = VK_TRUE;
     createInfo.oldSwapchain = VK_NULL_HANDLE; // TODO if we have old swap chain
 
-    VKCall(vkCreateSwapchainKHR(_device, &createInfo, nullptr, &_swap_chain), "::VULKAN:ERROR Failed to create a swap chain\n");
+    VKCall(vkCreateSwapchainKHR(_device, &createInfo, host_allocator(), &_swap_chain), "::VULKAN:ERROR Failed to create a swap chain\n");
 
     vkGetSwapchainImagesKHR(_device, _swap_chain, &imageCount, nullptr);
     _color_images.resize(imageCount);
@@ -189,7 +189,7 @@ void vulkanSwapChain::release() {
     // TODO before clean swap chain we should clean all resources
     _color_image_views.clear();
     if (_swap_chain != VK_NULL_HANDLE) {
-        vkDestroySwapchainKHR(_device, _swap_chain, nullptr);
+        vkDestroySwapchainKHR(_device, _swap_chain, host_allocator());
         _swap_chain = VK_NULL_HANDLE;
     }
 }
@@ -154,7 +154,7 @@ VkResult vulkanEvent::create(const deviceContext& dCtx, VkEventCreateFlags flags
     createInfo.flags = flags;
     createInfo.pNext = next;
 
-    if (VkResult result = vkCreateEvent(_device, &createInfo, nullptr, &_event)) {
+    if (VkResult result = vkCreateEvent(_device, &createInfo, host_allocator(), &_event)) {
         debug_error("::VULKAN:ERROR Failed to create an event\n");
         return result;
     }
@@ -0,0 +1,195 @@
+#include "FileWatcher.h"
+#include <algorithm>
+
+#ifdef _WIN64
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+namespace WAVEENGINE::PLATFORM {
+
+namespace {
+
+void add_changed_file(std::vector<std::filesystem::path>& changed, std::filesystem::path&& path) {
+	if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+		changed.emplace_back(std::move(path));
+	}
+}
+
+} // anonymous namespace
+
+#ifdef _WIN64
+
+struct fileWatcher::watch_state {
+	HANDLE		directory{ INVALID_HANDLE_VALUE };
+	OVERLAPPED	overlapped{};
+	// NOTE: the notifications are DWORD aligned.
+	alignas(DWORD) u8 buffer[64 * 1024];
+
+	bool read_changes() {
+		ResetEvent(overlapped.hEvent);
+		return ReadDirectoryChangesW(directory, &buffer[0], sizeof(buffer), TRUE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, nullptr, &overlapped, nullptr);
+	}
+};
+
+bool fileWatcher::open(const std::filesystem::path& directory) {
+	close();
+	auto state{ std::make_unique<watch_state>() };
+	state->directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (state->directory == INVALID_HANDLE_VALUE) return false;
+
+	state->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (!state->overlapped.hEvent || !state->read_changes()) {
+		if (state->overlapped.hEvent) CloseHandle(state->overlapped.hEvent);
+		CloseHandle(state->directory);
+		return false;
+	}
+
+	_directory = directory;
+	_state = std::move(state);
+	return true;
+}
+
+void fileWatcher::close() {
+	if (!_state) return;
+	// the read has to finish before its buffer is freed.
+	CancelIoEx(_state->directory, &_state->overlapped);
+	DWORD bytes{ 0 };
+	GetOverlappedResult(_state->directory, &_state->overlapped, &bytes, TRUE);
+	CloseHandle(_state->overlapped.hEvent);
+	CloseHandle(_state->directory);
+	_state.reset();
+}
+
+watch_result fileWatcher::poll(std::vector<std::filesystem::path>& changed) {
+	if (!_state) return watch_result::unchanged;
+
+	watch_result result{ watch_result::unchanged };
+	DWORD bytes{ 0 };
+	while (true) {
+		// NOTE: changes that don't fit into the buffer are lost, which is reported as 0 bytes or ERROR_NOTIFY_ENUM_DIR.
+		const bool is_complete{ GetOverlappedResult(_state->directory, &_state->overlapped, &bytes, FALSE) != FALSE };
+		if (!is_complete && GetLastError() != ERROR_NOTIFY_ENUM_DIR) break;
+		if (!is_complete) bytes = 0;
+		result = !bytes ? watch_result::overflow : (std::max)(result, watch_result::changed);
+
+		// the file names are relative to the watched directory, also for files in subdirectories.
+		const u8* at{ &_state->buffer[0] };
+		while (bytes) {
+			const FILE_NOTIFY_INFORMATION* const info{ reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(at) };
+			if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+				add_changed_file(changed, _directory / std::wstring{ info->FileName, info->FileNameLength / sizeof(WCHAR) });
+			}
+			if (!info->NextEntryOffset) break;
+			at += info->NextEntryOffset;
+		}
+
+		if (!_state->read_changes()) {
+			close();
+			break;
+		}
+	}
+	return result;
+}
+
+#else
+
+struct fileWatcher::watch_state {
+	int notify{ -1 };
+	// inotify doesn't watch subdirectories, so every directory has a watch of its own.
+	std::unordered_map<int, std::filesystem::path> directories;
+
+	bool add_watch(const std::filesystem::path& directory) {
+		// NOTE: IN_CLOSE_WRITE and IN_MOVED_TO are only sent when a file is complete, unlike IN_MODIFY.
+		const int watch{ inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR) };
+		if (watch < 0) return false;
+		directories[watch] = directory;
+		return true;
+	}
+
+	bool add_watches(const std::filesystem::path& directory) {
+		if (!add_watch(directory)) return false;
+		std::error_code error{};
+		for (std::filesystem::recursive_directory_iterator it{ directory, error }, end; !error && it != end; it.increment(error)) {
+			if (it->is_directory(error)) add_watch(it->path());
+		}
+		return true;
+	}
+};
+
+bool fileWatcher::open(const std::filesystem::path& directory) {
+	close();
+	auto state{ std::make_unique<watch_state>() };
+	state->notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (state->notify < 0) return false;
+	if (!state->add_watches(directory)) {
+		::close(state->notify);
+		return false;
+	}
+
+	_directory = directory;
+	_state = std::move(state);
+	return true;
+}
+
+void fileWatcher::close() {
+	if (!_state) return;
+	::close(_state->notify);
+	_state.reset();
+}
+
+watch_result fileWatcher::poll(std::vector<std::filesystem::path>& changed) {
+	if (!_state) return watch_result::unchanged;
+
+	watch_result result{ watch_result::unchanged };
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length{ 0 };
+	while ((length = read(_state->notify, &buffer[0], sizeof(buffer))) > 0) {
+		result = (std::max)(result, watch_result::changed);
+		for (const char* at{ &buffer[0] }; at < &buffer[0] + length;) {
+			const inotify_event* const event{ reinterpret_cast<const inotify_event*>(at) };
+			at += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				result = watch_result::overflow;
+				continue;
+			}
+			const auto directory{ _state->directories.find(event->wd) };
+			if (!event->len || directory == _state->directories.end()) continue;
+
+			std::filesystem::path path{ directory->second / event->name };
+			if (event->mask & IN_ISDIR) {
+				// files may have been written to a new directory before it was watched, they are reported now.
+				if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && _state->add_watches(path)) {
+					std::error_code error{};
+					for (std::filesystem::recursive_directory_iterator it{ path, error }, end; !error && it != end; it.increment(error)) {
+						if (it->is_regular_file(error)) add_changed_file(changed, std::filesystem::path{ it->path() });
+					}
+				}
+			}
+			else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+				add_changed_file(changed, std::move(path));
+			}
+		}
+	}
+	return result;
+}
+
+#endif
+
+fileWatcher::fileWatcher() = default;
+fileWatcher::~fileWatcher() { close(); }
+
+bool fileWatcher::is_valid() const {
+	return _state != nullptr;
+}
+
+}
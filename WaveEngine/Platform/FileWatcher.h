@@ -0,0 +1,40 @@
+#pragma once
+#include "CommonHeaders.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace WAVEENGINE::PLATFORM {
+
+enum class watch_result : u32 {
+	unchanged,
+	changed,
+	overflow,		// the system dropped notifications, any file in the directory may have changed
+};
+
+// Reports the files that are created, written or renamed in a directory and its subdirectories.
+// It is polled, so it doesn't need a thread of its own.
+class fileWatcher {
+public:
+	fileWatcher();
+	~fileWatcher();
+	DISABLE_COPY_AND_MOVE(fileWatcher);
+
+	bool open(const std::filesystem::path& directory);
+	void close();
+
+	// Adds the files that changed since the last call to 'changed', if they aren't in it yet. Doesn't block.
+	// Returns changed if there were any changes, also when all of their files were already in 'changed'.
+	// Returns overflow when changes were lost, then 'changed' is incomplete and every file has to be treated as changed.
+	watch_result poll(std::vector<std::filesystem::path>& changed);
+
+	[[nodiscard]] bool is_valid() const;
+
+private:
+	struct watch_state;
+
+	std::filesystem::path			_directory;
+	std::unique_ptr<watch_state>	_state;
+};
+
+}
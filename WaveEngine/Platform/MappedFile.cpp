@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+
+#ifdef _WIN64
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WAVEENGINE::PLATFORM {
+
+namespace {
+
+#ifdef _WIN64
+
+const u8* map_file(const std::filesystem::path& path, u64& size) {
+	HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+	LARGE_INTEGER file_size{};
+	const u8* data{ nullptr };
+	// NOTE: empty files can't be mapped.
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		HANDLE mapping{ CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+		if (mapping) {
+			data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			// the view keeps the mapping and the file open.
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+
+	size = data ? (u64)file_size.QuadPart : 0;
+	return data;
+}
+
+void unmap_file(const u8* data, u64) {
+	UnmapViewOfFile(data);
+}
+
+void advise_range(const u8* data, u64 size, access_pattern pattern) {
+	switch (pattern) {
+	case access_pattern::will_need: {
+		WIN32_MEMORY_RANGE_ENTRY range{ const_cast<u8*>(data), (SIZE_T)size };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+		break;
+	}
+	case access_pattern::dont_need:
+		// NOTE: unlocking pages that aren't locked removes them from the working set (and fails, which is expected).
+		VirtualUnlock(const_cast<u8*>(data), (SIZE_T)size);
+		break;
+	default:
+		// Windows only has access pattern hints when opening a file, which don't apply to mapped views.
+		break;
+	}
+}
+
+#else
+
+const u8* map_file(const std::filesystem::path& path, u64& size) {
+	const int file{ ::open(path.c_str(), O_RDONLY) };
+	if (file < 0) return nullptr;
+
+	struct stat info {};
+	void* data{ MAP_FAILED };
+	if (!fstat(file, &info) && info.st_size > 0) {
+		data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	// the mapping keeps the file open.
+	::close(file);
+
+	if (data == MAP_FAILED) return nullptr;
+	size = (u64)info.st_size;
+	return static_cast<const u8*>(data);
+}
+
+void unmap_file(const u8* data, u64 size) {
+	munmap(const_cast<u8*>(data), size);
+}
+
+void advise_range(const u8* data, u64 size, access_pattern pattern) {
+	constexpr int advice[]{ MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+	static_assert(std::size(advice) == (u32)access_pattern::count);
+	madvise(const_cast<u8*>(data), size, advice[(u32)pattern]);
+}
+
+#endif
+
+} // anonymous namespace
+
+mappedFile& mappedFile::operator=(mappedFile&& o) noexcept {
+	if (this != &o) {
+		close();
+		_data = o._data;
+		_size = o._size;
+		o._data = nullptr;
+		o._size = 0;
+	}
+	return *this;
+}
+
+bool mappedFile::open(const std::filesystem::path& path) {
+	close();
+	_data = map_file(path, _size);
+	return is_valid();
+}
+
+void mappedFile::close() {
+	if (_data) {
+		unmap_file(_data, _size);
+	}
+	_data = nullptr;
+	_size = 0;
+}
+
+void mappedFile::advise(access_pattern pattern, u64 offset, u64 size) const {
+	assert(is_valid() && offset <= _size && pattern < access_pattern::count);
+	if (!is_valid() || offset >= _size) return;
+	if (!size || size > _size - offset) size = _size - offset;
+
+	// the hints work on whole pages, so the range is extended to the page that contains 'offset'.
+	constexpr u64 page_size{ 4096 };
+	const u64 first{ offset & ~(page_size - 1) };
+	advise_range(_data + first, size + offset - first, pattern);
+}
+
+}
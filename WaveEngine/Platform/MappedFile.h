@@ -0,0 +1,44 @@
+#pragma once
+#include "CommonHeaders.h"
+#include <filesystem>
+
+namespace WAVEENGINE::PLATFORM {
+
+// How a range of a mapped file is going to be read, so the OS can read ahead or drop pages.
+enum class access_pattern : u32 {
+	normal,
+	sequential,		// read once from start to end
+	random,
+	will_need,		// start reading the range into memory now
+	dont_need,		// the range can be paged out, it is read from the file again if touched later
+
+	count
+};
+
+// A read-only view of a whole file. The pages are read on first access and, because they are backed by the file,
+// the OS can drop them under memory pressure without writing them to the page file.
+class mappedFile {
+public:
+	mappedFile() = default;
+	~mappedFile() { close(); }
+	DISABLE_COPY(mappedFile);
+	mappedFile(mappedFile&& o) noexcept : _data{ o._data }, _size{ o._size } { o._data = nullptr; o._size = 0; }
+	mappedFile& operator=(mappedFile&& o) noexcept;
+
+	// Maps the file and returns true, or returns false if it doesn't exist, is empty or can't be mapped.
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	// 'size' 0 applies the hint to the rest of the file. Hints are best effort and may be ignored.
+	void advise(access_pattern pattern, u64 offset = 0, u64 size = 0) const;
+
+	[[nodiscard]] constexpr const u8* data() const { return _data; }
+	[[nodiscard]] constexpr u64 size() const { return _size; }
+	[[nodiscard]] constexpr bool is_valid() const { return _data != nullptr; }
+
+private:
+	const u8*	_data{ nullptr };
+	u64			_size{ 0 };
+};
+
+}
@@ -0,0 +1,316 @@
+#include "DynamicBVH.h"
+
+namespace WAVEENGINE::SPATIAL {
+
+u32 dynamicBVH::add(const aabb& bounds, ID::id_type user_data) {
+	const u32 proxy{ allocate_node() };
+	node& leaf{ _nodes[proxy] };
+	leaf.bounds = fatten(bounds, _margin);
+	leaf.user_data = user_data;
+	leaf.height = 0;
+
+	insert_leaf(proxy);
+	++_proxy_count;
+	return proxy;
+}
+
+void dynamicBVH::remove(u32 proxy) {
+	assert(proxy < _nodes.size() && _nodes[proxy].is_leaf());
+	remove_leaf(proxy);
+	free_node(proxy);
+	--_proxy_count;
+}
+
+bool dynamicBVH::move(u32 proxy, const aabb& bounds) {
+	assert(proxy < _nodes.size() && _nodes[proxy].is_leaf());
+	if (contains(_nodes[proxy].bounds, bounds)) return false;
+
+	remove_leaf(proxy);
+	_nodes[proxy].bounds = fatten(bounds, _margin);
+	insert_leaf(proxy);
+	return true;
+}
+
+void dynamicBVH::clear() {
+	_nodes.clear();
+	_root = u32_invalid_id;
+	_free_node = u32_invalid_id;
+	_proxy_count = 0;
+}
+
+bool dynamicBVH::validate() const {
+	if (_root == u32_invalid_id) return _proxy_count == 0;
+	if (_root >= _nodes.size() || _nodes[_root].parent != u32_invalid_id) return false;
+
+	u32 stack[256];
+	u32 count{ 0 };
+	u32 leaf_count{ 0 };
+	u32 node_count{ 0 };
+	stack[count++] = _root;
+	while (count) {
+		const u32 index{ stack[--count] };
+		const node& n{ _nodes[index] };
+		++node_count;
+		if (n.is_leaf()) {
+			++leaf_count;
+			continue;
+		}
+
+		if (n.height < 1 || n.child1 >= _nodes.size() || n.child2 >= _nodes.size()) return false;
+		const node& c1{ _nodes[n.child1] };
+		const node& c2{ _nodes[n.child2] };
+		if (c1.parent != index || c2.parent != index || c1.height < 0 || c2.height < 0) return false;
+		if (n.height != 1 + (std::max)(c1.height, c2.height)) return false;
+		if (!contains(n.bounds, c1.bounds) || !contains(n.bounds, c2.bounds)) return false;
+		if (count + 2 > _countof(stack)) return false;
+		stack[count++] = n.child1;
+		stack[count++] = n.child2;
+	}
+
+	// every node is either in the tree or in the free list.
+	u32 free_count{ 0 };
+	for (u32 index{ _free_node }; index != u32_invalid_id && free_count <= _nodes.size(); index = _nodes[index].parent) {
+		if (_nodes[index].height != -1) return false;
+		++free_count;
+	}
+	return leaf_count == _proxy_count && node_count + free_count == _nodes.size();
+}
+
+u32 dynamicBVH::max_balance() const {
+	u32 result{ 0 };
+	for (const node& n : _nodes) {
+		if (n.height < 2) continue;
+		const s32 balance{ _nodes[n.child2].height - _nodes[n.child1].height };
+		result = (std::max)(result, (u32)(balance < 0 ? -balance : balance));
+	}
+	return result;
+}
+
+u32 dynamicBVH::allocate_node() {
+	u32 index{ _free_node };
+	if (index == u32_invalid_id) {
+		index = (u32)_nodes.size();
+		_nodes.emplace_back();
+	}
+	else {
+		_free_node = _nodes[index].parent;
+		_nodes[index] = node{};
+	}
+	return index;
+}
+
+void dynamicBVH::free_node(u32 index) {
+	assert(index < _nodes.size());
+	node& n{ _nodes[index] };
+	n.parent = _free_node;
+	n.child1 = n.child2 = u32_invalid_id;
+	n.height = -1;
+	_free_node = index;
+}
+
+void dynamicBVH::insert_leaf(u32 leaf) {
+	if (_root == u32_invalid_id) {
+		_root = leaf;
+		_nodes[leaf].parent = u32_invalid_id;
+		return;
+	}
+
+	// find the best sibling: descend into the child that has the lowest cost, where the cost of a subtree
+	// is the surface area that would be added to it, and stop when making a new parent here is cheaper.
+	const aabb leaf_bounds{ _nodes[leaf].bounds };
+	u32 index{ _root };
+	while (!_nodes[index].is_leaf()) {
+		const node& n{ _nodes[index] };
+		const f32 area{ surface_area(n.bounds) };
+		const f32 combined_area{ surface_area(merge(n.bounds, leaf_bounds)) };
+
+		// cost of making a new parent for this node and the new leaf
+		const f32 cost{ 2.0f * combined_area };
+		// minimum cost of pushing the leaf further down the tree
+		const f32 inheritance_cost{ 2.0f * (combined_area - area) };
+
+		const auto descend_cost = [&](u32 child) {
+			const node& c{ _nodes[child] };
+			const f32 merged_area{ surface_area(merge(c.bounds, leaf_bounds)) };
+			return c.is_leaf() ? merged_area + inheritance_cost : (merged_area - surface_area(c.bounds)) + inheritance_cost;
+		};
+		const f32 cost1{ descend_cost(n.child1) };
+		const f32 cost2{ descend_cost(n.child2) };
+
+		if (cost < cost1 && cost < cost2) break;
+		index = cost1 < cost2 ? n.child1 : n.child2;
+	}
+
+	const u32 sibling{ index };
+	const u32 old_parent{ _nodes[sibling].parent };
+	// NOTE: allocate_node() may move the nodes, don't keep references across it.
+	const u32 new_parent{ allocate_node() };
+	{
+		node& p{ _nodes[new_parent] };
+		p.parent = old_parent;
+		p.bounds = merge(leaf_bounds, _nodes[sibling].bounds);
+		p.height = _nodes[sibling].height + 1;
+		p.child1 = sibling;
+		p.child2 = leaf;
+	}
+
+	if (old_parent != u32_invalid_id) {
+		node& op{ _nodes[old_parent] };
+		if (op.child1 == sibling) op.child1 = new_parent;
+		else op.child2 = new_parent;
+	}
+	else {
+		_root = new_parent;
+	}
+	_nodes[sibling].parent = new_parent;
+	_nodes[leaf].parent = new_parent;
+
+	refit_ancestors(new_parent);
+}
+
+void dynamicBVH::remove_leaf(u32 leaf) {
+	if (leaf == _root) {
+		_root = u32_invalid_id;
+		return;
+	}
+
+	const u32 parent{ _nodes[leaf].parent };
+	const u32 grand_parent{ _nodes[parent].parent };
+	const u32 sibling{ _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1 };
+
+	if (grand_parent != u32_invalid_id) {
+		// connect the sibling to the grand parent and get rid of the parent
+		node& gp{ _nodes[grand_parent] };
+		if (gp.child1 == parent) gp.child1 = sibling;
+		else gp.child2 = sibling;
+		_nodes[sibling].parent = grand_parent;
+		free_node(parent);
+
+		refit_ancestors(grand_parent);
+	}
+	else {
+		_root = sibling;
+		_nodes[sibling].parent = u32_invalid_id;
+		free_node(parent);
+	}
+}
+
+// walks from 'index' up to the root, rebalancing and refitting every node on the way
+void dynamicBVH::refit_ancestors(u32 index) {
+	while (index != u32_invalid_id) {
+		index = balance(index);
+
+		node& n{ _nodes[index] };
+		const node& c1{ _nodes[n.child1] };
+		const node& c2{ _nodes[n.child2] };
+		n.height = 1 + (std::max)(c1.height, c2.height);
+		n.bounds = merge(c1.bounds, c2.bounds);
+
+		index = n.parent;
+	}
+}
+
+// Performs a left or right rotation if node A is imbalanced and returns the new root of the subtree.
+// e.g. when C is higher than B, C moves up and the higher of its children F and G stays under it:
+//		A(B, C(F, G))  ->  C(A(B, G), F)
+u32 dynamicBVH::balance(u32 index_a) {
+	node& a{ _nodes[index_a] };
+	if (a.is_leaf() || a.height < 2) return index_a;
+
+	const u32 index_b{ a.child1 };
+	const u32 index_c{ a.child2 };
+	node& b{ _nodes[index_b] };
+	node& c{ _nodes[index_c] };
+
+	const s32 balance{ c.height - b.height };
+
+	// rotate C up
+	if (balance > 1) {
+		const u32 index_f{ c.child1 };
+		const u32 index_g{ c.child2 };
+		node& f{ _nodes[index_f] };
+		node& g{ _nodes[index_g] };
+
+		c.child1 = index_a;
+		c.parent = a.parent;
+		a.parent = index_c;
+
+		if (c.parent != u32_invalid_id) {
+			node& p{ _nodes[c.parent] };
+			if (p.child1 == index_a) p.child1 = index_c;
+			else p.child2 = index_c;
+		}
+		else {
+			_root = index_c;
+		}
+
+		// the higher of F and G stays under C, the other one goes under A
+		if (f.height > g.height) {
+			c.child2 = index_f;
+			a.child2 = index_g;
+			g.parent = index_a;
+			a.bounds = merge(b.bounds, g.bounds);
+			c.bounds = merge(a.bounds, f.bounds);
+			a.height = 1 + (std::max)(b.height, g.height);
+			c.height = 1 + (std::max)(a.height, f.height);
+		}
+		else {
+			c.child2 = index_g;
+			a.child2 = index_f;
+			f.parent = index_a;
+			a.bounds = merge(b.bounds, f.bounds);
+			c.bounds = merge(a.bounds, g.bounds);
+			a.height = 1 + (std::max)(b.height, f.height);
+			c.height = 1 + (std::max)(a.height, g.height);
+		}
+
+		return index_c;
+	}
+
+	// rotate B up
+	if (balance < -1) {
+		const u32 index_d{ b.child1 };
+		const u32 index_e{ b.child2 };
+		node& d{ _nodes[index_d] };
+		node& e{ _nodes[index_e] };
+
+		b.child1 = index_a;
+		b.parent = a.parent;
+		a.parent = index_b;
+
+		if (b.parent != u32_invalid_id) {
+			node& p{ _nodes[b.parent] };
+			if (p.child1 == index_a) p.child1 = index_b;
+			else p.child2 = index_b;
+		}
+		else {
+			_root = index_b;
+		}
+
+		// the higher of D and E stays under B, the other one goes under A
+		if (d.height > e.height) {
+			b.child2 = index_d;
+			a.child1 = index_e;
+			e.parent = index_a;
+			a.bounds = merge(c.bounds, e.bounds);
+			b.bounds = merge(a.bounds, d.bounds);
+			a.height = 1 + (std::max)(c.height, e.height);
+			b.height = 1 + (std::max)(a.height, d.height);
+		}
+		else {
+			b.child2 = index_e;
+			a.child1 = index_d;
+			d.parent = index_a;
+			a.bounds = merge(c.bounds, d.bounds);
+			b.bounds = merge(a.bounds, e.bounds);
+			a.height = 1 + (std::max)(c.height, d.height);
+			b.height = 1 + (std::max)(a.height, e.height);
+		}
+
+		return index_b;
+	}
+
+	return index_a;
+}
+
+}
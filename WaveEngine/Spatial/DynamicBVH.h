@@ -0,0 +1,157 @@
+#pragma once
+#include "SpatialCommon.h"
+
+namespace WAVEENGINE::SPATIAL {
+
+// refs: Erin Catto, "Dynamic Bounding Volume Hierarchies", GDC 2019 (box2d b2DynamicTree)
+//
+// A binary tree of AABBs with one leaf (proxy) per object.
+// - leaves are inserted next to the sibling that adds the least surface area (SAH)
+// - leaves store fat bounds, objects that move inside them don't touch the tree
+// - ancestors are refitted and rebalanced with tree rotations on the way up after every change
+class dynamicBVH {
+public:
+	explicit dynamicBVH(f32 margin = 0.1f) : _margin(margin) {}
+	DISABLE_COPY_AND_MOVE(dynamicBVH);
+
+	// adds a proxy for an object with the given bounds and returns its id
+	u32 add(const aabb& bounds, ID::id_type user_data);
+
+	void remove(u32 proxy);
+
+	// updates the bounds of a proxy. Returns true if the proxy had to be reinserted,
+	// false if the new bounds are still inside its fat bounds.
+	bool move(u32 proxy, const aabb& bounds);
+
+	void clear();
+
+	[[nodiscard]] ID::id_type user_data(u32 proxy) const {
+		assert(proxy < _nodes.size() && _nodes[proxy].is_leaf());
+		return _nodes[proxy].user_data;
+	}
+
+	[[nodiscard]] const aabb& fat_bounds(u32 proxy) const {
+		assert(proxy < _nodes.size() && _nodes[proxy].is_leaf());
+		return _nodes[proxy].bounds;
+	}
+
+	[[nodiscard]] u32 proxy_count() const { return _proxy_count; }
+	[[nodiscard]] u32 height() const { return _root == u32_invalid_id ? 0 : (u32)_nodes[_root].height; }
+
+	// Walks the whole tree and returns false if a link, height or bounds is broken: every node has to enclose
+	// its children, and the number of leaves has to match the proxy count. Slow, for tests.
+	[[nodiscard]] bool validate() const;
+
+	// the largest height difference between the two children of any node
+	[[nodiscard]] u32 max_balance() const;
+
+	// calls func(user_data) for every proxy whose fat bounds overlap 'box'
+	template<typename function>
+	void query_overlap(const aabb& box, function&& func) const {
+		using namespace DirectX;
+		const XMVECTOR box_min{ XMLoadFloat3(&box.min) };
+		const XMVECTOR box_max{ XMLoadFloat3(&box.max) };
+		traverse([&](const node& n) {
+			return XMVector3LessOrEqual(XMLoadFloat3(&n.bounds.min), box_max) &&
+				   XMVector3LessOrEqual(box_min, XMLoadFloat3(&n.bounds.max));
+			}, func);
+	}
+
+	// calls func(user_data) for every proxy whose fat bounds are hit by the ray
+	template<typename function>
+	void query_ray(const ray& r, function&& func) const {
+		using namespace DirectX;
+		const XMVECTOR origin{ XMLoadFloat3(&r.origin) };
+		// NOTE: avoid 0 * inf = NaN in the slab test for axis aligned rays
+		const XMVECTOR direction{ XMLoadFloat3(&r.direction) };
+		const XMVECTOR tiny{ XMVectorReplicate(1e-20f) };
+		const XMVECTOR safe_direction{ XMVectorSelect(direction, tiny, XMVectorLess(XMVectorAbs(direction), tiny)) };
+		const XMVECTOR inv_direction{ XMVectorReciprocal(safe_direction) };
+		const f32 max_distance{ r.max_distance };
+
+		traverse([&](const node& n) {
+			const XMVECTOR t0{ XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&n.bounds.min), origin), inv_direction) };
+			const XMVECTOR t1{ XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&n.bounds.max), origin), inv_direction) };
+			const XMVECTOR t_near{ XMVectorMin(t0, t1) };
+			const XMVECTOR t_far{ XMVectorMax(t0, t1) };
+			const f32 enter{ (std::max)((std::max)(XMVectorGetX(t_near), XMVectorGetY(t_near)), (std::max)(XMVectorGetZ(t_near), 0.0f)) };
+			const f32 exit{ (std::min)((std::min)(XMVectorGetX(t_far), XMVectorGetY(t_far)), (std::min)(XMVectorGetZ(t_far), max_distance)) };
+			return enter <= exit;
+			}, func);
+	}
+
+	// calls func(user_data) for every proxy whose fat bounds are inside or intersect the frustum
+	template<typename function>
+	void query_frustum(const frustum& f, function&& func) const {
+		using namespace DirectX;
+		XMVECTOR planes[6];
+		XMVECTOR positive[6]; // per plane: which components of the normal are >= 0
+		for (u32 i{ 0 }; i < 6; ++i) {
+			planes[i] = XMLoadFloat4(&f.planes[i]);
+			positive[i] = XMVectorGreaterOrEqual(planes[i], XMVectorZero());
+		}
+
+		traverse([&](const node& n) {
+			const XMVECTOR min{ XMLoadFloat3(&n.bounds.min) };
+			const XMVECTOR max{ XMLoadFloat3(&n.bounds.max) };
+			for (u32 i{ 0 }; i < 6; ++i) {
+				// the corner that is furthest along the plane's normal
+				const XMVECTOR p{ XMVectorSelect(min, max, positive[i]) };
+				if (XMVectorGetX(XMPlaneDotCoord(planes[i], p)) < 0.0f) return false;
+			}
+			return true;
+			}, func);
+	}
+
+private:
+	struct node {
+		aabb			bounds;
+		ID::id_type		user_data{ ID::invalid_id };
+		u32				parent{ u32_invalid_id };	// next free node if this node is in the free list
+		u32				child1{ u32_invalid_id };
+		u32				child2{ u32_invalid_id };
+		s32				height{ -1 };				// leaves are 0, free nodes are -1
+
+		constexpr bool is_leaf() const { return child1 == u32_invalid_id && height == 0; }
+	};
+
+	template<typename test_function, typename function>
+	void traverse(test_function&& test, function&& func) const {
+		if (_root == u32_invalid_id) return;
+
+		// NOTE: the tree is balanced, so its height stays far below the stack size even for millions of proxies.
+		constexpr u32 stack_size{ 256 };
+		u32 stack[stack_size];
+		u32 count{ 0 };
+		stack[count++] = _root;
+
+		while (count) {
+			const node& n{ _nodes[stack[--count]] };
+			if (!test(n)) continue;
+
+			if (n.is_leaf()) {
+				func(n.user_data);
+			}
+			else {
+				assert(count + 2 <= stack_size);
+				stack[count++] = n.child1;
+				stack[count++] = n.child2;
+			}
+		}
+	}
+
+	u32 allocate_node();
+	void free_node(u32 index);
+	void insert_leaf(u32 leaf);
+	void remove_leaf(u32 leaf);
+	void refit_ancestors(u32 index);
+	u32 balance(u32 index);
+
+	UTL::vector<node>	_nodes;
+	u32					_root{ u32_invalid_id };
+	u32					_free_node{ u32_invalid_id };
+	u32					_proxy_count{ 0 };
+	f32					_margin;
+};
+
+}
@@ -0,0 +1,204 @@
+#include "HashGrid.h"
+#include "..\Components\Transform.h"
+#include "..\Core\JobSystem.h"
+#include <limits>
+
+namespace WAVEENGINE::SPATIAL {
+
+namespace {
+
+constexpr u32 build_chunk_size{ 4096 };
+constexpr u32 query_chunk_size{ 64 };
+// keeps the average bucket at half a point or less, so unrelated cells rarely share a bucket
+constexpr u32 buckets_per_point{ 2 };
+constexpr u32 min_bucket_count{ 1024 };
+
+constexpr u32 bucket_count_for(u32 count) {
+	u32 bucket_count{ min_bucket_count };
+	while (bucket_count < count * (u64)buckets_per_point && bucket_count < (1u << 31)) {
+		bucket_count <<= 1;
+	}
+	return bucket_count;
+}
+
+} // anonymous namespace
+
+void hashGrid::build(const GAME_ENTITY::entity_id* const entities, u32 count) {
+	assert(entities || !count);
+	_count = count;
+	if (!count) return;
+
+	const u32 bucket_count{ bucket_count_for(count) };
+	_bucket_count = bucket_count;
+	_bucket_start.resize(bucket_count + 1);
+	_entities.resize(count);
+	_positions.resize(count);
+	_cells.resize(count);
+	_point_buckets.resize(count);
+	_unsorted_positions.resize(count);
+	_unsorted_cells.resize(count);
+	if (_cursor_capacity < bucket_count) {
+		_bucket_cursors = std::make_unique<std::atomic<u32>[]>(bucket_count);
+		_cursor_capacity = bucket_count;
+	}
+
+	std::atomic<u32>* const cursors{ _bucket_cursors.get() };
+	JOBS::parallel_for(bucket_count, build_chunk_size, [cursors](u32 begin, u32 end) {
+		for (u32 i{ begin }; i < end; ++i) cursors[i].store(0, std::memory_order_relaxed);
+		});
+
+	// 1. hash the points and count them per bucket
+	const u32 num_point_chunks{ (count + build_chunk_size - 1) / build_chunk_size };
+	_chunk_bounds.resize(num_point_chunks * 2);
+	const MATH::v3* const transform_positions{ TRANSFORM::position_data() };
+	JOBS::parallel_for(count, build_chunk_size, [&](u32 begin, u32 end) {
+		constexpr s32 s32_max{ (std::numeric_limits<s32>::max)() };
+		constexpr s32 s32_min{ (std::numeric_limits<s32>::min)() };
+		cell min{ s32_max, s32_max, s32_max };
+		cell max{ s32_min, s32_min, s32_min };
+
+		for (u32 i{ begin }; i < end; ++i) {
+			const ID::id_type index{ ID::index(entities[i]) };
+			assert(index < TRANSFORM::count());
+			const MATH::v3 p{ transform_positions[index] };
+			const cell c{ cell_of(p) };
+			min = { (std::min)(min.x, c.x), (std::min)(min.y, c.y), (std::min)(min.z, c.z) };
+			max = { (std::max)(max.x, c.x), (std::max)(max.y, c.y), (std::max)(max.z, c.z) };
+
+			const u32 bucket{ bucket_of(c) };
+			_unsorted_positions[i] = p;
+			_unsorted_cells[i] = c;
+			_point_buckets[i] = bucket;
+			cursors[bucket].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		const u32 chunk{ begin / build_chunk_size };
+		_chunk_bounds[chunk * 2] = min;
+		_chunk_bounds[chunk * 2 + 1] = max;
+		});
+
+	_min_cell = _chunk_bounds[0];
+	_max_cell = _chunk_bounds[1];
+	for (u32 i{ 1 }; i < num_point_chunks; ++i) {
+		const cell& min{ _chunk_bounds[i * 2] };
+		const cell& max{ _chunk_bounds[i * 2 + 1] };
+		_min_cell = { (std::min)(_min_cell.x, min.x), (std::min)(_min_cell.y, min.y), (std::min)(_min_cell.z, min.z) };
+		_max_cell = { (std::max)(_max_cell.x, max.x), (std::max)(_max_cell.y, max.y), (std::max)(_max_cell.z, max.z) };
+	}
+
+	// 2. exclusive prefix sum of the counts: sum each chunk of buckets, scan the chunk sums, then scan inside the chunks.
+	//	  The cursors are set to the bucket offsets for the scatter pass.
+	const u32 num_bucket_chunks{ (bucket_count + build_chunk_size - 1) / build_chunk_size };
+	_chunk_sums.resize(num_bucket_chunks);
+	JOBS::parallel_for(bucket_count, build_chunk_size, [&](u32 begin, u32 end) {
+		u32 sum{ 0 };
+		for (u32 i{ begin }; i < end; ++i) sum += cursors[i].load(std::memory_order_relaxed);
+		_chunk_sums[begin / build_chunk_size] = sum;
+		});
+
+	u32 offset{ 0 };
+	for (u32 i{ 0 }; i < num_bucket_chunks; ++i) {
+		const u32 sum{ _chunk_sums[i] };
+		_chunk_sums[i] = offset;
+		offset += sum;
+	}
+	assert(offset == count);
+
+	JOBS::parallel_for(bucket_count, build_chunk_size, [&](u32 begin, u32 end) {
+		u32 offset{ _chunk_sums[begin / build_chunk_size] };
+		for (u32 i{ begin }; i < end; ++i) {
+			const u32 bucket_size{ cursors[i].load(std::memory_order_relaxed) };
+			_bucket_start[i] = offset;
+			cursors[i].store(offset, std::memory_order_relaxed);
+			offset += bucket_size;
+		}
+		});
+	_bucket_start[bucket_count] = count;
+
+	// 3. scatter the points to their buckets
+	JOBS::parallel_for(count, build_chunk_size, [&](u32 begin, u32 end) {
+		for (u32 i{ begin }; i < end; ++i) {
+			const u32 slot{ cursors[_point_buckets[i]].fetch_add(1, std::memory_order_relaxed) };
+			_entities[slot] = entities[i];
+			_positions[slot] = _unsorted_positions[i];
+			_cells[slot] = _unsorted_cells[i];
+		}
+		});
+}
+
+void hashGrid::query_radius(const MATH::v3* const centers, u32 count, f32 radius, u32 max_results,
+							GAME_ENTITY::entity_id* const results, u32* const result_counts) const {
+	assert((centers && results && result_counts) || !count);
+	JOBS::parallel_for(count, query_chunk_size, [&](u32 begin, u32 end) {
+		for (u32 i{ begin }; i < end; ++i) {
+			GAME_ENTITY::entity_id* const out{ &results[(u64)i * max_results] };
+			u32 n{ 0 };
+			for_each_in_radius(centers[i], radius, [&](GAME_ENTITY::entity_id id, const MATH::v3&) {
+				if (n < max_results) out[n++] = id;
+				});
+			result_counts[i] = n;
+		}
+		});
+}
+
+void hashGrid::query_nearest(const MATH::v3* const centers, u32 count, u32 k, f32 max_radius,
+							 GAME_ENTITY::entity_id* const results, u32* const result_counts) const {
+	assert((centers && results && result_counts) || !count);
+	assert(max_radius < (std::numeric_limits<f32>::max)());
+	const f32 max_radius_sq{ max_radius * max_radius };
+
+	JOBS::parallel_for(count, query_chunk_size, [&](u32 begin, u32 end) {
+		UTL::vector<f32> distances(k);
+
+		for (u32 i{ begin }; i < end; ++i) {
+			const MATH::v3 center{ centers[i] };
+			GAME_ENTITY::entity_id* const out{ &results[(u64)i * k] };
+			u32 n{ 0 };
+
+			// keeps the k nearest points found so far sorted by distance
+			const auto consider = [&](u32 point) {
+				const f32 d{ distance_sq(_positions[point], center) };
+				if (d > max_radius_sq || (n == k && d >= distances[k - 1])) return;
+				u32 j{ n < k ? n++ : k - 1 };
+				for (; j > 0 && distances[j - 1] > d; --j) {
+					distances[j] = distances[j - 1];
+					out[j] = out[j - 1];
+				}
+				distances[j] = d;
+				out[j] = _entities[point];
+			};
+
+			// Visit the cells in growing shells around the center's cell. After shell 'ring' every point closer than
+			// ring * cell size has been seen, so we can stop as soon as the k-th nearest point is within that distance.
+			const cell c{ cell_of(center) };
+			for (s32 ring{ 0 }; _count && k; ++ring) {
+				const s32 z0{ (std::max)(c.z - ring, _min_cell.z) }, z1{ (std::min)(c.z + ring, _max_cell.z) };
+				const s32 y0{ (std::max)(c.y - ring, _min_cell.y) }, y1{ (std::min)(c.y + ring, _max_cell.y) };
+				for (s32 z{ z0 }; z <= z1; ++z) {
+					for (s32 y{ y0 }; y <= y1; ++y) {
+						const bool on_face{ z == c.z - ring || z == c.z + ring || y == c.y - ring || y == c.y + ring };
+						if (on_face) {
+							const s32 x0{ (std::max)(c.x - ring, _min_cell.x) }, x1{ (std::min)(c.x + ring, _max_cell.x) };
+							for (s32 x{ x0 }; x <= x1; ++x) visit_cell({ x, y, z }, consider);
+						}
+						else {
+							if (c.x - ring >= _min_cell.x) visit_cell({ c.x - ring, y, z }, consider);
+							if (ring && c.x + ring <= _max_cell.x) visit_cell({ c.x + ring, y, z }, consider);
+						}
+					}
+				}
+
+				const f32 covered{ ring * _cell_size };
+				if ((n == k && distances[k - 1] <= covered * covered) || covered >= max_radius) break;
+				// the shell already encloses all the points
+				if (c.x - ring <= _min_cell.x && c.x + ring >= _max_cell.x &&
+					c.y - ring <= _min_cell.y && c.y + ring >= _max_cell.y &&
+					c.z - ring <= _min_cell.z && c.z + ring >= _max_cell.z) break;
+			}
+
+			result_counts[i] = n;
+		}
+		});
+}
+
+}
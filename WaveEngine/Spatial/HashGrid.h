@@ -0,0 +1,109 @@
+#pragma once
+#include "SpatialCommon.h"
+#include "..\EngineAPI\GameEntity.h"
+#include <atomic>
+#include <memory>
+
+namespace WAVEENGINE::SPATIAL {
+
+// A uniform grid over points, hashed into a table of buckets and rebuilt from scratch every frame.
+// Meant for many moving points and small query radii (crowds, flocking) where refitting a tree would cost more.
+//
+// build() is a parallel counting sort: hash every point to its bucket, count the points per bucket,
+// prefix sum the counts into bucket offsets and scatter the points so each bucket is contiguous.
+// NOTE: the order of the points inside a bucket depends on thread timing, only the sets are deterministic.
+class hashGrid {
+public:
+	explicit hashGrid(f32 cell_size = 1.0f) : _cell_size(cell_size), _inv_cell_size(1.0f / cell_size) {
+		assert(cell_size > 0.0f);
+	}
+	DISABLE_COPY_AND_MOVE(hashGrid);
+
+	// rebuilds the grid from the positions of the given entities' transforms.
+	void build(const GAME_ENTITY::entity_id* const entities, u32 count);
+
+	// Batched radius query. For each center, writes up to 'max_results' entities within 'radius' to
+	// results[i * max_results] and their number to result_counts[i]. Runs on the job system.
+	void query_radius(const MATH::v3* const centers, u32 count, f32 radius, u32 max_results,
+					  GAME_ENTITY::entity_id* const results, u32* const result_counts) const;
+
+	// Batched k-nearest query. For each center, writes up to 'k' nearest entities within 'max_radius',
+	// nearest first, to results[i * k] and their number to result_counts[i]. Runs on the job system.
+	// NOTE: an entity at the center itself is included, ask for k + 1 to get k neighbours of an agent.
+	void query_nearest(const MATH::v3* const centers, u32 count, u32 k, f32 max_radius,
+					   GAME_ENTITY::entity_id* const results, u32* const result_counts) const;
+
+	// calls func(entity_id, position) for every entity within 'radius' of 'center'.
+	template<typename function>
+	void for_each_in_radius(const MATH::v3& center, f32 radius, function&& func) const {
+		if (!_count) return;
+		const f32 radius_sq{ radius * radius };
+		const cell first{ cell_of({ center.x - radius, center.y - radius, center.z - radius }) };
+		const cell last{ cell_of({ center.x + radius, center.y + radius, center.z + radius }) };
+		const cell min{ (std::max)(first.x, _min_cell.x), (std::max)(first.y, _min_cell.y), (std::max)(first.z, _min_cell.z) };
+		const cell max{ (std::min)(last.x, _max_cell.x), (std::min)(last.y, _max_cell.y), (std::min)(last.z, _max_cell.z) };
+
+		for (s32 z{ min.z }; z <= max.z; ++z)
+			for (s32 y{ min.y }; y <= max.y; ++y)
+				for (s32 x{ min.x }; x <= max.x; ++x) {
+					visit_cell({ x, y, z }, [&](u32 i) {
+						if (distance_sq(_positions[i], center) <= radius_sq) func(_entities[i], _positions[i]);
+						});
+				}
+	}
+
+	[[nodiscard]] u32 size() const { return _count; }
+	[[nodiscard]] f32 cell_size() const { return _cell_size; }
+
+private:
+	struct cell {
+		s32 x, y, z;
+	};
+
+	cell cell_of(const MATH::v3& p) const {
+		return { (s32)std::floor(p.x * _inv_cell_size), (s32)std::floor(p.y * _inv_cell_size), (s32)std::floor(p.z * _inv_cell_size) };
+	}
+
+	u32 bucket_of(cell c) const {
+		// refs: Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+		return (((u32)c.x * 73856093u) ^ ((u32)c.y * 19349663u) ^ ((u32)c.z * 83492791u)) & (_bucket_count - 1);
+	}
+
+	static f32 distance_sq(const MATH::v3& a, const MATH::v3& b) {
+		const f32 dx{ a.x - b.x }, dy{ a.y - b.y }, dz{ a.z - b.z };
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	// Calls func(i) for the sorted points that are inside cell 'c'.
+	// NOTE: different cells can share a bucket, so points are checked against their own cell.
+	//		 This way every point is visited exactly once when visiting each cell once.
+	template<typename function>
+	void visit_cell(cell c, function&& func) const {
+		const u32 bucket{ bucket_of(c) };
+		for (u32 i{ _bucket_start[bucket] }, end{ _bucket_start[bucket + 1] }; i < end; ++i) {
+			const cell& pc{ _cells[i] };
+			if (pc.x == c.x && pc.y == c.y && pc.z == c.z) func(i);
+		}
+	}
+
+	f32										_cell_size;
+	f32										_inv_cell_size;
+	u32										_count{ 0 };
+	u32										_bucket_count{ 0 };				// power of 2
+	cell									_min_cell{};					// cell bounds of all points
+	cell									_max_cell{};
+	UTL::vector<u32>						_bucket_start;					// _bucket_count + 1 offsets into the sorted arrays
+	UTL::vector<GAME_ENTITY::entity_id>		_entities;						// sorted by bucket
+	UTL::vector<MATH::v3>					_positions;						// sorted by bucket
+	UTL::vector<cell>						_cells;							// sorted by bucket
+	// build() scratch data
+	std::unique_ptr<std::atomic<u32>[]>		_bucket_cursors;
+	u32										_cursor_capacity{ 0 };
+	UTL::vector<u32>						_point_buckets;
+	UTL::vector<MATH::v3>					_unsorted_positions;
+	UTL::vector<cell>						_unsorted_cells;
+	UTL::vector<u32>						_chunk_sums;
+	UTL::vector<cell>						_chunk_bounds;
+};
+
+}
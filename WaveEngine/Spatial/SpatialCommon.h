@@ -0,0 +1,93 @@
+#pragma once
+#include "CommonHeaders.h"
+#include <algorithm>
+#include <cmath>
+
+namespace WAVEENGINE::SPATIAL {
+
+struct aabb {
+	MATH::v3 min;
+	MATH::v3 max;
+};
+
+struct ray {
+	MATH::v3	origin;
+	MATH::v3	direction;		// doesn't have to be normalized
+	f32			max_distance;	// in multiples of the direction's length
+};
+
+// NOTE: the planes face inwards, a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+struct frustum {
+	MATH::v4 planes[6];
+};
+
+// NOTE: (std::min) and (std::max) are in parentheses because Windows.h may be included without NOMINMAX.
+constexpr aabb merge(const aabb& a, const aabb& b) {
+	return aabb{
+		{ (std::min)(a.min.x, b.min.x), (std::min)(a.min.y, b.min.y), (std::min)(a.min.z, b.min.z) },
+		{ (std::max)(a.max.x, b.max.x), (std::max)(a.max.y, b.max.y), (std::max)(a.max.z, b.max.z) }
+	};
+}
+
+constexpr bool contains(const aabb& outer, const aabb& inner) {
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+		   outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+constexpr aabb fatten(const aabb& box, f32 margin) {
+	return aabb{
+		{ box.min.x - margin, box.min.y - margin, box.min.z - margin },
+		{ box.max.x + margin, box.max.y + margin, box.max.z + margin }
+	};
+}
+
+constexpr f32 surface_area(const aabb& box) {
+	const f32 dx{ box.max.x - box.min.x };
+	const f32 dy{ box.max.y - box.min.y };
+	const f32 dz{ box.max.z - box.min.z };
+	return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+// Extracts the normalized, inward facing planes of a view-projection matrix (row vectors, depth in [0, 1]).
+// refs: Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix"
+inline frustum make_frustum(const MATH::m4x4& view_projection) {
+	const auto column = [&view_projection](u32 c) {
+		return MATH::v4{ view_projection.m[0][c], view_projection.m[1][c], view_projection.m[2][c], view_projection.m[3][c] };
+	};
+	const MATH::v4 c0{ column(0) }, c1{ column(1) }, c2{ column(2) }, c3{ column(3) };
+
+	frustum f{ {
+		{ c3.x + c0.x, c3.y + c0.y, c3.z + c0.z, c3.w + c0.w },	// left
+		{ c3.x - c0.x, c3.y - c0.y, c3.z - c0.z, c3.w - c0.w },	// right
+		{ c3.x + c1.x, c3.y + c1.y, c3.z + c1.z, c3.w + c1.w },	// bottom
+		{ c3.x - c1.x, c3.y - c1.y, c3.z - c1.z, c3.w - c1.w },	// top
+		c2,														// near
+		{ c3.x - c2.x, c3.y - c2.y, c3.z - c2.z, c3.w - c2.w },	// far
+	} };
+
+	for (auto& plane : f.planes) {
+		const f32 inv_length{ 1.0f / std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z) };
+		plane = { plane.x * inv_length, plane.y * inv_length, plane.z * inv_length, plane.w * inv_length };
+	}
+	return f;
+}
+
+// Bounds of a box with half sizes 'extents' after scaling, rotating (quaternion) and moving it to 'position'.
+inline aabb transformed_bounds(const MATH::v3& position, const MATH::v4& rotation, const MATH::v3& scale, const MATH::v3& extents) {
+	const f32 x{ rotation.x }, y{ rotation.y }, z{ rotation.z }, w{ rotation.w };
+	const f32 ex{ extents.x * std::abs(scale.x) };
+	const f32 ey{ extents.y * std::abs(scale.y) };
+	const f32 ez{ extents.z * std::abs(scale.z) };
+
+	// rotated extents are |R| * e, with R being the rotation matrix of the quaternion
+	const f32 wx{ std::abs(1.0f - 2.0f * (y * y + z * z)) * ex + std::abs(2.0f * (x * y - w * z)) * ey + std::abs(2.0f * (x * z + w * y)) * ez };
+	const f32 wy{ std::abs(2.0f * (x * y + w * z)) * ex + std::abs(1.0f - 2.0f * (x * x + z * z)) * ey + std::abs(2.0f * (y * z - w * x)) * ez };
+	const f32 wz{ std::abs(2.0f * (x * z - w * y)) * ex + std::abs(2.0f * (y * z + w * x)) * ey + std::abs(1.0f - 2.0f * (x * x + y * y)) * ez };
+
+	return aabb{
+		{ position.x - wx, position.y - wy, position.z - wz },
+		{ position.x + wx, position.y + wy, position.z + wz }
+	};
+}
+
+}
@@ -0,0 +1,114 @@
+#include "SpatialIndex.h"
+#include "DynamicBVH.h"
+#include "..\Components\Entity.h"
+#include "..\Components\Transform.h"
+
+namespace WAVEENGINE::SPATIAL {
+
+namespace {
+
+// indexed by entity index, like the component arrays
+struct entry {
+	GAME_ENTITY::entity_id	id{ ID::invalid_id };
+	u32						proxy{ u32_invalid_id };
+	MATH::v3				extents{};
+};
+
+dynamicBVH							tree;
+UTL::vector<entry>					entries;
+UTL::vector<TRANSFORM::changed_range> changes;
+u32									transform_version{ 0 }; // cursor into TRANSFORM::get_changes()
+
+aabb world_bounds(ID::id_type index, const MATH::v3& extents) {
+	return transformed_bounds(TRANSFORM::position_data()[index], TRANSFORM::rotation_data()[index],
+							  TRANSFORM::scale_data()[index], extents);
+}
+
+void remove_entry(ID::id_type index) {
+	entry& e{ entries[index] };
+	assert(e.proxy != u32_invalid_id);
+	tree.remove(e.proxy);
+	e = {};
+}
+
+template<typename query_function>
+void collect(query_function&& query, UTL::vector<GAME_ENTITY::entity_id>& entities) {
+	query([&entities](ID::id_type id) {
+		entities.emplace_back(GAME_ENTITY::entity_id{ id });
+		});
+}
+
+} // anonymous namespace
+
+void add(GAME_ENTITY::entity entity, const MATH::v3& extents) {
+	MEMORY_TAG(spatial);
+	assert(GAME_ENTITY::is_alive(entity.get_id()) && entity.transform().is_valid());
+	const GAME_ENTITY::entity_id id{ entity.get_id() };
+	const ID::id_type index{ ID::index(id) };
+	if (entries.size() <= index) {
+		entries.resize(index + 1);
+	}
+
+	entry& e{ entries[index] };
+	if (e.proxy != u32_invalid_id) {
+		// a recycled index whose previous entity wasn't dropped by update() yet
+		assert(e.id != id);
+		remove_entry(index);
+	}
+
+	e.id = id;
+	e.extents = extents;
+	e.proxy = tree.add(world_bounds(index, extents), (ID::id_type)id);
+}
+
+void remove(GAME_ENTITY::entity_id id) {
+	assert(is_indexed(id));
+	remove_entry(ID::index(id));
+}
+
+bool is_indexed(GAME_ENTITY::entity_id id) {
+	const ID::id_type index{ ID::index(id) };
+	return index < entries.size() && entries[index].id == id && entries[index].proxy != u32_invalid_id;
+}
+
+void update() {
+	MEMORY_TAG(spatial);
+	changes.clear();
+	transform_version = TRANSFORM::get_changes(transform_version, changes);
+
+	for (const auto& range : changes) {
+		const u32 end{ (std::min)(range.first + range.count, (u32)entries.size()) };
+		for (u32 index{ range.first }; index < end; ++index) {
+			const entry& e{ entries[index] };
+			if (e.proxy == u32_invalid_id) continue;
+
+			if (!GAME_ENTITY::is_alive(e.id)) {
+				remove_entry(index);
+			}
+			else {
+				tree.move(e.proxy, world_bounds(index, e.extents));
+			}
+		}
+	}
+}
+
+void shutdown() {
+	tree.clear();
+	entries.clear();
+	changes.clear();
+	transform_version = 0;
+}
+
+void query_overlap(const aabb& box, UTL::vector<GAME_ENTITY::entity_id>& entities) {
+	collect([&box](auto&& func) { tree.query_overlap(box, func); }, entities);
+}
+
+void query_ray(const ray& r, UTL::vector<GAME_ENTITY::entity_id>& entities) {
+	collect([&r](auto&& func) { tree.query_ray(r, func); }, entities);
+}
+
+void query_frustum(const frustum& f, UTL::vector<GAME_ENTITY::entity_id>& entities) {
+	collect([&f](auto&& func) { tree.query_frustum(f, func); }, entities);
+}
+
+}
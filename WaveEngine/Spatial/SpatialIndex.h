@@ -0,0 +1,24 @@
+#pragma once
+#include "SpatialCommon.h"
+#include "..\EngineAPI\GameEntity.h"
+
+namespace WAVEENGINE::SPATIAL {
+
+// Adds an entity with a transform to the spatial index. 'extents' are the half sizes of its local bounding box,
+// the world bounds follow the entity's transform.
+void add(GAME_ENTITY::entity entity, const MATH::v3& extents);
+void remove(GAME_ENTITY::entity_id id);
+bool is_indexed(GAME_ENTITY::entity_id id);
+
+// Moves the bounds of the entities whose transforms changed since the last update and drops removed entities.
+// The engine calls this once per frame, after the transform changes are published.
+void update();
+void shutdown();
+
+// Append the entities whose bounds overlap the box, are hit by the ray, or are inside/intersect the frustum.
+// NOTE: the tree stores fat bounds, so results are conservative by the tree's margin.
+void query_overlap(const aabb& box, UTL::vector<GAME_ENTITY::entity_id>& entities);
+void query_ray(const ray& r, UTL::vector<GAME_ENTITY::entity_id>& entities);
+void query_frustum(const frustum& f, UTL::vector<GAME_ENTITY::entity_id>& entities);
+
+}
@@ -0,0 +1,382 @@
+#pragma once
+#include "CommonHeaders.h"
+#include "Hash.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LZ_USE_SSE2 1
+#else
+#define LZ_USE_SSE2 0
+#endif
+
+// NOTE: header only, so ContentTools and the editor DLL can compress without linking to the engine.
+namespace WAVEENGINE::UTL {
+
+/*
+ * [LZ block format], the same as the LZ4 block format
+ * sequences of:
+ *   token:				high 4 bits literal length, low 4 bits match length - 4 (15 means more length bytes follow)
+ *   literal length:	bytes of 255 until a byte < 255, added to the token's 15
+ *   literals
+ *   offset:			u16, distance from the current position back to the match
+ *   match length:		bytes of 255 until a byte < 255, added to the token's 15
+ * The last sequence only has literals. It is at least 5 bytes long, and the last match starts
+ * at least 12 bytes before the end, so the decoder can copy 16 bytes at a time until close to the end.
+ */
+
+constexpr u32 lz_min_match{ 4 };
+constexpr u32 lz_max_offset{ 65535 };
+constexpr u32 lz_last_literals{ 5 };
+constexpr u32 lz_match_limit{ 12 };
+constexpr u32 lz_hash_bits{ 12 };
+constexpr u32 lz_max_block_size{ 0x7e00'0000 };
+
+constexpr u64 lz_compress_bound(u64 size) {
+	return size + size / 255 + 16;
+}
+
+namespace DETAIL {
+
+inline u32 lz_read32(const u8* p) { u32 v; memcpy(&v, p, sizeof(v)); return v; }
+inline u64 lz_read64(const u8* p) { u64 v; memcpy(&v, p, sizeof(v)); return v; }
+
+inline u32 lz_hash(u32 sequence) {
+	return (sequence * 2654435761u) >> (32 - lz_hash_bits);
+}
+
+inline u8* lz_write_length(u8* op, u64 length) {
+	for (; length >= 255; length -= 255) {
+		*op++ = 255;
+	}
+	*op++ = (u8)length;
+	return op;
+}
+
+// Copies 16 bytes at a time, so it writes up to 15 bytes past dst + size.
+inline void lz_wild_copy(u8* dst, const u8* src, u64 size) {
+	u8* const end{ dst + size };
+	do {
+#if LZ_USE_SSE2
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#else
+		memcpy(dst, src, 16);
+#endif
+		dst += 16;
+		src += 16;
+	} while (dst < end);
+}
+
+// Copies 8 bytes at a time from 'offset' bytes back, so it writes up to 7 bytes past dst + size.
+inline void lz_copy8(u8* dst, u64 offset, u64 size) {
+	u8* const end{ dst + size };
+	do {
+		memcpy(dst, dst - offset, 8);
+		dst += 8;
+	} while (dst < end);
+}
+
+// Copies a match that can overlap its destination, when the offset is smaller than the length.
+// 'dst_end' is the end of the output buffer, the copy writes past dst + size only if there is room for it.
+inline void lz_copy_match(u8* dst, u64 offset, u64 size, const u8* const dst_end) {
+	const u8* src{ dst - offset };
+	if (offset == 1) {
+		memset(dst, *src, size);	// a run of one byte
+	}
+	else if (dst + size + 16 <= dst_end) {
+		if (offset >= 16) {
+			lz_wild_copy(dst, src, size);
+		}
+		else if (offset >= 8) {
+			lz_copy8(dst, offset, size);
+		}
+		else {
+			// the data repeats every 'offset' bytes, so any multiple of it is a valid offset as well.
+			// Copy the first multiple that is at least 8 one byte at a time, then the rest 8 bytes at a time.
+			const u64 pattern{ offset * ((8 + offset - 1) / offset) };
+			const u64 head{ (std::min)(pattern, size) };
+			for (u64 i{ 0 }; i < head; ++i) {
+				dst[i] = src[i];
+			}
+			if (size > pattern) lz_copy8(dst + pattern, pattern, size - pattern);
+		}
+	}
+	else {
+		for (u64 i{ 0 }; i < size; ++i) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+} // namespace DETAIL
+
+// Compresses 'size' bytes into 'dst'. Returns the compressed size, or 0 if it doesn't fit into 'capacity'
+// (lz_compress_bound(size) always fits) or size is larger than lz_max_block_size.
+inline u64 lz_compress(const void* const src, u64 size, void* const dst, u64 capacity) {
+	using namespace DETAIL;
+	if (size > lz_max_block_size) return 0;
+
+	const u8* const in{ static_cast<const u8*>(src) };
+	const u8* const in_end{ in + size };
+	u8* op{ static_cast<u8*>(dst) };
+	u8* const out_end{ op + capacity };
+	const u8* ip{ in };
+	const u8* anchor{ in };
+
+	// writes the literals since 'anchor' and a match. Returns false if it doesn't fit.
+	auto write_sequence = [&](const u8* literals_end, u64 offset, u64 match_length) {
+		const u64 literal_length{ (u64)(literals_end - anchor) };
+		if ((u64)(out_end - op) < 1 + literal_length + literal_length / 255 + 1 + 2 + match_length / 255 + 1) return false;
+
+		u8* const token{ op++ };
+		*token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+		if (literal_length >= 15) op = lz_write_length(op, literal_length - 15);
+		if (literal_length) memcpy(op, anchor, literal_length);
+		op += literal_length;
+		if (!match_length) return true; // the last sequence
+
+		*op++ = (u8)offset;
+		*op++ = (u8)(offset >> 8);
+		const u64 length{ match_length - lz_min_match };
+		*token |= (u8)(length >= 15 ? 15 : length);
+		if (length >= 15) op = lz_write_length(op, length - 15);
+		return true;
+	};
+
+	if (size > lz_match_limit) {
+		u32 table[1 << lz_hash_bits]{};
+		const u8* const match_limit{ in_end - lz_match_limit };
+		const u8* const match_end_limit{ in_end - lz_last_literals };
+		u32 misses{ 0 };
+		++ip;
+
+		while (ip < match_limit) {
+			const u32 sequence{ lz_read32(ip) };
+			const u32 h{ lz_hash(sequence) };
+			const u8* ref{ in + table[h] };
+			table[h] = (u32)(ip - in);
+
+			if (ref >= ip || (u64)(ip - ref) > lz_max_offset || lz_read32(ref) != sequence) {
+				// skip faster through data that doesn't compress.
+				ip += 1 + (misses++ >> 6);
+				continue;
+			}
+			misses = 0;
+
+			while (ip > anchor && ref > in && ip[-1] == ref[-1]) {
+				--ip;
+				--ref;
+			}
+
+			const u8* match_end{ ip + lz_min_match };
+			const u8* r{ ref + lz_min_match };
+			while (match_end + 8 <= match_end_limit && lz_read64(match_end) == lz_read64(r)) {
+				match_end += 8;
+				r += 8;
+			}
+			while (match_end < match_end_limit && *match_end == *r) {
+				++match_end;
+				++r;
+			}
+
+			if (!write_sequence(ip, (u64)(ip - ref), (u64)(match_end - ip))) return 0;
+			ip = anchor = match_end;
+			if (ip < match_limit) {
+				table[lz_hash(lz_read32(ip - 2))] = (u32)(ip - 2 - in);
+			}
+		}
+	}
+
+	if (!write_sequence(in_end, 0, 0)) return 0;
+	return (u64)(op - static_cast<u8*>(dst));
+}
+
+// Decompresses a block into 'dst', which must be exactly the size of the original data.
+// Returns false if the block is corrupt. It never reads or writes outside of the two buffers.
+inline bool lz_decompress(const void* const src, u64 size, void* const dst, u64 dst_size) {
+	using namespace DETAIL;
+	const u8* ip{ static_cast<const u8*>(src) };
+	const u8* const in_end{ ip + size };
+	u8* op{ static_cast<u8*>(dst) };
+	u8* const out_begin{ op };
+	u8* const out_end{ op + dst_size };
+
+	auto read_length = [&](u64& length) {
+		u8 b{ 255 };
+		while (b == 255) {
+			if (ip >= in_end) return false;
+			b = *ip++;
+			length += b;
+		}
+		return true;
+	};
+
+	while (ip < in_end) {
+		const u8 token{ *ip++ };
+		u64 literal_length{ (u64)(token >> 4) };
+		if (literal_length == 15 && !read_length(literal_length)) return false;
+		const u64 in_left{ (u64)(in_end - ip) };
+		const u64 out_left{ (u64)(out_end - op) };
+
+		// fast path: a sequence with a short match, far enough from the end of both buffers, copies its literals
+		// 16 bytes at a time however long they are, and the match with at most two 16 byte copies.
+		if ((token & 15) != 15 && in_left >= 16 && literal_length <= in_left - 16 && out_left >= 32 && literal_length <= out_left - 32) {
+			lz_wild_copy(op, ip, literal_length);
+			ip += literal_length;
+			op += literal_length;
+
+			const u64 offset{ (u64)ip[0] | ((u64)ip[1] << 8) };
+			ip += 2;
+			const u64 match_length{ (u64)(token & 15) + lz_min_match };
+			if (!offset || offset > (u64)(op - out_begin)) return false;
+			if (offset >= 16) {
+				lz_wild_copy(op, op - offset, match_length);
+			}
+			else if (offset >= 8) {
+				lz_copy8(op, offset, match_length);
+			}
+			else {
+				lz_copy_match(op, offset, match_length, out_end);
+			}
+			op += match_length;
+			continue;
+		}
+
+		if (in_left < literal_length || out_left < literal_length) return false;
+		if (literal_length + 16 <= in_left && literal_length + 16 <= out_left) {
+			lz_wild_copy(op, ip, literal_length);
+		}
+		else if (literal_length) {
+			memcpy(op, ip, literal_length);
+		}
+		ip += literal_length;
+		op += literal_length;
+		if (ip == in_end) break; // the last sequence has no match
+
+		if (in_end - ip < 2) return false;
+		const u64 offset{ (u64)ip[0] | ((u64)ip[1] << 8) };
+		ip += 2;
+		u64 match_length{ (u64)(token & 15) };
+		if (match_length == 15 && !read_length(match_length)) return false;
+		match_length += lz_min_match;
+
+		if (!offset || offset > (u64)(op - out_begin) || (u64)(out_end - op) < match_length) return false;
+		lz_copy_match(op, offset, match_length, out_end);
+		op += match_length;
+	}
+
+	return op == out_end;
+}
+
+/*
+ * [LZ frame format]
+ * header: magic, block size, original size, flags, checksum
+ * blocks: u32 stored size (the high bit is set if the block is stored uncompressed), then the block
+ * end mark: u32 0
+ *
+ * The blocks are compressed independently, so a frame can be decompressed while it is still being read.
+ * The checksum is optional, a container that already checks the stored frame (e.g. asset packages) leaves it out.
+ */
+
+constexpr u32 lz_frame_magic{ 'W' | ('L' << 8) | ('Z' << 16) | ('F' << 24) };
+constexpr u32 lz_default_block_size{ 256 * 1024 };
+constexpr u32 lz_uncompressed_block{ 0x8000'0000 };
+constexpr u32 lz_frame_has_checksum{ 0x01 };
+
+struct lz_frame_header {
+	u32 magic;
+	u32 block_size;
+	u64 original_size;
+	u32 flags;
+	u32 checksum;			// UTL::crc32 of the original data if flags has lz_frame_has_checksum, 0 otherwise
+};
+static_assert(sizeof(lz_frame_header) == 24);
+
+constexpr u64 lz_frame_bound(u64 size, u32 block_size = lz_default_block_size) {
+	const u64 num_blocks{ (size + block_size - 1) / block_size };
+	return sizeof(lz_frame_header) + num_blocks * sizeof(u32) + size + sizeof(u32);
+}
+
+// Compresses 'size' bytes into a frame. Returns the size of the frame, or 0 if 'capacity' is smaller than
+// lz_frame_bound(size, block_size). Blocks that don't get smaller are stored as they are.
+// Without a checksum, corrupt data is only found if it breaks the block format.
+inline u64 lz_compress_frame(const void* const src, u64 size, void* const dst, u64 capacity,
+							 bool has_checksum = true, u32 block_size = lz_default_block_size) {
+	assert(block_size && block_size <= lz_max_block_size);
+	if (capacity < lz_frame_bound(size, block_size)) return 0;
+
+	const u8* const in{ static_cast<const u8*>(src) };
+	u8* op{ static_cast<u8*>(dst) };
+	const lz_frame_header header{ lz_frame_magic, block_size, size,
+		has_checksum ? lz_frame_has_checksum : 0, has_checksum ? crc32(src, size) : 0 };
+	memcpy(op, &header, sizeof(header));
+	op += sizeof(header);
+
+	for (u64 offset{ 0 }; offset < size; offset += block_size) {
+		const u32 block{ (u32)(std::min)((u64)block_size, size - offset) };
+		// NOTE: stop compressing when it would be larger than the uncompressed block.
+		u32 stored_size{ (u32)lz_compress(in + offset, block, op + sizeof(u32), block - 1) };
+		if (!stored_size) {
+			memcpy(op + sizeof(u32), in + offset, block);
+			stored_size = block | lz_uncompressed_block;
+		}
+		memcpy(op, &stored_size, sizeof(u32));
+		op += sizeof(u32) + (stored_size & ~lz_uncompressed_block);
+	}
+
+	const u32 end{ 0 };
+	memcpy(op, &end, sizeof(end));
+	op += sizeof(end);
+	return (u64)(op - static_cast<u8*>(dst));
+}
+
+// Returns the size of the data in the frame, or 0 if it isn't a frame.
+inline u64 lz_frame_original_size(const void* const src, u64 size) {
+	lz_frame_header header{};
+	if (size < sizeof(header)) return 0;
+	memcpy(&header, src, sizeof(header));
+	return header.magic == lz_frame_magic ? header.original_size : 0;
+}
+
+// Decompresses a frame into 'dst', which must be lz_frame_original_size() bytes.
+// Returns false if the frame is corrupt or, if it has one, doesn't match its checksum.
+inline bool lz_decompress_frame(const void* const src, u64 size, void* const dst, u64 dst_size) {
+	const u8* ip{ static_cast<const u8*>(src) };
+	const u8* const in_end{ ip + size };
+	u8* const out{ static_cast<u8*>(dst) };
+
+	lz_frame_header header{};
+	if (size < sizeof(header)) return false;
+	memcpy(&header, ip, sizeof(header));
+	ip += sizeof(header);
+	if (header.magic != lz_frame_magic || header.original_size != dst_size || !header.block_size || header.block_size > lz_max_block_size ||
+		(header.flags & ~lz_frame_has_checksum))
+		return false;
+
+	for (u64 offset{ 0 }; offset < dst_size; offset += header.block_size) {
+		const u64 block{ (std::min)((u64)header.block_size, dst_size - offset) };
+		u32 stored_size{ 0 };
+		if (in_end - ip < (s64)sizeof(u32)) return false;
+		memcpy(&stored_size, ip, sizeof(u32));
+		ip += sizeof(u32);
+
+		const bool is_compressed{ !(stored_size & lz_uncompressed_block) };
+		stored_size &= ~lz_uncompressed_block;
+		if ((u64)(in_end - ip) < stored_size) return false;
+		if (is_compressed) {
+			if (!lz_decompress(ip, stored_size, out + offset, block)) return false;
+		}
+		else {
+			if (stored_size != block) return false;
+			memcpy(out + offset, ip, block);
+		}
+		ip += stored_size;
+	}
+
+	u32 end{};
+	if ((u64)(in_end - ip) != sizeof(end)) return false;
+	memcpy(&end, ip, sizeof(end));
+	if (end) return false;
+	return !(header.flags & lz_frame_has_checksum) || header.checksum == crc32(dst, dst_size);
+}
+
+}
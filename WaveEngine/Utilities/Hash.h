@@ -0,0 +1,66 @@
+#pragma once
+#include "CommonHeaders.h"
+
+namespace WAVEENGINE::UTL {
+
+namespace DETAIL {
+
+// slicing-by-8 tables: table[0] is the byte-wise CRC table, table[k] advances it by k more zero bytes.
+struct crc32_tables {
+	u32 table[8][256];
+
+	crc32_tables() {
+		for (u32 i{ 0 }; i < 256; ++i) {
+			u32 crc{ i };
+			for (u32 bit{ 0 }; bit < 8; ++bit) {
+				crc = (crc >> 1) ^ (0xedb8'8320 & (0u - (crc & 1)));
+			}
+			table[0][i] = crc;
+		}
+		for (u32 i{ 0 }; i < 256; ++i) {
+			for (u32 k{ 1 }; k < 8; ++k) {
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+			}
+		}
+	}
+};
+
+inline const crc32_tables& get_crc32_tables() {
+	static const crc32_tables tables{};
+	return tables;
+}
+
+} // namespace DETAIL
+
+// CRC-32 as used by zlib and PNG. Pass the previous result as 'crc' to continue over more data.
+inline u32 crc32(const void* const data, u64 size, u32 crc = 0) {
+	const auto& t{ DETAIL::get_crc32_tables().table };
+	const u8* p{ static_cast<const u8*>(data) };
+	crc = ~crc;
+	while (size >= 8) {
+		u32 low, high;
+		memcpy(&low, p, sizeof(u32));
+		memcpy(&high, p + 4, sizeof(u32));
+		low ^= crc;
+		crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+			  t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+		p += 8;
+		size -= 8;
+	}
+	while (size--) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+	}
+	return ~crc;
+}
+
+// 64 bit FNV-1a, for identifying content. Pass the previous result as 'hash' to continue over more data.
+constexpr u64 fnv1a_64_offset{ 0xcbf2'9ce4'8422'2325ull };
+inline u64 fnv1a_64(const void* const data, u64 size, u64 hash = fnv1a_64_offset) {
+	const u8* p{ static_cast<const u8*>(data) };
+	for (u64 i{ 0 }; i < size; ++i) {
+		hash = (hash ^ p[i]) * 0x0000'0100'0000'01b3ull;
+	}
+	return hash;
+}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "CommonHeaders.h"
 #include <type_traits>
+#include <string_view>
 
 namespace WAVEENGINE::UTL {
 
@@ -38,11 +39,59 @@ public:
 	[[nodiscard]] constexpr const u8* const position() const { return _position; }
 	[[nodiscard]] constexpr size_t offset() const { return _position - _buffer; }
 
+	// NOTE: the reader doesn't know where the buffer ends, use this to validate untrusted data
+	//		 against the buffer 'size' before reading 'length' more bytes.
+	[[nodiscard]] constexpr bool can_read(u64 length, u64 size) const {
+		return offset() <= size && length <= size - offset();
+	}
+
 private:
 	const u8* const	_buffer;		// start point(anchor), immutable after initialization, content in memory is also immutable when reading
 	const u8*		_position;	// movable pointer
 };
 
+// NOTE: blobStreamReader doesn't check the end of the blob, so every read is checked here first.
+class checkedReader {
+public:
+	checkedReader(const u8* data, u64 size) : _reader{ data }, _size{ size } {}
+	DISABLE_COPY_AND_MOVE(checkedReader);
+
+	bool can_read(u64 bytes) const { return _is_valid && _reader.can_read(bytes, _size); }
+
+	u32 read_u32() {
+		_is_valid = can_read(sizeof(u32));
+		return _is_valid ? _reader.read<u32>() : 0;
+	}
+
+	f32 read_f32() {
+		_is_valid = can_read(sizeof(f32));
+		return _is_valid ? _reader.read<f32>() : 0.f;
+	}
+
+	// returns a pointer to the next 'bytes' bytes and skips them.
+	const u8* take(u64 bytes) {
+		_is_valid = can_read(bytes);
+		if (!_is_valid) return nullptr;
+		const u8* const data{ _reader.position() };
+		_reader.skip(bytes);
+		return data;
+	}
+
+	std::string_view read_string() {
+		const u32 length{ read_u32() };
+		const u8* const data{ take(length) };
+		return data ? std::string_view{ reinterpret_cast<const char*>(data), length } : std::string_view{};
+	}
+
+	bool is_valid() const { return _is_valid; }
+	bool is_at_end() const { return _is_valid && _reader.offset() == _size; }
+
+private:
+	blobStreamReader		_reader;
+	const u64				_size;
+	bool					_is_valid{ true };
+};
+
 // NOTE: (Important) This utility class is intended for local use only (i.e. within one function).
 //		Do not keep instance around as member variables.
 class blobStreamWriter {
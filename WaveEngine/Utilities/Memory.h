@@ -0,0 +1,249 @@
+#pragma once
+#include "PrimitiveTypes.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <assert.h>
+#include <algorithm>
+
+// Tracking is compiled out of shipping builds, define USE_MEMORY_TRACKING to override.
+#if !defined(USE_MEMORY_TRACKING)
+#if defined(SHIPPING)
+#define USE_MEMORY_TRACKING 0
+#else
+#define USE_MEMORY_TRACKING 1
+#endif
+#endif
+
+namespace WAVEENGINE::MEMORY {
+
+// Subsystems that memory is accounted to. Allocations take the tag of the innermost MEMORY_TAG scope of
+// the allocating thread, and keep it when they are reallocated or freed somewhere else.
+enum class memory_tag : u32 {
+	general,
+	entity,
+	transform,
+	script,
+	spatial,
+	content,
+	geometry,
+	graphics,
+	vulkan,
+	profiler,
+
+	count
+};
+
+constexpr const char* memory_tag_names[(u32)memory_tag::count]{
+	"general", "entity", "transform", "script", "spatial", "content", "geometry", "graphics", "vulkan", "profiler",
+};
+
+struct memory_stats {
+	u64 live_bytes;
+	u64 peak_bytes;
+	u64 live_allocations;
+	u64 total_allocations;
+	u64 frame_allocations;			// since the last begin_frame()
+	u64 budget;						// 0 if there is none
+};
+
+#if USE_MEMORY_TRACKING
+
+namespace INTERNAL {
+
+struct tag_counters {
+	std::atomic<u64> live_bytes{ 0 };
+	std::atomic<u64> peak_bytes{ 0 };
+	std::atomic<u64> live_allocations{ 0 };
+	std::atomic<u64> total_allocations{ 0 };
+	std::atomic<u64> frame_allocations{ 0 };
+	std::atomic<u64> budget{ 0 };
+};
+
+// NOTE: the counters live in the header, so every module (engine, editor DLL, content tools) tracks the
+//		 allocations it makes without linking to the engine.
+inline tag_counters counters[(u32)memory_tag::count]{};
+inline thread_local memory_tag thread_tag{ memory_tag::general };
+
+// Stored in front of every tracked allocation, so it can be freed without knowing its size or tag.
+struct alignas(16) header {
+	u64 size;
+	u32 tag;
+	u32 offset;			// from the start of the block malloc() returned to the user pointer
+};
+static_assert(sizeof(header) == 16);
+
+constexpr u64 default_alignment{ 16 };
+
+inline void add(memory_tag tag, u64 size) {
+	tag_counters& c{ counters[(u32)tag] };
+	const u64 live{ c.live_bytes.fetch_add(size, std::memory_order_relaxed) + size };
+	u64 peak{ c.peak_bytes.load(std::memory_order_relaxed) };
+	while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+	c.live_allocations.fetch_add(1, std::memory_order_relaxed);
+	c.total_allocations.fetch_add(1, std::memory_order_relaxed);
+	c.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void remove(memory_tag tag, u64 size) {
+	tag_counters& c{ counters[(u32)tag] };
+	c.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+	c.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline header* get_header(void* ptr) {
+	return static_cast<header*>(ptr) - 1;
+}
+
+} // namespace INTERNAL
+
+inline memory_tag current_tag() {
+	return INTERNAL::thread_tag;
+}
+
+// Allocates 'size' bytes aligned to 'alignment' (a power of 2) and accounts them to 'tag'.
+inline void* allocate(u64 size, memory_tag tag = current_tag(), u64 alignment = INTERNAL::default_alignment) {
+	using namespace INTERNAL;
+	assert(alignment && (alignment & (alignment - 1)) == 0);
+	const u64 padding{ alignment > default_alignment ? alignment : 0 };
+	u8* const block{ static_cast<u8*>(malloc(size + sizeof(header) + padding)) };
+	if (!block) return nullptr;
+
+	u8* const ptr{ padding ? (u8*)(((uintptr_t)block + sizeof(header) + alignment - 1) & ~(uintptr_t)(alignment - 1)) : block + sizeof(header) };
+	header* const h{ get_header(ptr) };
+	h->size = size;
+	h->tag = (u32)tag;
+	h->offset = (u32)(ptr - block);
+	add(tag, size);
+	return ptr;
+}
+
+inline void release(void* ptr) {
+	using namespace INTERNAL;
+	if (!ptr) return;
+	const header* const h{ get_header(ptr) };
+	remove((memory_tag)h->tag, h->size);
+	free(static_cast<u8*>(ptr) - h->offset);
+}
+
+// Resizes an allocation made by allocate() or reallocate(), or makes a new one if 'ptr' is null.
+// The memory stays accounted to the tag it was first allocated with.
+inline void* reallocate(void* ptr, u64 size, u64 alignment = INTERNAL::default_alignment) {
+	using namespace INTERNAL;
+	if (!ptr) return allocate(size, current_tag(), alignment);
+
+	header* const h{ get_header(ptr) };
+	const memory_tag tag{ (memory_tag)h->tag };
+	const u64 old_size{ h->size };
+	// NOTE: realloc() only works on blocks that start at the header. Over-aligned blocks are padded
+	//		 in front, and realloc() could also move the block to a different alignment, so make a new one.
+	if (alignment > default_alignment || h->offset != sizeof(header)) {
+		void* const new_ptr{ allocate(size, tag, alignment) };
+		if (new_ptr) {
+			memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+			release(ptr);
+		}
+		return new_ptr;
+	}
+
+	u8* const block{ static_cast<u8*>(realloc(h, size + sizeof(header))) };
+	if (!block) return nullptr;
+
+	header* const new_header{ reinterpret_cast<header*>(block) };
+	new_header->size = size;
+	remove(tag, old_size);
+	add(tag, size);
+	return new_header + 1;
+}
+
+// Accounts memory that is allocated and freed outside of this module (e.g. handed to the editor),
+// it only shows up in the allocation counts.
+inline void record_external(memory_tag tag, u64 size) {
+	INTERNAL::tag_counters& c{ INTERNAL::counters[(u32)tag] };
+	c.total_allocations.fetch_add(1, std::memory_order_relaxed);
+	c.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+	(void)size;
+}
+
+// Sets the current thread's tag until the scope ends.
+class tag_scope {
+public:
+	explicit tag_scope(memory_tag tag) : _previous{ INTERNAL::thread_tag } { INTERNAL::thread_tag = tag; }
+	~tag_scope() { INTERNAL::thread_tag = _previous; }
+	tag_scope(const tag_scope&) = delete;
+	tag_scope& operator=(const tag_scope&) = delete;
+private:
+	const memory_tag _previous;
+};
+
+inline memory_stats get_stats(memory_tag tag) {
+	const INTERNAL::tag_counters& c{ INTERNAL::counters[(u32)tag] };
+	return {
+		c.live_bytes.load(std::memory_order_relaxed),
+		c.peak_bytes.load(std::memory_order_relaxed),
+		c.live_allocations.load(std::memory_order_relaxed),
+		c.total_allocations.load(std::memory_order_relaxed),
+		c.frame_allocations.load(std::memory_order_relaxed),
+		c.budget.load(std::memory_order_relaxed),
+	};
+}
+
+inline void set_budget(memory_tag tag, u64 bytes) {
+	INTERNAL::counters[(u32)tag].budget.store(bytes, std::memory_order_relaxed);
+}
+
+inline bool is_over_budget(memory_tag tag) {
+	const memory_stats stats{ get_stats(tag) };
+	return stats.budget && stats.live_bytes > stats.budget;
+}
+
+// Resets the per frame allocation counts. The engine calls this at the start of every frame.
+inline void begin_frame() {
+	for (u32 i{ 0 }; i < (u32)memory_tag::count; ++i) {
+		INTERNAL::counters[i].frame_allocations.store(0, std::memory_order_relaxed);
+	}
+}
+
+// Writes one line per tag that still has live allocations (or every tag if 'all') into 'buffer'.
+// Returns the number of tags with live allocations, i.e. the leaks when called at shutdown.
+inline u32 write_report(char* const buffer, u64 size, bool all = false) {
+	assert(buffer && size);
+	buffer[0] = 0;
+	u64 length{ 0 };
+	u32 live_tags{ 0 };
+	for (u32 i{ 0 }; i < (u32)memory_tag::count; ++i) {
+		const memory_stats s{ get_stats((memory_tag)i) };
+		if (s.live_allocations) ++live_tags;
+		if ((!s.live_allocations && !all) || length >= size) continue;
+
+		const int written{ snprintf(buffer + length, size - length, "%-10s live: %llu bytes in %llu allocations, peak: %llu bytes%s\n",
+									memory_tag_names[i], (unsigned long long)s.live_bytes, (unsigned long long)s.live_allocations,
+									(unsigned long long)s.peak_bytes, s.budget && s.live_bytes > s.budget ? ", OVER BUDGET" : "") };
+		if (written > 0) length = (std::min)(length + (u64)written, size - 1);
+	}
+	return live_tags;
+}
+
+#define MEMORY_TAG_CONCAT_INNER(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_INNER(a, b)
+#define MEMORY_TAG(tag) const ::WAVEENGINE::MEMORY::tag_scope MEMORY_TAG_CONCAT(memory_tag_scope_, __LINE__){ ::WAVEENGINE::MEMORY::memory_tag::tag }
+
+#else
+
+inline memory_tag current_tag() { return memory_tag::general; }
+inline void* allocate(u64 size, memory_tag = memory_tag::general, u64 alignment = 16) { assert(alignment <= 16); return malloc(size); }
+inline void release(void* ptr) { free(ptr); }
+inline void* reallocate(void* ptr, u64 size, u64 alignment = 16) { assert(alignment <= 16); return realloc(ptr, size); }
+inline void record_external(memory_tag, u64) {}
+inline memory_stats get_stats(memory_tag) { return {}; }
+inline void set_budget(memory_tag, u64) {}
+inline bool is_over_budget(memory_tag) { return false; }
+inline void begin_frame() {}
+inline u32 write_report(char* const buffer, u64 size, bool = false) { if (buffer && size) buffer[0] = 0; return 0; }
+
+#define MEMORY_TAG(tag) ((void)0)
+
+#endif // USE_MEMORY_TRACKING
+
+}
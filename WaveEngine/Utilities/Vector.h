@@ -1,5 +1,6 @@
 #pragma once
 #include "CommonHeaders.h"
+#include "Memory.h"
 
 namespace WAVEENGINE::UTL {
 
@@ -180,7 +181,9 @@ public:
 			// if not(no enough space left), realloc() will try to find a larger memory region and copy the original data
 			// realloc() will automatically copy the data in the buffer 
 			// if a new region of memory is allocated.
-			void* new_buffer{ realloc(_data, new_capacity * sizeof(T)) };
+			// NOTE: MEMORY::reallocate() calls realloc() and keeps the memory accounted to the tag of the first allocation,
+			//		 only a vector without a buffer allocates with the current memory tag.
+			void* new_buffer{ MEMORY::reallocate(_data, new_capacity * sizeof(T)) };
 			assert(new_buffer);
 			if (new_buffer) {
 				_data = static_cast<T*>(new_buffer);
@@ -346,7 +349,7 @@ private:
 		clear(); // call destructor for each item and set _size = 0 inside 
 		_capacity = 0;
 		if (_data) {
-			free(const_cast<void*>(static_cast<const void*>(_data)));
+			MEMORY::release(const_cast<void*>(static_cast<const void*>(_data)));
 		}
 		_data = nullptr;
 	}